@@ -32,7 +32,7 @@ export default function Controls() {
     const { 
         isConnected, 
         setMode, 
-        setTimer, 
+        startSession, 
         currentMode, 
         currentIntensity, 
         timeLeft
@@ -79,8 +79,7 @@ export default function Controls() {
                 setIsActive(true);
                 // Start session
                 const mode = PATTERN_TO_MODE[selectedPattern] || 2;
-                await setMode(mode, intensity);
-                await setTimer(selectedTimer * 60); // Convert minutes to seconds
+                await startSession(mode, intensity, selectedTimer * 60); // Convert minutes to seconds
             }
         } catch (error) {
             console.error('Failed to control device:', error);
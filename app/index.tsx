@@ -14,8 +14,7 @@ export default function Dashboard() {
         isConnecting, 
         currentMode,
         connect, 
-        setMode, 
-        setTimer
+        startSession
     } = useBluetooth();
     const router = useRouter();
     const currentHour = new Date().getHours();
@@ -62,8 +61,7 @@ export default function Dashboard() {
             setQuickStartMessage(`Applying ${presetLabel} settings...`);
 
             // Start session with specified settings
-            await setMode(mode, intensity);
-            await setTimer(durationMinutes * 60); // minutes -> seconds
+            await startSession(mode, intensity, durationMinutes * 60); // minutes -> seconds
 
             setQuickStartPhase('idle');
             setQuickStartMessage('');
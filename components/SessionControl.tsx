@@ -8,7 +8,7 @@ interface SessionControlProps {
 }
 
 export default function SessionControl({ sessionName }: SessionControlProps) {
-  const { currentMode, currentIntensity, timeLeft, stopSession } = useBluetooth();
+  const { currentMode, currentIntensity, timeLeft, runtimeMinutes, stopSession } = useBluetooth();
 
   // Don't render if no session is active
   if (currentMode === 0) return null;
@@ -50,6 +50,7 @@ export default function SessionControl({ sessionName }: SessionControlProps) {
             </Text>
             <Text className="text-gray-400 text-xs mt-0.5">
               Active • {currentIntensity}% • {formatTime(timeLeft)}
+              {runtimeMinutes >= 0 ? ` • Battery ~${runtimeMinutes} min` : ''}
             </Text>
           </View>
         </View>
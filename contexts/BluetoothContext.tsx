@@ -7,10 +7,12 @@ interface BluetoothContextType {
   currentMode: number;
   currentIntensity: number;
   timeLeft: number;
+  runtimeMinutes: number; // Battery runtime at the running pattern's draw, -1 if unknown
   connect: () => Promise<void>;
   disconnect: () => Promise<void>;
   setMode: (mode: number, intensity: number) => Promise<void>;
   setTimer: (durationSeconds: number) => Promise<void>;
+  startSession: (mode: number, intensity: number, durationSeconds: number) => Promise<void>;
   stopSession: () => Promise<void>;
   error: string | null;
 }
@@ -27,6 +29,7 @@ export const BluetoothProvider: React.FC<BluetoothProviderProps> = ({ children }
   const [currentMode, setCurrentMode] = useState(0);
   const [currentIntensity, setCurrentIntensity] = useState(0);
   const [timeLeft, setTimeLeft] = useState(0);
+  const [runtimeMinutes, setRuntimeMinutes] = useState(-1);
   const [error, setError] = useState<string | null>(null);
 
   useEffect(() => {
@@ -54,6 +57,7 @@ export const BluetoothProvider: React.FC<BluetoothProviderProps> = ({ children }
     const handleDisconnected = () => {
       setIsConnected(false);
       setIsConnecting(false);
+      setRuntimeMinutes(-1);
     };
 
     const handleError = (err: Error) => {
@@ -72,6 +76,9 @@ export const BluetoothProvider: React.FC<BluetoothProviderProps> = ({ children }
       if (status.timeLeft !== undefined) {
         setTimeLeft(status.timeLeft);
       }
+      if (status.runtimeMinutes !== undefined) {
+        setRuntimeMinutes(status.runtimeMinutes);
+      }
     };
 
     BluetoothService.on('connected', handleConnected);
@@ -158,6 +165,21 @@ export const BluetoothProvider: React.FC<BluetoothProviderProps> = ({ children }
     }
   };
 
+  const startSession = async (mode: number, intensity: number, durationSeconds: number) => {
+    setError(null);
+    try {
+      await BluetoothService.startSession(mode, intensity, durationSeconds);
+    } catch (err) {
+      const errorMessage = err instanceof Error ? err.message : 'Failed to start session';
+      setError(errorMessage);
+      // Don't leave UI in inconsistent state - request status to sync
+      if (isConnected) {
+        BluetoothService.requestStatus().catch(console.error);
+      }
+      throw err;
+    }
+  };
+
   const stopSession = async () => {
     setError(null);
     try {
@@ -184,10 +206,12 @@ export const BluetoothProvider: React.FC<BluetoothProviderProps> = ({ children }
         currentMode,
         currentIntensity,
         timeLeft,
+        runtimeMinutes,
         connect,
         disconnect,
         setMode,
         setTimer,
+        startSession,
         stopSession,
         error,
       }}
@@ -0,0 +1,35 @@
+#ifndef ADC_SOURCE_H
+#define ADC_SOURCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @class AdcSource
+ * @brief Stream of raw conversions from the battery sense channel
+ *
+ * On the device the conversions come from the ADC's continuous (DMA) mode;
+ * on the host a synthetic source stands in, so the filtering in
+ * BatteryMonitor can be exercised against known noise.
+ */
+class AdcSource {
+public:
+  virtual ~AdcSource() {}
+
+  /**
+   * @brief Take conversions captured since the last call, without waiting
+   * @param samples Destination for raw 12-bit counts, oldest first
+   * @param maxSamples Capacity of samples
+   * @return Number of samples written (0 when none are pending)
+   */
+  virtual size_t read(uint16_t* samples, size_t maxSamples) = 0;
+
+  /**
+   * @brief Calibrated pin voltage for a raw count
+   * @param raw 12-bit conversion result
+   * @return Millivolts at the ADC pin (before the divider)
+   */
+  virtual uint32_t toMillivolts(uint32_t raw) const = 0;
+};
+
+#endif
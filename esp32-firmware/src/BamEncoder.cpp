@@ -0,0 +1,129 @@
+#include "BamEncoder.h"
+#include <string.h>
+
+// Bit of a stream byte carrying a line in pair k (cycle k of the byte)
+#define BAM_PAIR_BIT(k, line) (6 - 2 * (k) + (line))
+
+BamEncoder::BamEncoder()
+  : channels(0), registers(0), unitCycles(0), periodCycles(0), repeats(0) {
+  memset(buffer, 0, sizeof(buffer));
+}
+
+bool BamEncoder::begin(int channelCount) {
+  if (channelCount < 1 || channelCount > BAM_MAX_CHANNELS) return false;
+
+  channels = channelCount;
+  registers = (channelCount + 7) / 8;
+  unitCycles = (size_t)registers * 8;
+  periodCycles = unitCycles * BAM_PERIOD_UNITS;
+  repeats = (int)(BAM_BUFFER_SIZE / periodBytes());
+
+  // Plane k is latched (2^k - 1) units into the period
+  memset(buffer, 0, sizeof(buffer));
+  for (int period = 0; period < repeats; period++) {
+    for (int plane = 0; plane < BAM_PLANES; plane++) {
+      size_t latchCycle = (((size_t)1 << plane) - 1) * unitCycles;
+      setLine(period * periodCycles + latchCycle, BAM_LINE_RCLK, true);
+    }
+  }
+  return true;
+}
+
+void BamEncoder::setLine(size_t cycle, int line, bool high) {
+  uint8_t mask = 1 << BAM_PAIR_BIT(cycle % BAM_CYCLES_PER_BYTE, line);
+  uint8_t* data = buffer + cycle / BAM_CYCLES_PER_BYTE;
+  *data = high ? (*data | mask) : (*data & ~mask);
+}
+
+size_t BamEncoder::bitCycle(int plane, int channel) const {
+  // The first bit shifted ends up on Q7 of the register furthest from the MCU
+  size_t position = (size_t)(registers - 1 - channel / 8) * 8 + (7 - channel % 8);
+  size_t latchCycle = (((size_t)1 << plane) - 1) * unitCycles;
+  size_t start = plane == 0 ? periodCycles - unitCycles : latchCycle - unitCycles;
+  return start + position;
+}
+
+void BamEncoder::toggleBit(int plane, int channel) {
+  size_t cycle = bitCycle(plane, channel);
+  uint8_t mask = 1 << BAM_PAIR_BIT(cycle % BAM_CYCLES_PER_BYTE, BAM_LINE_SER);
+  for (int period = 0; period < repeats; period++) {
+    buffer[(period * periodCycles + cycle) / BAM_CYCLES_PER_BYTE] ^= mask;
+  }
+}
+
+void BamEncoder::encode(const uint8_t* frame) {
+  // Keep the latches, clear every SER bit
+  uint8_t rclkBits = BAM_LINE_RCLK ? 0xAA : 0x55;
+  size_t length = streamLength();
+  for (size_t i = 0; i < length; i++) buffer[i] &= rclkBits;
+
+  for (int c = 0; c < channels; c++) {
+    for (int plane = 0; plane < BAM_PLANES; plane++) {
+      if (frame[c] & (1 << plane)) toggleBit(plane, c);
+    }
+  }
+}
+
+int BamEncoder::update(const uint8_t* frame, const uint8_t* previous) {
+  int updated = 0;
+  for (int c = 0; c < channels; c++) {
+    uint8_t changed = frame[c] ^ previous[c];
+    if (!changed) continue;
+
+    for (int plane = 0; plane < BAM_PLANES; plane++) {
+      if (changed & (1 << plane)) toggleBit(plane, c);
+    }
+    updated++;
+  }
+  return updated;
+}
+
+// ---------------------------------------------------------------------------
+// ShiftChainModel
+
+ShiftChainModel::ShiftChainModel(int registerCount)
+  : rclk(false), registers(registerCount > BAM_MAX_REGISTERS ? BAM_MAX_REGISTERS : registerCount) {
+  memset(shift, 0, sizeof(shift));
+  memset(latched, 0, sizeof(latched));
+  resetCounters();
+}
+
+void ShiftChainModel::latch() {
+  for (int c = 0; c < registers * 8; c++) {
+    if (getOutput(c)) onTime[c] += elapsed - latchedAt;
+  }
+  memcpy(latched, shift, registers);
+  latchedAt = elapsed;
+}
+
+void ShiftChainModel::transfer(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    for (int k = 0; k < BAM_CYCLES_PER_BYTE; k++) {
+      bool ser = data[i] & (1 << BAM_PAIR_BIT(k, BAM_LINE_SER));
+      bool high = data[i] & (1 << BAM_PAIR_BIT(k, BAM_LINE_RCLK));
+
+      // RCLK rises half a cycle before SRCLK, so it latches the previous shift
+      if (high && !rclk) latch();
+      rclk = high;
+
+      // Register 0 is nearest the MCU; Q7 carries into the next register's Q0
+      uint8_t carry = ser;
+      for (int r = 0; r < registers; r++) {
+        uint8_t out = shift[r] >> 7;
+        shift[r] = (uint8_t)((shift[r] << 1) | carry);
+        carry = out;
+      }
+      elapsed++;
+    }
+  }
+}
+
+uint32_t ShiftChainModel::getOnTime(int channel) const {
+  return onTime[channel] + (getOutput(channel) ? elapsed - latchedAt : 0);
+}
+
+void ShiftChainModel::resetCounters() {
+  memset(onTime, 0, sizeof(onTime));
+  elapsed = 0;
+  latchedAt = 0;
+}
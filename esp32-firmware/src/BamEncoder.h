@@ -0,0 +1,143 @@
+#ifndef BAM_ENCODER_H
+#define BAM_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BAM_PLANES 8                              // 8-bit duty
+#define BAM_MAX_CHANNELS 128
+#define BAM_MAX_REGISTERS (BAM_MAX_CHANNELS / 8)  // 74HC595s in the chain
+#define BAM_PERIOD_UNITS 255                      // Sum of plane weights 1..128
+#define BAM_CYCLES_PER_BYTE 4                     // SCLK cycles per byte on two data lines
+#define BAM_BUFFER_SIZE (BAM_MAX_CHANNELS * BAM_PERIOD_UNITS / BAM_CYCLES_PER_BYTE)
+
+// Data line of each signal in dual (DIO) mode: every byte is sent as four
+// bit pairs, MSB pair first, with line 1 (MISO pin) carrying the high bit
+#define BAM_LINE_SER 0
+#define BAM_LINE_RCLK 1
+
+/**
+ * @class BamEncoder
+ * @brief Bit-angle modulation stream for a chain of 74HC595 shift registers
+ *
+ * The whole BAM period is one continuous bitstream on two SPI data lines:
+ * line 0 feeds SER, line 1 drives RCLK, and SCLK is SRCLK. A latch is one
+ * cycle with RCLK high, placed in the stream itself, so plane timing is
+ * set by SCLK cycles alone and no transaction boundary falls between
+ * planes. With N = one chain length of cycles, plane k is latched at
+ * cycle (2^k - 1) * N and shown for 2^k * N cycles; its bits are shifted
+ * in during the N cycles before its latch, while the previous plane is
+ * still on the outputs:
+ *
+ *   cycle 0      latch plane 0
+ *   cycle N      latch plane 1
+ *   cycle 3N     latch plane 2 ...
+ *   cycle 127N   latch plane 7, shown until the stream wraps
+ *   last N       plane 0 of the next period shifting in
+ *
+ * The buffer holds as many whole periods as fit, and the driver re-sends
+ * it back to back. The gap between two sends therefore only ever extends
+ * plane 7, which keeps output duty monotonic in the input duty. The CPU
+ * only touches the SER bits of channels whose duty changed.
+ */
+class BamEncoder {
+private:
+  alignas(4) uint8_t buffer[BAM_BUFFER_SIZE];   // DMA source
+  int channels;
+  int registers;
+  size_t unitCycles;      // One chain length: registers * 8
+  size_t periodCycles;    // BAM_PERIOD_UNITS units
+  int repeats;            // Whole periods in the buffer
+
+  /**
+   * @brief Set or clear one line in one SCLK cycle
+   */
+  void setLine(size_t cycle, int line, bool high);
+
+  /**
+   * @brief Flip a channel's SER bit for one plane in every period
+   */
+  void toggleBit(int plane, int channel);
+
+  /**
+   * @brief Cycle (within a period) carrying a channel's bit of a plane
+   */
+  size_t bitCycle(int plane, int channel) const;
+
+public:
+  BamEncoder();
+
+  /**
+   * @brief Lay out the stream and its latches for a chain length
+   * @param channelCount Number of outputs (rounded up to whole registers)
+   * @return false if the chain is longer than BAM_MAX_CHANNELS
+   */
+  bool begin(int channelCount);
+
+  /**
+   * @brief Rebuild every plane from a frame
+   */
+  void encode(const uint8_t* frame);
+
+  /**
+   * @brief Rewrite only the bits of channels that changed
+   * @return Number of channels updated
+   */
+  int update(const uint8_t* frame, const uint8_t* previous);
+
+  const uint8_t* stream() const { return buffer; }
+  size_t streamLength() const { return periodBytes() * repeats; }
+  int getRegisters() const { return registers; }
+  int getRepeats() const { return repeats; }
+
+  /**
+   * @brief SCLK cycles per BAM period
+   */
+  size_t getPeriodCycles() const { return periodCycles; }
+
+  /**
+   * @brief Bytes clocked out per BAM period
+   */
+  size_t periodBytes() const { return periodCycles / BAM_CYCLES_PER_BYTE; }
+};
+
+/**
+ * @class ShiftChainModel
+ * @brief Host model of a 74HC595 chain fed with the dual-line stream
+ *
+ * Every cycle latches first if RCLK rises, then shifts the SER bit in.
+ * Integrates how long every output was high, in SCLK cycles, including
+ * idle time between sends, during which the outputs hold.
+ */
+class ShiftChainModel {
+private:
+  uint8_t shift[BAM_MAX_REGISTERS];     // Bit s of register r is output Q(s)
+  uint8_t latched[BAM_MAX_REGISTERS];
+  uint32_t onTime[BAM_MAX_CHANNELS];    // Up to the last latch
+  uint32_t elapsed;
+  uint32_t latchedAt;
+  bool rclk;
+  int registers;
+
+  void latch();
+
+public:
+  explicit ShiftChainModel(int registerCount);
+
+  /**
+   * @brief Clock out one send of the stream
+   */
+  void transfer(const uint8_t* data, size_t length);
+
+  /**
+   * @brief Let time pass with the clock stopped (e.g. between sends)
+   */
+  void idle(uint32_t cycles) { elapsed += cycles; }
+
+  void resetCounters();
+  uint32_t getOnTime(int channel) const;
+  uint32_t getElapsed() const { return elapsed; }
+  bool getOutput(int channel) const { return latched[channel / 8] & (1 << (channel % 8)); }
+};
+
+#endif
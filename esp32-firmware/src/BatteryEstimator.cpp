@@ -0,0 +1,58 @@
+#include "BatteryEstimator.h"
+
+// Resting voltage vs. remaining charge of a Li-ion cell at room temperature
+struct DischargePoint {
+  uint16_t millivolts;
+  uint8_t percent;
+};
+
+static const DischargePoint dischargeCurve[] = {
+  {3000, 0}, {3450, 5}, {3680, 10}, {3740, 20}, {3780, 30}, {3820, 40},
+  {3850, 50}, {3900, 60}, {3970, 70}, {4050, 80}, {4110, 90}, {4200, 100}
+};
+static const int dischargePoints = sizeof(dischargeCurve) / sizeof(dischargeCurve[0]);
+
+BatteryEstimator::BatteryEstimator()
+  : filteredOcv(0), filteredLoad(0), reportedPercent(-1) {}
+
+uint32_t BatteryEstimator::loadForDutySum(uint32_t dutySum) {
+  return dutySum * MOTOR_CURRENT_MA / 255 + BATTERY_IDLE_MA;
+}
+
+int BatteryEstimator::socForVoltage(uint32_t ocvMv) {
+  if (ocvMv <= dischargeCurve[0].millivolts) return 0;
+  for (int i = 1; i < dischargePoints; i++) {
+    const DischargePoint& hi = dischargeCurve[i];
+    if (ocvMv < hi.millivolts) {
+      const DischargePoint& lo = dischargeCurve[i - 1];
+      return lo.percent + (int)((ocvMv - lo.millivolts) * (hi.percent - lo.percent) /
+                                (hi.millivolts - lo.millivolts));
+    }
+  }
+  return 100;
+}
+
+void BatteryEstimator::update(uint32_t terminalMv, uint32_t loadMa) {
+  // Undo the sag across the cell's internal resistance
+  uint32_t ocv = terminalMv + loadMa * BATTERY_INTERNAL_RESISTANCE_MOHM / 1000;
+
+  // Extra fractional bits keep the IIR from stalling within 16 mV of the input
+  if (reportedPercent < 0) {
+    filteredOcv = ocv << 4;
+    filteredLoad = loadMa << 4;
+  } else {
+    filteredOcv += ((int32_t)(ocv << 4) - (int32_t)filteredOcv) / BATTERY_FILTER_SAMPLES;
+    filteredLoad += ((int32_t)(loadMa << 4) - (int32_t)filteredLoad) / BATTERY_FILTER_SAMPLES;
+  }
+
+  int estimate = socForVoltage(filteredOcv >> 4);
+  if (reportedPercent < 0 || estimate < reportedPercent ||
+      estimate >= reportedPercent + BATTERY_SOC_HYSTERESIS) {
+    reportedPercent = estimate;
+  }
+}
+
+int BatteryEstimator::predictMinutes(uint32_t loadMa) const {
+  if (reportedPercent < 0 || loadMa == 0) return -1;
+  return (int)((uint32_t)reportedPercent * BATTERY_CAPACITY_MAH * 60 / 100 / loadMa);
+}
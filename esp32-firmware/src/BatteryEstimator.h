@@ -0,0 +1,76 @@
+#ifndef BATTERY_ESTIMATOR_H
+#define BATTERY_ESTIMATOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @class BatteryEstimator
+ * @brief Load-compensated state of charge for a single Li-ion cell
+ *
+ * The terminal voltage sags by I x R_internal while the motors run, so a
+ * voltage reading taken during CONSTANT looks several percent emptier than
+ * the same cell at rest. Each sample is corrected back to an open-circuit
+ * voltage using the load current modelled from the committed duty, low-pass
+ * filtered, and looked up in a piecewise discharge curve (the Li-ion curve
+ * is flat around 3.8 V and steep at both ends, so a linear map is off by
+ * up to 20%). The reported percentage only moves down while discharging;
+ * it rises again only once the estimate is BATTERY_SOC_HYSTERESIS above it
+ * (charger connected), so it does not jitter when the pattern changes.
+ */
+class BatteryEstimator {
+private:
+  uint32_t filteredOcv;         // Open-circuit estimate, mV in 28.4 fixed point
+  uint32_t filteredLoad;        // Modelled battery current, mA in 28.4 fixed point
+  int reportedPercent;          // -1 until the first sample
+
+public:
+  BatteryEstimator();
+
+  /**
+   * @brief Feed one voltage sample with the load it was taken under
+   * @param terminalMv Battery voltage at the terminals
+   * @param loadMa Current drawn at that moment (motors + electronics)
+   */
+  void update(uint32_t terminalMv, uint32_t loadMa);
+
+  /**
+   * @brief Current drawn by the motors for a committed frame
+   * @param dutySum Sum of the committed duties (8-bit)
+   * @return Motor current plus BATTERY_IDLE_MA
+   */
+  static uint32_t loadForDutySum(uint32_t dutySum);
+
+  /**
+   * @brief State of charge for an open-circuit voltage (discharge curve LUT)
+   * @param ocvMv Open-circuit voltage
+   * @return Percent, 0-100
+   */
+  static int socForVoltage(uint32_t ocvMv);
+
+  /**
+   * @brief Filtered open-circuit voltage estimate (0 before the first sample)
+   */
+  uint32_t getOpenCircuitMillivolts() const { return filteredOcv >> 4; }
+
+  /**
+   * @brief Stable state of charge
+   * @return Percent, or -1 before the first sample
+   */
+  int getPercent() const { return reportedPercent; }
+
+  /**
+   * @brief Runtime left at a given load
+   * @param loadMa Average battery current
+   * @return Minutes, or -1 before the first sample
+   */
+  int predictMinutes(uint32_t loadMa) const;
+
+  /**
+   * @brief Runtime left at the filtered load seen by the voltage samples
+   * @return Minutes, or -1 before the first sample
+   */
+  int getRuntimeMinutes() const { return predictMinutes(filteredLoad >> 4); }
+};
+
+#endif
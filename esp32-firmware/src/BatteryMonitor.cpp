@@ -0,0 +1,86 @@
+#include "BatteryMonitor.h"
+
+BatteryMonitor::BatteryMonitor(AdcSource* adc, float divider)
+  : source(adc), dividerRatio(divider), previousCount(0), blockSum(0), blockCount(0)
+  , blockHead(0), blocksFilled(0), restMvSum(0), restTicks(0), tickMvSum(0), tickMaSum(0)
+  , ticks(0), samplesRead(0), lastMillivolts(-1) {}
+
+void BatteryMonitor::addSample(uint16_t raw) {
+  uint16_t value = raw;
+  if (previousCount == 2) {
+    uint16_t a = previous[0], b = previous[1];
+    // Median of a, b, raw
+    if ((a <= b && b <= raw) || (raw <= b && b <= a)) value = b;
+    else if ((b <= a && a <= raw) || (raw <= a && a <= b)) value = a;
+  } else {
+    previousCount++;
+  }
+  previous[0] = previous[1];
+  previous[1] = raw;
+
+  blockSum += value;
+  if (++blockCount < BATTERY_ADC_OVERSAMPLE) return;
+
+  blocks[blockHead] = (uint16_t)(blockSum / BATTERY_ADC_OVERSAMPLE);
+  blockHead = (blockHead + 1) % BATTERY_ADC_MEDIAN_BLOCKS;
+  if (blocksFilled < BATTERY_ADC_MEDIAN_BLOCKS) blocksFilled++;
+  blockSum = 0;
+  blockCount = 0;
+}
+
+uint16_t BatteryMonitor::medianBlock() const {
+  uint16_t sorted[BATTERY_ADC_MEDIAN_BLOCKS];
+  for (int i = 0; i < blocksFilled; i++) {
+    uint16_t value = blocks[i];
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > value; j--) sorted[j] = sorted[j - 1];
+    sorted[j] = value;
+  }
+  return sorted[blocksFilled / 2];
+}
+
+int BatteryMonitor::poll(uint32_t loadMa) {
+  size_t count;
+  while ((count = source->read(buffer, BATTERY_ADC_READ_SAMPLES)) > 0) {
+    for (size_t i = 0; i < count; i++) addSample(buffer[i]);
+    samplesRead += count;
+  }
+
+  // Conversions left over belong to the next frame's load, not this one
+  int filled = blocksFilled;
+  uint16_t median = filled > 0 ? medianBlock() : 0;
+  blockSum = 0;
+  blockCount = 0;
+  blockHead = 0;
+  blocksFilled = 0;
+  previousCount = 0;
+  if (filled == 0) return -1;
+
+  uint32_t millivolts = (uint32_t)(source->toMillivolts(median) * dividerRatio);
+  if (loadMa <= BATTERY_IDLE_MA) {
+    restMvSum += millivolts;
+    restTicks++;
+  }
+  tickMvSum += millivolts;
+  tickMaSum += loadMa;
+  ticks++;
+  lastMillivolts = (int)millivolts;
+  return lastMillivolts;
+}
+
+bool BatteryMonitor::takeSample(uint32_t* terminalMv, uint32_t* loadMa) {
+  bool ready = ticks > 0;
+  if (restTicks > 0) {
+    *terminalMv = restMvSum / restTicks;
+    *loadMa = BATTERY_IDLE_MA;
+  } else if (ready) {
+    *terminalMv = tickMvSum / ticks;
+    *loadMa = tickMaSum / ticks;
+  }
+  restMvSum = 0;
+  restTicks = 0;
+  tickMvSum = 0;
+  tickMaSum = 0;
+  ticks = 0;
+  return ready;
+}
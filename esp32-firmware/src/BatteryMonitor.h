@@ -0,0 +1,85 @@
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <stdint.h>
+#include "config.h"
+#include "AdcSource.h"
+
+/**
+ * @class BatteryMonitor
+ * @brief Turns the continuous ADC stream into one clean reading per interval
+ *
+ * poll() runs once per motor tick and drains whatever the ADC captured
+ * during the frame that was just on the motors. Each conversion goes
+ * through a running median of three (drops single-sample switching
+ * spikes), is averaged in blocks of BATTERY_ADC_OVERSAMPLE (oversampling
+ * for resolution), and the tick's value is the median of those block
+ * means (drops blocks hit by a burst). Ticks are then averaged together
+ * with the load they ran under; BatteryEstimator applies the final IIR.
+ *
+ * Ticks with all motors off are the PWM-off phase: no switching noise and
+ * no sag. When an interval contains any, takeSample() reports only those,
+ * so pulsing patterns are measured at rest. Patterns that never rest fall
+ * back to the load-weighted mean of every tick.
+ */
+class BatteryMonitor {
+private:
+  AdcSource* source;
+  float dividerRatio;
+  uint16_t buffer[BATTERY_ADC_READ_SAMPLES];
+  uint16_t previous[2];          // Last two raw samples, for the median of three
+  int previousCount;
+  uint32_t blockSum;
+  int blockCount;
+  uint16_t blocks[BATTERY_ADC_MEDIAN_BLOCKS];   // Block means of the current tick
+  int blockHead;
+  int blocksFilled;
+
+  // Ticks accumulated since the last takeSample()
+  uint32_t restMvSum;
+  uint32_t restTicks;
+  uint32_t tickMvSum;
+  uint32_t tickMaSum;
+  uint32_t ticks;
+
+  uint32_t samplesRead;
+  int lastMillivolts;
+
+  void addSample(uint16_t raw);
+  uint16_t medianBlock() const;
+
+public:
+  /**
+   * @brief Constructor
+   * @param adc Source of raw conversions
+   * @param divider Battery voltage / pin voltage
+   */
+  BatteryMonitor(AdcSource* adc, float divider);
+
+  /**
+   * @brief Drain the ADC and file the result under the load that was running
+   * @param loadMa Battery current during the frame just committed
+   * @return Battery millivolts for this tick, or -1 if too few conversions arrived
+   */
+  int poll(uint32_t loadMa);
+
+  /**
+   * @brief Reading for the interval since the last call, then start a new one
+   * @param terminalMv Mean terminal voltage (rest ticks preferred)
+   * @param loadMa Mean load those ticks ran under
+   * @return false if no tick produced a reading
+   */
+  bool takeSample(uint32_t* terminalMv, uint32_t* loadMa);
+
+  /**
+   * @brief Conversions consumed since boot
+   */
+  uint32_t getSamplesRead() const { return samplesRead; }
+
+  /**
+   * @brief Most recent tick value (-1 before the first)
+   */
+  int getLastMillivolts() const { return lastMillivolts; }
+};
+
+#endif
@@ -0,0 +1,391 @@
+#include "Benchmarks.h"
+
+#ifdef ENABLE_BENCHMARKS
+
+#include "BulkTransfer.h"
+#include "CommandParser.h"
+#include "MotorController.h"
+#include "FixedMotorController.h"
+#include "I2cBus.h"
+#include "Pca9685Output.h"
+#include "BamEncoder.h"
+#include "PwmPhase.h"
+#include "ThermalModel.h"
+
+#define BENCH_BULK_PAYLOAD_SIZE 8192
+#define BENCH_BULK_ROUNDS 4
+
+#define BENCH_PARSER_ROUNDS 2000
+
+#define BENCH_KERNEL_FRAMES 1000
+#define BENCH_KERNEL_SEED 1
+
+#define BENCH_SHIFT_GAP_NS 10000   // Assumed idle time between two SPI sends (generous)
+
+static const uint16_t benchMtus[] = {23, 185, 247, 512};
+static const int benchChannelCounts[] = {8, 16, 32, 64, 128, 256};
+static const int benchShiftChannels[] = {32, 64, 128};
+static const int benchLedcChannels[] = {NUM_MOTORS, 16};
+static const MassageMode benchKernelModes[] = {
+  MODE_PULSE, MODE_WAVE, MODE_CONSTANT, MODE_HEARTBEAT, MODE_RAINDROPS,
+  MODE_SWEEP, MODE_RIPPLE, MODE_SPOT
+};
+// Typical app traffic: a slider drag, a timer, status polls
+static const char benchCommandTrace[] =
+  "M245\nM246\nM248\nM251\nM255\nM260\nT1800\nS\nM3100\nM10\n"
+  "  M462\r\nS\nD\nM575\nT60\nM000\n";
+
+void runBulkLoopbackBenchmark() {
+  static uint8_t source[BENCH_BULK_PAYLOAD_SIZE];
+  static uint8_t destination[BENCH_BULK_PAYLOAD_SIZE];
+  uint8_t frame[512];
+  uint8_t reply[BULK_ACK_SIZE];
+  
+  for (int i = 0; i < BENCH_BULK_PAYLOAD_SIZE; i++) {
+    source[i] = (uint8_t)(i * 31 + 7);
+  }
+  
+  BufferSink sink(destination, sizeof(destination));
+  BulkReassembler reassembler;
+  reassembler.registerSink(BULK_TARGET_SCRATCH, &sink);
+  
+  Serial.println("Bulk loopback benchmark (mtu, frames, us, KB/s, ok)");
+  
+  for (uint16_t mtu : benchMtus) {
+    BulkSegmenter segmenter;
+    unsigned long frames = 0;
+    unsigned long start = micros();
+    
+    for (int round = 0; round < BENCH_BULK_ROUNDS; round++) {
+      segmenter.start(round, BULK_TARGET_SCRATCH, source, sizeof(source), mtu);
+      size_t length;
+      while ((length = segmenter.nextFrame(frame)) > 0) {
+        reassembler.handleFrame(frame, length, reply);
+        frames++;
+      }
+    }
+    
+    unsigned long elapsed = micros() - start;
+    unsigned long bytes = (unsigned long)BENCH_BULK_PAYLOAD_SIZE * BENCH_BULK_ROUNDS;
+    unsigned long kbps = elapsed > 0 ? (bytes * 1000UL / elapsed) : 0;  // bytes/ms == KB/s
+    bool ok = sink.isValid() && memcmp(source, destination, sizeof(source)) == 0;
+    
+    Serial.printf("  %u, %lu, %lu, %lu, %s\n", mtu, frames, elapsed, kbps, ok ? "yes" : "NO");
+  }
+}
+
+void runCommandParserBenchmark() {
+  CommandParser parser;
+  unsigned long commands = 0;
+  long checksum = 0;  // Keeps the parse results live
+  
+  unsigned long start = micros();
+  for (int round = 0; round < BENCH_PARSER_ROUNDS; round++) {
+    for (const char* p = benchCommandTrace; *p; p++) {
+      if (parser.feed(*p)) {
+        long value = 0;
+        CommandParser::parseInteger(parser.line() + 1, &value);
+        checksum += value + parser.line()[0];
+        commands++;
+      }
+    }
+  }
+  unsigned long elapsed = micros() - start;
+  
+  Serial.println("Command parser benchmark (commands, us, ns/command, checksum)");
+  Serial.printf("  %lu, %lu, %lu, %ld\n", commands, elapsed,
+                commands > 0 ? elapsed * 1000UL / commands : 0, checksum);
+}
+
+/**
+ * @brief Time BENCH_KERNEL_FRAMES frames of one mode on a render-only controller
+ * @param cycles Receives CPU cycles per frame
+ * @param checksum Accumulates a rendered duty so the frames stay live
+ * @return ns per frame
+ */
+template <typename Controller>
+static unsigned long benchRender(Controller& renderer, MassageMode mode, int motors,
+                                 unsigned long* cycles, long* checksum) {
+  renderer.seedRandom(BENCH_KERNEL_SEED);
+  renderer.applyMode(mode, 75, 0);  // Warm up caches before timing
+  
+  uint32_t startCycles = ESP.getCycleCount();
+  unsigned long start = micros();
+  for (int frame = 0; frame < BENCH_KERNEL_FRAMES; frame++) {
+    renderer.applyMode(mode, 75, (unsigned long)frame * UPDATE_INTERVAL_MS);
+  }
+  unsigned long elapsed = micros() - start;
+  *cycles = (ESP.getCycleCount() - startCycles) / BENCH_KERNEL_FRAMES;
+  *checksum += renderer.getFrameDuty(motors - 1);
+  return elapsed * 1000UL / BENCH_KERNEL_FRAMES;
+}
+
+template <int N>
+static void benchFixedAgainstRuntime(MassageMode mode, long* checksum) {
+  // Render-only controllers: never started, so pins are not needed. Static,
+  // as two 256-channel controllers would not fit on the loop task's stack;
+  // benchRender() reseeds them and a mode change resets their pattern state
+  static MotorController runtime(nullptr, N, MAX_DUTY_CYCLE);
+  static FixedMotorController<N, MAX_DUTY_CYCLE> fixed(nullptr);
+  
+  unsigned long runtimeCycles, fixedCycles;
+  benchRender(runtime, mode, N, &runtimeCycles, checksum);
+  benchRender(fixed, mode, N, &fixedCycles, checksum);
+  
+  unsigned long speedup = fixedCycles > 0 ? runtimeCycles * 100 / fixedCycles : 0;
+  Serial.printf("  %d, %3d, %lu, %lu, %lu.%02lux\n", (int)mode, N, runtimeCycles, fixedCycles,
+                speedup / 100, speedup % 100);
+}
+
+void runPatternKernelBenchmark() {
+  long checksum = 0;
+  
+  Serial.println("Pattern kernel benchmark (mode, motors, ns/frame, cycles/frame, % of tick)");
+  
+  for (MassageMode mode : benchKernelModes) {
+    for (int motors : benchChannelCounts) {
+      MotorController renderer(nullptr, motors, MAX_DUTY_CYCLE);
+      unsigned long cycles;
+      unsigned long nsPerFrame = benchRender(renderer, mode, motors, &cycles, &checksum);
+      
+      unsigned long milliPercent = (unsigned long)((uint64_t)nsPerFrame * 100000ULL / (UPDATE_INTERVAL_MS * 1000000ULL));
+      Serial.printf("  %d, %3d, %lu, %lu, %lu.%03lu\n", (int)mode, motors, nsPerFrame, cycles,
+                    milliPercent / 1000, milliPercent % 1000);
+    }
+  }
+  
+  Serial.println("Compile-time controller (mode, motors, runtime cycles/frame, fixed cycles/frame, speedup)");
+  
+  for (MassageMode mode : benchKernelModes) {
+    benchFixedAgainstRuntime<NUM_MOTORS>(mode, &checksum);
+    benchFixedAgainstRuntime<64>(mode, &checksum);
+    benchFixedAgainstRuntime<256>(mode, &checksum);
+  }
+  
+  // Per-tick thermal bookkeeping (limit + update) at 64 channels
+  static ThermalModel thermal(64, MAX_DUTY_CYCLE);
+  static uint8_t frame[64];
+  memset(frame, MAX_DUTY_CYCLE, sizeof(frame));
+  uint32_t startCycles = ESP.getCycleCount();
+  unsigned long start = micros();
+  for (int tick = 0; tick < BENCH_KERNEL_FRAMES; tick++) {
+    checksum += thermal.limit(frame);
+    thermal.update(frame);
+  }
+  unsigned long elapsed = micros() - start;
+  Serial.printf("Thermal model, 64 channels: %lu ns/tick, %lu cycles/tick\n",
+                elapsed * 1000UL / BENCH_KERNEL_FRAMES,
+                (unsigned long)((ESP.getCycleCount() - startCycles) / BENCH_KERNEL_FRAMES));
+  
+  Serial.printf("  checksum %ld\n", checksum);
+}
+
+/**
+ * @brief Modelled bus with every expander address attached, shared by all B5 runs
+ */
+static CountingI2cBus& benchExpanderBus() {
+  static CountingI2cBus bus;
+  static bool attached = false;
+  if (!attached) {
+    for (int chip = 0; chip < PCA9685_MAX_CHIPS; chip++) bus.addDevice(PCA9685_BASE_ADDRESS + chip);
+    attached = true;
+  }
+  return bus;
+}
+
+template <int Motors>
+static void benchExpanderCommits() {
+  // Static: together these are several KB, too much for the loop task's stack
+  static Pca9685Output expander(&benchExpanderBus(), PCA9685_BASE_ADDRESS, PCA9685_PWM_FREQUENCY);
+  static MotorController renderer(nullptr, Motors, MAX_DUTY_CYCLE);
+  static uint8_t off[Motors];
+  static uint8_t on[Motors];
+  CountingI2cBus& bus = benchExpanderBus();
+  renderer.setOutput(&expander);
+  
+  for (MassageMode mode : benchKernelModes) {
+    if (!renderer.begin()) {
+      Serial.println("  expander init failed");
+      return;
+    }
+    // Back to the all-off frame begin() leaves in the chips
+    renderer.applyMode(MODE_OFF, 0, 0);
+    renderer.commitFrame();
+    renderer.seedRandom(BENCH_KERNEL_SEED);
+    bus.resetCounters();
+    
+    unsigned long cpuMicros = 0;
+    for (int frame = 0; frame < BENCH_KERNEL_FRAMES; frame++) {
+      renderer.applyMode(mode, 75, (unsigned long)frame * UPDATE_INTERVAL_MS);
+      unsigned long start = micros();
+      renderer.commitFrame();
+      cpuMicros += micros() - start;
+    }
+    
+    // The modelled chips must hold exactly the last committed frame
+    bool ok = true;
+    for (int i = 0; i < Motors && ok; i++) {
+      uint8_t expected[4];
+      Pca9685Output::encodeDuty(renderer.getCommittedDuty(i), expected);
+      const uint8_t* regs = bus.getRegisters(PCA9685_BASE_ADDRESS + i / PCA9685_CHANNELS);
+      ok = memcmp(regs + PCA9685_LED0_ON_L + 4 * (i % PCA9685_CHANNELS), expected, 4) == 0;
+    }
+    
+    Serial.printf("  %d, %2d, %lu.%02lu, %lu.%02lu, %lu, %lu, %lu, %s\n", (int)mode, Motors,
+                  bus.getBytes() / BENCH_KERNEL_FRAMES, (bus.getBytes() * 100 / BENCH_KERNEL_FRAMES) % 100,
+                  bus.getTransactions() / BENCH_KERNEL_FRAMES,
+                  (bus.getTransactions() * 100 / BENCH_KERNEL_FRAMES) % 100,
+                  bus.getBusMicros(400000) / BENCH_KERNEL_FRAMES,
+                  bus.getBusMicros(1000000) / BENCH_KERNEL_FRAMES,
+                  cpuMicros * 1000UL / BENCH_KERNEL_FRAMES, ok ? "yes" : "NO");
+  }
+  
+  // Worst case: every channel changes in one commit
+  expander.begin(Motors);
+  bus.resetCounters();
+  memset(off, 0, sizeof(off));
+  memset(on, MAX_DUTY_CYCLE, sizeof(on));
+  expander.commit(on, off, Motors);
+  Serial.printf("  full frame, %2d motors: %lu bytes, bus %lu us @400kHz, %lu us @1MHz\n", Motors,
+                bus.getBytes(), bus.getBusMicros(400000), bus.getBusMicros(1000000));
+}
+
+void runPca9685Benchmark() {
+  Serial.println("PCA9685 commit benchmark (mode, motors, bytes/commit, transactions/commit, "
+                 "bus us @400kHz, bus us @1MHz, cpu ns/commit, registers ok)");
+  
+  benchExpanderCommits<16>();
+  benchExpanderCommits<32>();
+  benchExpanderCommits<64>();
+}
+
+void runShiftRegisterBenchmark() {
+  static BamEncoder encoder;
+  static uint8_t frame[BAM_MAX_CHANNELS];
+  static uint8_t previous[BAM_MAX_CHANNELS];
+  static uint32_t dutyOnTime[256];
+  
+  Serial.println("Shift-register BAM benchmark (motors, encode ns, update ns/tick, bytes/refresh, "
+                 "refresh Hz, sends/s, re-encode cpu us/s, update cpu us/s, bitstream ok, "
+                 "monotonic with gap, worst error 1/1000)");
+  
+  uint32_t gapCycles = (uint32_t)((uint64_t)BENCH_SHIFT_GAP_NS * SHIFT_SPI_CLOCK_HZ / 1000000000ULL);
+  
+  for (int motors : benchShiftChannels) {
+    encoder.begin(motors);
+    MotorController renderer(nullptr, motors, MAX_DUTY_CYCLE);
+    
+    // Full rebuild, as a CPU-driven software PWM would do every refresh
+    for (int i = 0; i < motors; i++) frame[i] = (uint8_t)(i * 37);
+    unsigned long start = micros();
+    for (int round = 0; round < BENCH_KERNEL_FRAMES; round++) {
+      frame[round % motors] ^= 1;
+      encoder.encode(frame);
+    }
+    unsigned long encodeNs = (micros() - start) * 1000UL / BENCH_KERNEL_FRAMES;
+    
+    // Incremental patch per engine tick while a wave runs
+    encoder.encode(frame);
+    memcpy(previous, frame, motors);
+    unsigned long updateMicros = 0;
+    for (int tick = 0; tick < BENCH_KERNEL_FRAMES; tick++) {
+      renderer.applyMode(MODE_WAVE, 75, (unsigned long)tick * UPDATE_INTERVAL_MS);
+      for (int i = 0; i < motors; i++) frame[i] = (uint8_t)renderer.getFrameDuty(i);
+      start = micros();
+      encoder.update(frame, previous);
+      updateMicros += micros() - start;
+      memcpy(previous, frame, motors);
+    }
+    unsigned long updateNs = updateMicros * 1000UL / BENCH_KERNEL_FRAMES;
+    
+    // Replay one send back to back through the modelled chain; on-time must equal duty exactly
+    ShiftChainModel chain(encoder.getRegisters());
+    uint32_t unitCycles = encoder.getRegisters() * 8;
+    for (int pass = 0; pass < 2; pass++) {
+      chain.resetCounters();
+      chain.transfer(encoder.stream(), encoder.streamLength());
+    }
+    bool ok = true;
+    for (int i = 0; i < motors; i++) {
+      if (chain.getOnTime(i) != (uint32_t)frame[i] * unitCycles * encoder.getRepeats()) ok = false;
+    }
+    
+    // Every duty with a pessimistic gap between sends: on-time must rise with duty
+    uint32_t elapsed = 0;
+    for (int base = 0; base < 256; base += motors) {
+      for (int i = 0; i < motors; i++) frame[i] = (uint8_t)(base + i);
+      encoder.encode(frame);
+      for (int pass = 0; pass < 2; pass++) {
+        chain.resetCounters();
+        chain.transfer(encoder.stream(), encoder.streamLength());
+        chain.idle(gapCycles);
+      }
+      for (int i = 0; i < motors && base + i < 256; i++) dutyOnTime[base + i] = chain.getOnTime(i);
+      elapsed = chain.getElapsed();
+    }
+    bool monotonic = true;
+    unsigned long worstError = 0;
+    for (int duty = 0; duty < 256; duty++) {
+      if (duty > 0 && dutyOnTime[duty] <= dutyOnTime[duty - 1]) monotonic = false;
+      long ideal = (long)((uint64_t)duty * elapsed / 255);
+      unsigned long error = (unsigned long)labs((long)dutyOnTime[duty] - ideal) * 1000UL / elapsed;
+      if (error > worstError) worstError = error;
+    }
+    
+    unsigned long bytes = encoder.periodBytes();
+    unsigned long refreshHz = SHIFT_SPI_CLOCK_HZ / encoder.getPeriodCycles();
+    unsigned long sendsPerSecond = refreshHz / encoder.getRepeats();
+    unsigned long ticksPerSecond = 1000UL / UPDATE_INTERVAL_MS;
+    Serial.printf("  %3d, %lu, %lu, %lu, %lu, %lu, %lu, %lu, %s, %s, %lu\n", motors, encodeNs, updateNs,
+                  bytes, refreshHz, sendsPerSecond, encodeNs * refreshHz / 1000UL,
+                  updateNs * ticksPerSecond / 1000UL, ok ? "yes" : "NO", monotonic ? "yes" : "NO",
+                  worstError);
+  }
+}
+
+void runPwmPhaseBenchmark() {
+  uint8_t frame[16];
+  uint16_t aligned[16] = {0};
+  uint16_t staggered[16];
+  const uint16_t period = 1 << PWM_RESOLUTION;
+  
+  Serial.println("PWM phase benchmark (mode, motors, mean mA, peak mA aligned/staggered, "
+                 "worst peak mA aligned/staggered, rms mA aligned/staggered)");
+  
+  for (int motors : benchLedcChannels) {
+    for (MassageMode mode : benchKernelModes) {
+      MotorController renderer(nullptr, motors, MAX_DUTY_CYCLE);
+      renderer.seedRandom(BENCH_KERNEL_SEED);
+      
+      uint32_t meanSum = 0, alignedPeakSum = 0, staggeredPeakSum = 0;
+      uint32_t alignedWorst = 0, staggeredWorst = 0, alignedRmsSum = 0, staggeredRmsSum = 0;
+      for (int tick = 0; tick < BENCH_KERNEL_FRAMES; tick++) {
+        renderer.applyMode(mode, 100, (unsigned long)tick * UPDATE_INTERVAL_MS);
+        for (int i = 0; i < motors; i++) {
+          frame[i] = (uint8_t)renderer.getFrameDuty(i);
+          staggered[i] = pwmStaggeredHpoint(i, motors, frame[i], period);
+        }
+        
+        PwmCurrentStats a = pwmAggregateCurrent(frame, aligned, motors, period, MOTOR_CURRENT_MA);
+        PwmCurrentStats s = pwmAggregateCurrent(frame, staggered, motors, period, MOTOR_CURRENT_MA);
+        meanSum += a.meanMilliamps;
+        alignedPeakSum += a.peakMilliamps;
+        staggeredPeakSum += s.peakMilliamps;
+        alignedRmsSum += a.rmsMilliamps;
+        staggeredRmsSum += s.rmsMilliamps;
+        if (a.peakMilliamps > alignedWorst) alignedWorst = a.peakMilliamps;
+        if (s.peakMilliamps > staggeredWorst) staggeredWorst = s.peakMilliamps;
+      }
+      
+      Serial.printf("  %d, %2d, %lu, %lu/%lu, %lu/%lu, %lu/%lu\n", (int)mode, motors,
+                    (unsigned long)(meanSum / BENCH_KERNEL_FRAMES),
+                    (unsigned long)(alignedPeakSum / BENCH_KERNEL_FRAMES),
+                    (unsigned long)(staggeredPeakSum / BENCH_KERNEL_FRAMES),
+                    (unsigned long)alignedWorst, (unsigned long)staggeredWorst,
+                    (unsigned long)(alignedRmsSum / BENCH_KERNEL_FRAMES),
+                    (unsigned long)(staggeredRmsSum / BENCH_KERNEL_FRAMES));
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <Arduino.h>
+
+// Benchmark suites selectable with the B command
+#define BENCH_SUITE_BULK 1
+#define BENCH_SUITE_PARSER 2
+#define BENCH_SUITE_PATTERNS 3   // Golden-trace regression (see PatternRegression.h)
+#define BENCH_SUITE_KERNELS 4
+#define BENCH_SUITE_PCA9685 5
+#define BENCH_SUITE_SHIFT_REGISTER 6
+#define BENCH_SUITE_PWM_PHASE 7
+
+// The suites below keep their buffers in static storage (tens of KB of
+// .bss), so they are only built with -DENABLE_BENCHMARKS (the
+// esp32dev-bench environment and the host tests). Suite 3 lives in
+// PatternRegression and is always available.
+#ifdef ENABLE_BENCHMARKS
+
+/**
+ * @brief Measure bulk segment/reassemble throughput over an in-memory loopback
+ *
+ * Runs the segmenter and reassembler back to back for a range of MTUs so
+ * the protocol core can be measured without the radio. Results are
+ * printed to Serial.
+ */
+void runBulkLoopbackBenchmark();
+
+/**
+ * @brief Measure the shared command parser on a recorded command mix
+ *
+ * Feeds a slider-drag style command trace through CommandParser byte by
+ * byte (the same path every transport uses) and prints ns per command.
+ */
+void runCommandParserBenchmark();
+
+/**
+ * @brief Measure every pattern kernel from 8 to 256 motors
+ *
+ * Renders each mode on a detached MotorController (no PWM output) and
+ * prints ns and CPU cycles per frame, plus the share of one engine tick
+ * the kernel uses, to show which patterns outgrow the tick budget as the
+ * channel count rises. Then compares MotorController with the
+ * compile-time FixedMotorController at 8, 64 and 256 motors, and times
+ * the per-tick ThermalModel bookkeeping for 64 channels.
+ */
+void runPatternKernelBenchmark();
+
+/**
+ * @brief Measure PCA9685 frame commits on a modelled I2C bus
+ *
+ * Drives 16, 32 and 64 motors (1-4 expanders) through MotorController
+ * and Pca9685Output on a CountingI2cBus and prints bytes, transactions
+ * and bus time per commit at 400 kHz and 1 MHz, the CPU time to build
+ * the writes, and whether the modelled registers match the last frame.
+ */
+void runPca9685Benchmark();
+
+/**
+ * @brief Measure the 74HC595 BAM encoder and check its bitstreams
+ *
+ * For 32, 64 and 128 channels: time to build all bitplanes, time to
+ * patch them for a wave step, bytes and refresh rate per BAM period at
+ * SHIFT_SPI_CLOCK_HZ, whether a modelled shift-register chain fed with
+ * the stream reproduces every duty exactly, and whether on-time still
+ * rises monotonically with duty when sends are BENCH_SHIFT_GAP_NS apart.
+ */
+void runShiftRegisterBenchmark();
+
+/**
+ * @brief Compare supply current with aligned and staggered PWM phases
+ *
+ * Renders every mode for 8 and 16 LEDC channels and feeds each frame to
+ * the current model (PwmPhase.h) twice: all channels switching on at
+ * count 0, and with the staggered hpoints MotorController programs.
+ * Prints mean and worst per-frame peak and RMS current for both.
+ */
+void runPwmPhaseBenchmark();
+
+#endif
+
+#endif
@@ -0,0 +1,270 @@
+#if defined(ARDUINO) && !defined(USE_SPP_TRANSPORT)
+
+#include "BleTransport.h"
+
+// Connection interval reported by the GAP layer (1.25ms units)
+static volatile uint16_t negotiatedConnInterval = 0;
+
+static void gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+  if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT) {
+    negotiatedConnInterval = param->update_conn_params.conn_int;
+  }
+}
+
+// BLE Server Callbacks
+class ServerCallbacks : public BLEServerCallbacks {
+  private:
+    BleTransport* transport;
+  public:
+    ServerCallbacks(BleTransport* t) : transport(t) {}
+    
+    void onConnect(BLEServer* pServer) {
+      transport->setConnected(true);
+      Serial.println("BLE Client connected");
+    }
+    
+    void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+      // Peer address is needed to request connection parameter updates
+      transport->setPeerAddress(param->connect.remote_bda);
+    }
+    
+    void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+      transport->setMtu(param->mtu.mtu);
+      Serial.print("MTU negotiated: ");
+      Serial.println(param->mtu.mtu);
+    }
+    
+    void onDisconnect(BLEServer* pServer) {
+      transport->setConnected(false);
+      Serial.println("BLE Client disconnected");
+      // Restart advertising
+      BLEDevice::startAdvertising();
+      Serial.println("Advertising restarted");
+    }
+};
+
+// Command writes are queued immediately so none are lost to polling
+class CommandCharacteristicCallbacks : public BLECharacteristicCallbacks {
+  private:
+    BleTransport* transport;
+  public:
+    CommandCharacteristicCallbacks(BleTransport* t) : transport(t) {}
+    
+    void onWrite(BLECharacteristic* characteristic) {
+      transport->receiveCommandBytes(characteristic->getData(), characteristic->getLength());
+    }
+};
+
+// Bulk frames are handled in the BLE task and written straight to their sink
+class BulkCharacteristicCallbacks : public BLECharacteristicCallbacks {
+  private:
+    BleTransport* transport;
+  public:
+    BulkCharacteristicCallbacks(BleTransport* t) : transport(t) {}
+    
+    void onWrite(BLECharacteristic* characteristic) {
+      transport->handleBulkFrame(characteristic->getData(), characteristic->getLength());
+    }
+};
+
+BleTransport::BleTransport()
+  : pServer(nullptr), pCharacteristic(nullptr), pBulkCharacteristic(nullptr), bulkReceiver(nullptr)
+  , deviceConnected(false), negotiatedMtu(BLE_DEFAULT_MTU), rxHead(0), rxTail(0), rxDropped(0)
+  , stampHead(0), stampTail(0)
+  , peerAddressValid(false), connProfile(CONN_PROFILE_NONE), lastActivityTime(0) {}
+
+bool BleTransport::begin(const char* deviceName) {
+  BLEDevice::init(deviceName);
+  BLEDevice::setCustomGapHandler(gapEventHandler);
+  
+  // Set MTU to larger size for longer messages
+  BLEDevice::setMTU(BLE_MAX_MTU);
+  
+  pServer = BLEDevice::createServer();
+  pServer->setCallbacks(new ServerCallbacks(this));
+  
+  BLEService *pService = pServer->createService(SERVICE_UUID);
+  pCharacteristic = pService->createCharacteristic(
+    CHARACTERISTIC_UUID,
+    BLECharacteristic::PROPERTY_READ |
+    BLECharacteristic::PROPERTY_WRITE |
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  pCharacteristic->addDescriptor(new BLE2902());
+  pCharacteristic->setCallbacks(new CommandCharacteristicCallbacks(this));
+  
+  pBulkCharacteristic = pService->createCharacteristic(
+    BULK_CHARACTERISTIC_UUID,
+    BLECharacteristic::PROPERTY_WRITE |
+    BLECharacteristic::PROPERTY_WRITE_NR |
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  pBulkCharacteristic->addDescriptor(new BLE2902());
+  pBulkCharacteristic->setCallbacks(new BulkCharacteristicCallbacks(this));
+  
+  pService->start();
+  
+  BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
+  pAdvertising->addServiceUUID(SERVICE_UUID);
+  pAdvertising->setScanResponse(true);
+  pAdvertising->setMinPreferred(CONN_LOW_LATENCY_MIN_INTERVAL);
+  pAdvertising->setMaxPreferred(CONN_LOW_LATENCY_MAX_INTERVAL);
+  BLEDevice::startAdvertising();
+  
+  return true;
+}
+
+void BleTransport::setConnected(bool connected) {
+  deviceConnected = connected;
+  connProfile = CONN_PROFILE_NONE;  // Renegotiate on every new connection
+  
+  if (connected) {
+    lastActivityTime = millis();  // The user is interacting right after connecting
+  } else {
+    peerAddressValid = false;
+    negotiatedConnInterval = 0;
+    negotiatedMtu = BLE_DEFAULT_MTU;
+  }
+}
+
+void BleTransport::setPeerAddress(const esp_bd_addr_t address) {
+  memcpy(peerAddress, address, sizeof(esp_bd_addr_t));
+  peerAddressValid = true;
+}
+
+void BleTransport::setMtu(uint16_t mtu) {
+  negotiatedMtu = mtu;
+}
+
+void BleTransport::setBulkReceiver(BulkReassembler* receiver) {
+  bulkReceiver = receiver;
+}
+
+void BleTransport::receiveCommandBytes(const uint8_t* data, size_t length) {
+  noteActivity();
+  uint32_t now = micros();
+  
+  uint16_t head = rxHead.load(std::memory_order_relaxed);
+  uint16_t tail = rxTail.load(std::memory_order_acquire);
+  uint8_t stamp = stampHead.load(std::memory_order_relaxed);
+  uint8_t stampEnd = stampTail.load(std::memory_order_acquire);
+  
+  for (size_t i = 0; i < length; i++) {
+    uint16_t next = (head + 1) % BLE_RX_BUFFER_SIZE;
+    uint8_t nextStamp = (stamp + 1) % BLE_RX_STAMP_COUNT;
+    
+    // Every queued newline has exactly one timestamp
+    if (next == tail || (data[i] == '\n' && nextStamp == stampEnd)) {
+      rxDropped += length - i;  // Loop has fallen behind; drop the rest
+      break;
+    }
+    if (data[i] == '\n') {
+      rxStamps[stamp] = now;
+      stamp = nextStamp;
+    }
+    rxBuffer[head] = data[i];
+    head = next;
+  }
+  stampHead.store(stamp, std::memory_order_release);
+  rxHead.store(head, std::memory_order_release);
+}
+
+bool BleTransport::takeCommandTimestamp(uint32_t* receivedUs) {
+  uint8_t tail = stampTail.load(std::memory_order_relaxed);
+  if (tail == stampHead.load(std::memory_order_acquire)) return false;
+  
+  *receivedUs = rxStamps[tail];
+  stampTail.store((tail + 1) % BLE_RX_STAMP_COUNT, std::memory_order_release);
+  return true;
+}
+
+size_t BleTransport::read(uint8_t* buffer, size_t capacity) {
+  uint16_t tail = rxTail.load(std::memory_order_relaxed);
+  uint16_t head = rxHead.load(std::memory_order_acquire);
+  size_t count = 0;
+  
+  while (tail != head && count < capacity) {
+    buffer[count++] = rxBuffer[tail];
+    tail = (tail + 1) % BLE_RX_BUFFER_SIZE;
+  }
+  rxTail.store(tail, std::memory_order_release);
+  return count;
+}
+
+void BleTransport::sendMessage(const char* message) {
+  if (deviceConnected && pCharacteristic) {
+    pCharacteristic->setValue((uint8_t*)message, strlen(message));
+    pCharacteristic->notify();
+    delay(20);  // Small delay to ensure message is sent completely
+  }
+}
+
+void BleTransport::handleBulkFrame(const uint8_t* data, size_t length) {
+  noteActivity();  // Streaming keeps the low-latency connection profile
+  if (!bulkReceiver) return;
+  
+  uint8_t reply[BULK_ACK_SIZE];
+  size_t replyLength = bulkReceiver->handleFrame(data, length, reply);
+  if (replyLength > 0) {
+    sendBulk(reply, replyLength);
+  }
+}
+
+bool BleTransport::sendBulk(const uint8_t* data, size_t length) {
+  if (!deviceConnected || !pBulkCharacteristic) return false;
+  
+  noteActivity();  // Hold low latency while streaming to the app
+  pBulkCharacteristic->setValue((uint8_t*)data, length);
+  pBulkCharacteristic->notify();
+  return true;
+}
+
+void BleTransport::noteActivity() {
+  lastActivityTime = millis();
+}
+
+void BleTransport::poll(unsigned long timestamp) {
+  if (!deviceConnected || !peerAddressValid) return;
+  
+  // Short interval while the user is adjusting or data is streaming,
+  // long interval with slave latency once the session is steady
+  ConnectionProfile wanted = (timestamp - lastActivityTime < CONN_IDLE_TIMEOUT_MS)
+    ? CONN_PROFILE_LOW_LATENCY
+    : CONN_PROFILE_POWER_SAVE;
+  
+  if (wanted != connProfile) {
+    requestConnectionProfile(wanted);
+  }
+}
+
+void BleTransport::requestConnectionProfile(ConnectionProfile profile) {
+  if (profile == CONN_PROFILE_LOW_LATENCY) {
+    pServer->updateConnParams(peerAddress,
+                              CONN_LOW_LATENCY_MIN_INTERVAL,
+                              CONN_LOW_LATENCY_MAX_INTERVAL,
+                              CONN_LOW_LATENCY_SLAVE_LATENCY,
+                              CONN_LOW_LATENCY_TIMEOUT);
+    Serial.println("Requesting low-latency connection profile");
+  } else {
+    pServer->updateConnParams(peerAddress,
+                              CONN_POWER_SAVE_MIN_INTERVAL,
+                              CONN_POWER_SAVE_MAX_INTERVAL,
+                              CONN_POWER_SAVE_SLAVE_LATENCY,
+                              CONN_POWER_SAVE_TIMEOUT);
+    Serial.println("Requesting power-save connection profile");
+  }
+  connProfile = profile;
+}
+
+unsigned long BleTransport::getConnectionIntervalUs() const {
+  return negotiatedConnInterval * 1250UL;
+}
+
+size_t BleTransport::formatDiagnostics(char* out, size_t capacity) const {
+  int n = snprintf(out, capacity, "conn_profile=%d,conn_interval_us=%lu,mtu=%u,rx_dropped=%lu",
+                   (int)connProfile, getConnectionIntervalUs(), (unsigned)negotiatedMtu, rxDropped);
+  if (n < 0) return 0;
+  return (size_t)n < capacity ? (size_t)n : capacity - 1;
+}
+
+#endif
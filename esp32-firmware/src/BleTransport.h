@@ -0,0 +1,95 @@
+#ifndef BLE_TRANSPORT_H
+#define BLE_TRANSPORT_H
+
+#if defined(ARDUINO) && !defined(USE_SPP_TRANSPORT)
+
+#include <atomic>
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLEUtils.h>
+#include <BLE2902.h>
+#include "config.h"
+#include "Transport.h"
+
+#define BLE_RX_BUFFER_SIZE 512
+#define BLE_RX_STAMP_COUNT 32     // Command lines timestamped but not yet read
+
+/**
+ * @class BleTransport
+ * @brief GATT transport: command characteristic plus bulk characteristic
+ *
+ * Command writes are queued from the BLE task into a ring buffer so none
+ * are lost between loop iterations. Connection parameters follow link
+ * activity (low latency while in use, power save when steady).
+ */
+class BleTransport : public Transport {
+private:
+  BLEServer* pServer;
+  BLECharacteristic* pCharacteristic;
+  BLECharacteristic* pBulkCharacteristic;
+  BulkReassembler* bulkReceiver;
+  volatile bool deviceConnected;
+  uint16_t negotiatedMtu;
+
+  // Command bytes from the BLE task (producer) to the loop (consumer)
+  uint8_t rxBuffer[BLE_RX_BUFFER_SIZE];
+  std::atomic<uint16_t> rxHead;
+  std::atomic<uint16_t> rxTail;
+  unsigned long rxDropped;
+
+  // Arrival time of each queued newline, for command latency tracing
+  uint32_t rxStamps[BLE_RX_STAMP_COUNT];
+  std::atomic<uint8_t> stampHead;
+  std::atomic<uint8_t> stampTail;
+
+  // Connection parameter negotiation
+  esp_bd_addr_t peerAddress;
+  bool peerAddressValid;
+  ConnectionProfile connProfile;
+  volatile unsigned long lastActivityTime;
+
+  /**
+   * @brief Request connection parameters for a profile from the central
+   * @param profile Profile to switch to
+   */
+  void requestConnectionProfile(ConnectionProfile profile);
+
+public:
+  BleTransport();
+
+  // Transport
+  bool begin(const char* deviceName) override;
+  size_t read(uint8_t* buffer, size_t capacity) override;
+  bool takeCommandTimestamp(uint32_t* receivedUs) override;
+  void sendMessage(const char* message) override;
+  bool isConnected() const override { return deviceConnected; }
+  void poll(unsigned long timestamp) override;
+  void setBulkReceiver(BulkReassembler* receiver) override;
+  bool sendBulk(const uint8_t* data, size_t length) override;
+  uint16_t getMtu() const override { return negotiatedMtu; }
+  size_t formatDiagnostics(char* out, size_t capacity) const override;
+
+  // Called from the BLE stack callbacks
+  void setConnected(bool connected);
+  void setPeerAddress(const esp_bd_addr_t address);
+  void setMtu(uint16_t mtu);
+  void receiveCommandBytes(const uint8_t* data, size_t length);
+  void handleBulkFrame(const uint8_t* data, size_t length);
+
+  /**
+   * @brief Record link activity (commands, streaming) to hold low latency
+   */
+  void noteActivity();
+
+  ConnectionProfile getConnectionProfile() const { return connProfile; }
+
+  /**
+   * @brief Get the connection interval reported by the stack
+   * @return Interval in microseconds (0 if not yet known)
+   */
+  unsigned long getConnectionIntervalUs() const;
+};
+
+#endif
+
+#endif
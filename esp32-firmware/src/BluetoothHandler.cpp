@@ -1,85 +1,134 @@
 #include "BluetoothHandler.h"
+#include "Benchmarks.h"
+#include "PatternRegression.h"
 
-BluetoothHandler::BluetoothHandler(SessionManager* manager)
-  : pServer(nullptr), pCharacteristic(nullptr), sessionManager(manager), deviceConnected(false), commandBuffer("") {}
+BluetoothHandler::BluetoothHandler(Transport* link, SessionManager* manager)
+  : transport(link), sessionManager(manager), otaUpdater(nullptr)
+  , latencyTracker(nullptr), lineReceivedUs(0)
+  , traceRecorder(nullptr), bulkOutId(0), bulkOutActive(false)
+  , bulkOutAcks(0), bulkOutProgressMs(0)
+  , powerGovernor(nullptr), thermalModel(nullptr), bootProfiler(nullptr)
+  , presetStore(nullptr) {
+  response[0] = '\0';
+  bulkReassembler.setSender(&bulkOut);
+}
 
-void BluetoothHandler::setConnected(bool connected) {
-  deviceConnected = connected;
+bool BluetoothHandler::begin(const char* deviceName) {
+  if (!transport->begin(deviceName)) {
+    return false;
+  }
+  transport->setBulkReceiver(&bulkReassembler);
+  return true;
 }
 
-void BluetoothHandler::setCharacteristic(BLECharacteristic* characteristic) {
-  pCharacteristic = characteristic;
+void BluetoothHandler::registerBulkSink(uint8_t target, BulkSink* sink) {
+  bulkReassembler.registerSink(target, sink);
 }
 
-bool BluetoothHandler::begin(const char* deviceName) {
-  BLEDevice::init(deviceName);
-  
-  // Set MTU to larger size for longer messages
-  BLEDevice::setMTU(512);
-  
-  pServer = BLEDevice::createServer();
-  
-  BLEService *pService = pServer->createService(SERVICE_UUID);
-  pCharacteristic = pService->createCharacteristic(
-    CHARACTERISTIC_UUID,
-    BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_WRITE |
-    BLECharacteristic::PROPERTY_NOTIFY
-  );
-  
-  pCharacteristic->addDescriptor(new BLE2902());
-  pService->start();
-  
-  BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
-  pAdvertising->addServiceUUID(SERVICE_UUID);
-  pAdvertising->setScanResponse(true);
-  pAdvertising->setMinPreferred(0x06);
-  pAdvertising->setMinPreferred(0x12);
-  BLEDevice::startAdvertising();
-  
-  return true;
+void BluetoothHandler::setOtaUpdater(OtaUpdater* updater) {
+  otaUpdater = updater;
+  bulkReassembler.registerSink(BULK_TARGET_OTA, updater);
 }
 
 void BluetoothHandler::handleCommands() {
-  if (!deviceConnected || !pCharacteristic) return;
+  transport->poll(millis());
   
-  std::string value = pCharacteristic->getValue();
-  if (value.length() == 0) return;
+  uint8_t chunk[64];
+  size_t received;
+  while ((received = transport->read(chunk, sizeof(chunk))) > 0) {
+    for (size_t i = 0; i < received; i++) {
+      // Claim the newline's arrival time; fall back to now for untimed transports
+      if (chunk[i] == '\n' && !transport->takeCommandTimestamp(&lineReceivedUs)) {
+        lineReceivedUs = micros();
+      }
+      
+      // Process complete commands (ending with newline)
+      if (parser.feed((char)chunk[i])) {
+        processCommand(parser.line(), parser.lineLength());
+      }
+    }
+  }
   
-  commandBuffer += String(value.c_str());
+  pumpBulkOut();
+}
+
+void BluetoothHandler::pumpBulkOut() {
+  if (!bulkOutActive) return;
   
-  // Process complete commands (ending with newline)
-  int newlineIndex = commandBuffer.indexOf('\n');
-  while (newlineIndex != -1) {
-    String command = commandBuffer.substring(0, newlineIndex);
-    command.trim();
-    commandBuffer = commandBuffer.substring(newlineIndex + 1);
-    
-    if (command.length() > 0) {
-      processCommand(command);
+  // Paced against the app's ACKs; BULK_ERR_OFFSET rewinds to what it holds
+  for (int i = 0; i < BULK_TX_FRAMES_PER_POLL; i++) {
+    size_t length = bulkOut.nextPacedFrame(bulkFrame);
+    if (length == 0) break;
+    if (!transport->sendBulk(bulkFrame, length)) {
+      finishBulkOut();  // No bulk channel any more
+      return;
     }
-    
-    newlineIndex = commandBuffer.indexOf('\n');
   }
   
-  // Clear the characteristic value after reading
-  pCharacteristic->setValue("");
+  unsigned long now = millis();
+  if (bulkOut.getAcksReceived() != bulkOutAcks) {
+    bulkOutAcks = bulkOut.getAcksReceived();
+    bulkOutProgressMs = now;
+  }
+  
+  if (bulkOut.isAcknowledged() || bulkOut.getFailure() != BULK_OK || !transport->isConnected() ||
+      now - bulkOutProgressMs > BULK_TX_TIMEOUT_MS) {
+    finishBulkOut();
+  }
 }
 
-void BluetoothHandler::processCommand(const String& command) {
-  char cmdType = command.charAt(0);
+void BluetoothHandler::finishBulkOut() {
+  bulkOutActive = false;
+  if (traceRecorder) traceRecorder->setPaused(false);
+}
+
+void BluetoothHandler::processCommand(const char* command, size_t length) {
+  char cmdType = command[0];
   
   switch (cmdType) {
     case CMD_MODE:
-      processModeCommand(command);
+      processModeCommand(command, length);
       break;
       
     case CMD_TIMER:
-      processTimerCommand(command);
+      processTimerCommand(command, length);
       break;
       
     case CMD_STATUS:
-      processStatusCommand(command);
+      sendStatus();
+      break;
+      
+    case CMD_DIAGNOSTICS:
+      sendDiagnostics();
+      break;
+      
+    case CMD_BENCHMARK:
+      processBenchmarkCommand(command, length);
+      break;
+      
+    case CMD_OTA:
+      processOtaCommand(command, length);
+      break;
+      
+    case CMD_LATENCY:
+      processLatencyCommand(command, length);
+      break;
+      
+    case CMD_THERMAL:
+      processThermalCommand(command, length);
+      break;
+      
+    case CMD_TRACE:
+      processTraceCommand(command, length);
+      break;
+      
+    case CMD_PRESET_RECALL:
+    case CMD_PRESET_STORE:
+      processPresetCommand(command, length);
+      break;
+      
+    case CMD_BATCH:
+      processBatchCommand(command, length);
       break;
       
     default:
@@ -88,18 +137,18 @@ void BluetoothHandler::processCommand(const String& command) {
   }
 }
 
-void BluetoothHandler::processModeCommand(const String& command) {
-  // Format: Mxy where x=mode (0-5), y=intensity (0-100)
-  if (command.length() < 3) {
+void BluetoothHandler::processModeCommand(const char* command, size_t length) {
+  // Format: Mxy where x=mode (0-8), y=intensity (0-100)
+  long intensity;
+  if (length < 3 || !CommandParser::parseInteger(command + 2, &intensity)) {
     sendResponse("ERROR: Invalid mode command format");
     return;
   }
   
-  int mode = command.substring(1, 2).toInt();
-  int intensity = command.substring(2).toInt();
+  int mode = command[1] - '0';
   
   // Validate mode and intensity
-  if (mode < 0 || mode > 5) {
+  if (mode < 0 || mode > MODE_SPOT) {
     sendResponse("ERROR: Invalid mode value");
     return;
   }
@@ -107,65 +156,456 @@ void BluetoothHandler::processModeCommand(const String& command) {
   if (intensity < 0) intensity = 0;
   if (intensity > 100) intensity = 100;
   
-  sessionManager->setMode(static_cast<MassageMode>(mode));
-  sessionManager->setIntensity(intensity);
-  
-  Serial.print("Set Mode: ");
-  Serial.print(mode);
-  Serial.print(" Intensity: ");
-  Serial.println(intensity);
+  CommandTrace trace;
+  trace.receivedUs = lineReceivedUs;
+  trace.parsedUs = micros();
+  trace.appliedUs = 0;
   
-  sendResponse("OK: Mode=" + String(mode) + " Intensity=" + String(intensity));
+  // Applied and acknowledged once at the next engine tick (see sendModeAck)
+  sessionManager->requestUpdate(static_cast<MassageMode>(mode), (int)intensity, trace);
 }
 
-void BluetoothHandler::processTimerCommand(const String& command) {
+void BluetoothHandler::processTimerCommand(const char* command, size_t length) {
   // Format: Tx where x=duration in seconds
-  if (command.length() < 2) {
+  long duration;
+  if (length < 2 || !CommandParser::parseInteger(command + 1, &duration)) {
     sendResponse("ERROR: Invalid timer command format");
     return;
   }
   
-  int duration = command.substring(1).toInt();
-  
   if (duration <= 0) {
     sendResponse("ERROR: Invalid timer duration");
     return;
   }
   
-  sessionManager->startTimer(duration);
-  sendResponse("OK: Timer set for " + String(duration) + " seconds");
+  sessionManager->startTimer((int)duration);
+  snprintf(response, sizeof(response), "OK: Timer set for %ld seconds", duration);
+  sendResponse(response);
+}
+
+void BluetoothHandler::processPresetCommand(const char* command, size_t length) {
+  // Format: Pn (recall) or Wn (store the current session), n = slot
+  long slot;
+  if (length < 2 || !CommandParser::parseInteger(command + 1, &slot)) {
+    sendResponse("ERROR: Invalid preset command format");
+    return;
+  }
+  if (!presetStore) {
+    sendResponse("ERROR: Presets unavailable");
+    return;
+  }
+  if (slot < 0 || slot >= PRESET_SLOTS) {
+    sendResponse("ERROR: Invalid preset slot");
+    return;
+  }
+  
+  SessionPreset preset;
+  if (command[0] == CMD_PRESET_STORE) {
+    preset.mode = (uint8_t)sessionManager->getMode();
+    preset.intensity = (uint8_t)sessionManager->getIntensity();
+    preset.timerSeconds = sessionManager->getTimerDuration();
+    if (!presetStore->save((int)slot, preset)) {
+      sendResponse("ERROR: Preset not saved");
+      return;
+    }
+    snprintf(response, sizeof(response), "OK: Preset %ld stored", slot);
+    sendResponse(response);
+    return;
+  }
+  
+  if (!presetStore->get((int)slot, &preset)) {
+    sendResponse("ERROR: Preset slot empty");
+    return;
+  }
+  
+  CommandTrace trace;
+  trace.receivedUs = lineReceivedUs;
+  trace.parsedUs = micros();
+  trace.appliedUs = 0;
+  
+  // Mode, intensity and timer land in one tick and are acknowledged once
+  sessionManager->requestPreset((int)slot, preset, trace);
+}
+
+void BluetoothHandler::processBatchCommand(const char* command, size_t length) {
+  // Format: X<op>;<op>;... applied together at the next engine tick
+  SessionUpdate update = {};
+  update.presetSlot = -1;
+  
+  // Validate everything before queueing anything
+  const char* end = command + length;
+  const char* op = command + 1;
+  int operations = 0;
+  while (op < end) {
+    const char* opEnd = op;
+    while (opEnd < end && *opEnd != BATCH_SEPARATOR) opEnd++;
+    
+    if (++operations > BATCH_MAX_OPERATIONS) {
+      sendResponse("ERROR: Too many batch operations");
+      return;
+    }
+    if (!parseBatchOperation(op, opEnd - op, &update)) {
+      snprintf(response, sizeof(response), "ERROR: Invalid batch operation %d", operations);
+      sendResponse(response);
+      return;
+    }
+    op = opEnd + 1;
+  }
+  if (operations == 0) {
+    sendResponse("ERROR: Empty batch");
+    return;
+  }
+  update.operations = operations;
+  
+  CommandTrace trace;
+  trace.receivedUs = lineReceivedUs;
+  trace.parsedUs = micros();
+  trace.appliedUs = 0;
+  
+  // One commit applies every field and sendModeAck acknowledges it once
+  sessionManager->requestTransaction(update, trace);
+}
+
+bool BluetoothHandler::parseBatchOperation(const char* op, size_t length, SessionUpdate* update) {
+  if (length < 2) return false;
+  for (size_t i = 1; i < length; i++) {
+    if (op[i] < '0' || op[i] > '9') return false;
+  }
+  
+  long value;
+  switch (op[0]) {
+    case CMD_MODE: {
+      // Mxy, as the M command but out-of-range intensity is rejected
+      int mode = op[1] - '0';
+      if (length < 3 || mode > MODE_SPOT) return false;
+      CommandParser::parseInteger(op + 2, &value);
+      if (value > 100) return false;
+      update->setMode = true;
+      update->mode = static_cast<MassageMode>(mode);
+      update->setIntensity = true;
+      update->intensity = (int)value;
+      return true;
+    }
+    
+    case CMD_BATCH_INTENSITY:
+      CommandParser::parseInteger(op + 1, &value);
+      if (value > 100) return false;
+      update->setIntensity = true;
+      update->intensity = (int)value;
+      return true;
+    
+    case CMD_TIMER:
+      // T0 clears the timer
+      CommandParser::parseInteger(op + 1, &value);
+      if (value > BATCH_MAX_TIMER_S) return false;
+      update->setTimer = true;
+      update->timerSeconds = (unsigned long)value;
+      return true;
+    
+    case CMD_PRESET_RECALL: {
+      SessionPreset preset;
+      CommandParser::parseInteger(op + 1, &value);
+      if (!presetStore || !presetStore->get((int)value, &preset)) return false;
+      update->setMode = true;
+      update->mode = static_cast<MassageMode>(preset.mode);
+      update->setIntensity = true;
+      update->intensity = preset.intensity;
+      update->setTimer = true;
+      update->timerSeconds = preset.timerSeconds;
+      update->presetSlot = (int)value;
+      return true;
+    }
+    
+    default:
+      return false;
+  }
+}
+
+void BluetoothHandler::processBenchmarkCommand(const char* command, size_t length) {
+  // Format: Bx where x=suite; results go to Serial
+  long suite = 0;
+  if (length > 1) CommandParser::parseInteger(command + 1, &suite);
+  
+  switch (suite) {
+    case BENCH_SUITE_PATTERNS:
+      if (!runPatternRegression()) {
+        sendResponse("ERROR: Pattern regression failed");
+        return;
+      }
+      break;
+      
+#ifdef ENABLE_BENCHMARKS
+    case BENCH_SUITE_BULK:
+      runBulkLoopbackBenchmark();
+      break;
+      
+    case BENCH_SUITE_PARSER:
+      runCommandParserBenchmark();
+      break;
+      
+    case BENCH_SUITE_KERNELS:
+      runPatternKernelBenchmark();
+      break;
+      
+    case BENCH_SUITE_PCA9685:
+      runPca9685Benchmark();
+      break;
+      
+    case BENCH_SUITE_SHIFT_REGISTER:
+      runShiftRegisterBenchmark();
+      break;
+      
+    case BENCH_SUITE_PWM_PHASE:
+      runPwmPhaseBenchmark();
+      break;
+#else
+    case BENCH_SUITE_BULK:
+    case BENCH_SUITE_PARSER:
+    case BENCH_SUITE_KERNELS:
+    case BENCH_SUITE_PCA9685:
+    case BENCH_SUITE_SHIFT_REGISTER:
+    case BENCH_SUITE_PWM_PHASE:
+      sendResponse("ERROR: Benchmarks not built");
+      return;
+#endif
+      
+    default:
+      sendResponse("ERROR: Unknown benchmark suite");
+      return;
+  }
+  
+  snprintf(response, sizeof(response), "OK: Benchmark %ld complete", suite);
+  sendResponse(response);
+}
+
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void BluetoothHandler::processOtaCommand(const char* command, size_t length) {
+  // Format: U<64 hex chars> - SHA-256 of the image about to be sent to BULK_TARGET_OTA
+  if (!otaUpdater) {
+    sendResponse("ERROR: OTA not available");
+    return;
+  }
+  if (length != 1 + SHA256_DIGEST_SIZE * 2) {
+    sendResponse("ERROR: Invalid OTA command format");
+    return;
+  }
+  
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+    int hi = hexNibble(command[1 + i * 2]);
+    int lo = hexNibble(command[2 + i * 2]);
+    if (hi < 0 || lo < 0) {
+      sendResponse("ERROR: Invalid OTA hash");
+      return;
+    }
+    digest[i] = (hi << 4) | lo;
+  }
+  
+  otaUpdater->setExpectedHash(digest);
+  sendResponse("OK: OTA armed");
+}
+
+void BluetoothHandler::processLatencyCommand(const char* command, size_t length) {
+  // Format: L reports, L0 clears
+  if (!latencyTracker) {
+    sendResponse("ERROR: Latency tracking not available");
+    return;
+  }
+  
+  if (length > 1 && command[1] == '0') {
+    latencyTracker->reset();
+    sendResponse("OK: Latency reset");
+    return;
+  }
+  
+  // Format: L:n=..,p50=..,... (microseconds)
+  response[0] = 'L';
+  response[1] = ':';
+  latencyTracker->format(response + 2, sizeof(response) - 2);
+  sendResponse(response);
+}
+
+void BluetoothHandler::processThermalCommand(const char* command, size_t length) {
+  // Format: H reports from channel 0, Hn from channel n
+  if (!thermalModel) {
+    sendResponse("ERROR: Thermal model not available");
+    return;
+  }
+  
+  long first = 0;
+  if (length > 1 && !CommandParser::parseInteger(command + 1, &first)) {
+    sendResponse("ERROR: Invalid thermal command format");
+    return;
+  }
+  int channels = thermalModel->getChannels();
+  if (first < 0 || first >= channels) {
+    sendResponse("ERROR: Invalid thermal channel");
+    return;
+  }
+  
+  // Format: H:first=n,channels=n,levels=l l l ... (as many as fit; ask again from first + count)
+  size_t written = snprintf(response, sizeof(response), "H:first=%ld,channels=%d,levels=", first, channels);
+  for (int i = (int)first; i < channels; i++) {
+    int width = snprintf(response + written, sizeof(response) - written, i == first ? "%d" : " %d",
+                         thermalModel->getLevel(i));
+    if (written + width >= sizeof(response)) {
+      response[written] = '\0';  // Only whole levels
+      break;
+    }
+    written += width;
+  }
+  sendResponse(response);
 }
 
-void BluetoothHandler::processStatusCommand(const String& command) {
-  sendStatus();
+void BluetoothHandler::processTraceCommand(const char* command, size_t length) {
+  // Format: R downloads the trace to BULK_TARGET_TRACE, R0 clears it
+  if (!traceRecorder) {
+    sendResponse("ERROR: Trace not available");
+    return;
+  }
+  
+  if (bulkOutActive) {
+    sendResponse("ERROR: Transfer in progress");
+    return;
+  }
+  
+  if (length > 1 && command[1] == '0') {
+    traceRecorder->clear();
+    sendResponse("OK: Trace cleared");
+    return;
+  }
+  
+  uint16_t mtu = transport->getMtu();
+  if (bulkPayloadForMtu(mtu) == 0) {
+    sendResponse("ERROR: No bulk channel");
+    return;
+  }
+  
+  // Freeze the image while it streams out; commits resume afterwards
+  traceRecorder->flush(millis());
+  traceRecorder->setPaused(true);
+  bulkOut.start(++bulkOutId, BULK_TARGET_TRACE, traceRecorder->data(), traceRecorder->size(), mtu);
+  bulkOutActive = true;
+  bulkOutAcks = 0;
+  bulkOutProgressMs = millis();
+  
+  snprintf(response, sizeof(response), "OK: Trace %lu bytes", (unsigned long)traceRecorder->size());
+  sendResponse(response);
 }
 
-void BluetoothHandler::sendResponse(const String& message) {
-  if (deviceConnected && pCharacteristic) {
-    pCharacteristic->setValue(message.c_str());
-    pCharacteristic->notify();
-    delay(20);  // Small delay to ensure message is sent completely
+void BluetoothHandler::sendResponse(const char* message) {
+  if (transport->isConnected()) {
+    transport->sendMessage(message);
   }
 }
 
 void BluetoothHandler::sendStatus() {
   int batteryPercent = sessionManager->getBatteryPercentage();
   
-  // Send as CSV format: S:mode,intensity,time,battery
-  String status = "S:";
-  status += String(sessionManager->getMode()) + ",";
-  status += String(sessionManager->getIntensity()) + ",";
-  status += String(sessionManager->getTimeRemaining()) + ",";
-  status += String(batteryPercent);
+  // Send as CSV format: S:mode,intensity,time,battery,runtime_minutes
+  int length = snprintf(response, sizeof(response), "S:%d,%d,%lu,%d,%d",
+                        (int)sessionManager->getMode(),
+                        sessionManager->getIntensity(),
+                        sessionManager->getTimeRemaining(),
+                        batteryPercent,
+                        sessionManager->getRuntimeMinutes());
   
   Serial.print("Sending status: ");
-  Serial.println(status);
+  Serial.println(response);
   Serial.print("Message length: ");
-  Serial.println(status.length());
+  Serial.println(length);
+  
+  sendResponse(response);
+}
+
+void BluetoothHandler::sendModeAck() {
+  int mode = sessionManager->getMode();
+  int intensity = sessionManager->getIntensity();
+  
+  Serial.print("Set Mode: ");
+  Serial.print(mode);
+  Serial.print(" Intensity: ");
+  Serial.println(intensity);
+  
+  // Every kind of request merged into the commit gets its own ack, all
+  // reporting the state that was applied
+  for (int i = 0; i < sessionManager->getAppliedAckCount(); i++) {
+    switch (sessionManager->getAppliedAck(i)) {
+      case SESSION_ACK_BATCH:
+        snprintf(response, sizeof(response), "OK: Batch=%d Mode=%d Intensity=%d Timer=%lu",
+                 sessionManager->getAppliedOperations(), mode, intensity, sessionManager->getTimeRemaining());
+        break;
+        
+      case SESSION_ACK_PRESET:
+        snprintf(response, sizeof(response), "OK: Preset=%d Mode=%d Intensity=%d Timer=%lu",
+                 sessionManager->getAppliedPreset(), mode, intensity, sessionManager->getTimeRemaining());
+        break;
+        
+      default:
+        snprintf(response, sizeof(response), "OK: Mode=%d Intensity=%d", mode, intensity);
+        break;
+    }
+    sendResponse(response);
+  }
+}
+
+void BluetoothHandler::sendDiagnostics() {
+  // Format: D:key=value,key=value,...
+  size_t length = snprintf(response, sizeof(response),
+                           "D:applied=%lu,coalesced=%lu,cmd_overflow=%lu,bulk_ok=%lu,bulk_failed=%lu",
+                           sessionManager->getAppliedUpdates(),
+                           sessionManager->getCoalescedUpdates(),
+                           parser.getOverflowCount(),
+                           bulkReassembler.getCompletedTransfers(),
+                           bulkReassembler.getFailedTransfers());
   
-  sendResponse(status);
+  if (otaUpdater && length < sizeof(response)) {
+    length += snprintf(response + length, sizeof(response) - length, ",ota_state=%d,ota_kbps=%lu",
+                       (int)otaUpdater->getState(), otaUpdater->getThroughput());
+  }
+  if (powerGovernor && length < sizeof(response)) {
+    length += snprintf(response + length, sizeof(response) - length,
+                       ",power_budget=%d,power_scale=%d,power_limited=%lu",
+                       powerGovernor->getBudgetPercent(), powerGovernor->getScalePercent(),
+                       powerGovernor->getLimitedFrames());
+  }
+  if (thermalModel && length < sizeof(response)) {
+    int hottest = thermalModel->getHottest();
+    length += snprintf(response + length, sizeof(response) - length,
+                       ",thermal_hot=%d,thermal_level=%d,thermal_limited=%d",
+                       hottest, thermalModel->getLevel(hottest), thermalModel->getLimitedChannels());
+  }
+  if (bootProfiler && length < sizeof(response)) {
+    length += snprintf(response + length, sizeof(response) - length, ",boot_output_us=%lu,boot_adv_us=%lu",
+                       (unsigned long)bootProfiler->getFirstOutputUs(),
+                       (unsigned long)bootProfiler->getAdvertisingUs());
+  }
+  if (length + 1 < sizeof(response)) {
+    response[length++] = ',';
+    if (transport->formatDiagnostics(response + length, sizeof(response) - length) == 0) {
+      response[length - 1] = '\0';  // Transport has nothing to add
+    }
+  }
+  
+  sendResponse(response);
 }
 
 void BluetoothHandler::notifyTimerComplete() {
   sendResponse("TIMER_COMPLETE");
 }
+
+void BluetoothHandler::notifyOtaComplete() {
+  Serial.printf("OTA image verified: %lu bytes in %lu ms (%lu KB/s, flash %lu us, %lu writes refused)\n",
+                (unsigned long)otaUpdater->getImageSize(), otaUpdater->getDurationMs(),
+                otaUpdater->getThroughput(), otaUpdater->getFlashMicros(), otaUpdater->getRefusedWrites());
+  
+  snprintf(response, sizeof(response), "OTA_COMPLETE: %lu bytes %lu KB/s",
+           (unsigned long)otaUpdater->getImageSize(), otaUpdater->getThroughput());
+  sendResponse(response);
+}
@@ -1,85 +1,250 @@
 #ifndef BLUETOOTH_HANDLER_H
 #define BLUETOOTH_HANDLER_H
 
-#include <BLEDevice.h>
-#include <BLEServer.h>
-#include <BLEUtils.h>
-#include <BLE2902.h>
+#include <Arduino.h>
 #include "config.h"
 #include "SessionManager.h"
+#include "Transport.h"
+#include "CommandParser.h"
+#include "BulkTransfer.h"
+#include "OtaUpdater.h"
+#include "LatencyTracker.h"
+#include "PwmTraceRecorder.h"
+#include "PowerGovernor.h"
+#include "ThermalModel.h"
+#include "BootProfiler.h"
+
+#define RESPONSE_MAX_LENGTH 320
+#define BULK_TX_FRAMES_PER_POLL 2   // Outgoing bulk frames per handleCommands()
+#define BULK_TX_TIMEOUT_MS 5000     // Abandon an outgoing transfer the app stopped acknowledging
 
 /**
  * @class BluetoothHandler
- * @brief Handles Bluetooth communication and command parsing
+ * @brief Transport-independent command protocol core
  * 
- * Manages BLE connection and processes incoming commands
+ * Parses commands from any Transport (BLE, SPP, host socket) with the
+ * shared CommandParser and formats responses in a fixed buffer, so the
+ * command path does no heap allocation.
  */
 class BluetoothHandler {
 private:
-  BLEServer* pServer;
-  BLECharacteristic* pCharacteristic;
+  Transport* transport;
   SessionManager* sessionManager;
-  bool deviceConnected;
-  String commandBuffer;
+  CommandParser parser;
+  char response[RESPONSE_MAX_LENGTH];
+  
+  // Fragmented transfers on the transport's bulk channel
+  BulkReassembler bulkReassembler;
+  OtaUpdater* otaUpdater;
+  
+  // Command-to-actuation latency
+  LatencyTracker* latencyTracker;
+  uint32_t lineReceivedUs;
+  
+  // Device -> app transfers on the bulk channel (trace download)
+  PwmTraceRecorder* traceRecorder;
+  BulkSegmenter bulkOut;
+  uint8_t bulkOutId;
+  bool bulkOutActive;
+  uint32_t bulkOutAcks;               // ACKs seen at bulkOutProgressMs
+  unsigned long bulkOutProgressMs;
+  uint8_t bulkFrame[BLE_MAX_MTU];
+  
+  // Motor load limits, reported in diagnostics
+  PowerGovernor* powerGovernor;
+  ThermalModel* thermalModel;
+  
+  // Start-up milestones, reported in diagnostics
+  const BootProfiler* bootProfiler;
+  
+  // Saved session configurations (P/W commands)
+  PresetStore* presetStore;
   
   /**
    * @brief Process mode command (Mxy format)
-   * @param command Command string
+   * @param command Command line
+   * @param length Command length
    */
-  void processModeCommand(const String& command);
+  void processModeCommand(const char* command, size_t length);
   
   /**
    * @brief Process timer command (Tx format)
-   * @param command Command string
+   * @param command Command line
+   * @param length Command length
+   */
+  void processTimerCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Process benchmark command (Bx format)
+   * @param command Command line
+   * @param length Command length
    */
-  void processTimerCommand(const String& command);
+  void processBenchmarkCommand(const char* command, size_t length);
   
   /**
-   * @brief Process status request command (S format)
-   * @param command Command string
+   * @brief Process OTA arm command (U<sha256 hex> format)
+   * @param command Command line
+   * @param length Command length
    */
-  void processStatusCommand(const String& command);
+  void processOtaCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Process latency report command (L, or L0 to reset)
+   * @param command Command line
+   * @param length Command length
+   */
+  void processLatencyCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Process thermal report command (H, or Hn from channel n)
+   * @param command Command line
+   * @param length Command length
+   */
+  void processThermalCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Process trace download command (R, or R0 to clear)
+   * @param command Command line
+   * @param length Command length
+   */
+  void processTraceCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Process preset recall (Pn) or store (Wn) command
+   * @param command Command line
+   * @param length Command length
+   */
+  void processPresetCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Process a batch command (X<op>;<op>;...)
+   * @param command Command line
+   * @param length Command length
+   */
+  void processBatchCommand(const char* command, size_t length);
+  
+  /**
+   * @brief Validate one batch operation and add it to the update
+   * @param op Operation text (Mxy, In, Tn or Pn)
+   * @param length Operation length
+   * @param update Update the operation is merged into
+   * @return false if the operation is malformed or out of range
+   */
+  bool parseBatchOperation(const char* op, size_t length, SessionUpdate* update);
+  
+  /**
+   * @brief Send the next frames of an outgoing bulk transfer
+   */
+  void pumpBulkOut();
+  
+  /**
+   * @brief End the outgoing transfer and resume trace recording
+   */
+  void finishBulkOut();
   
   /**
    * @brief Process a complete command
-   * @param command Command string
+   * @param command Command line
+   * @param length Command length
    */
-  void processCommand(const String& command);
+  void processCommand(const char* command, size_t length);
   
   /**
-   * @brief Send response message via Bluetooth
+   * @brief Send response message via the transport
    * @param message Message to send
    */
-  void sendResponse(const String& message);
+  void sendResponse(const char* message);
 
 public:
-  BluetoothHandler(SessionManager* manager);
-  
-  void setConnected(bool connected);
-  void setCharacteristic(BLECharacteristic* characteristic);
-  BLEServer* getServer() { return pServer; }
+  BluetoothHandler(Transport* link, SessionManager* manager);
   
   /**
-   * @brief Initialize Bluetooth with device name
-   * @param deviceName BLE device name
+   * @brief Initialize the transport with device name
+   * @param deviceName Advertised device name
    * @return true if initialization successful
    */
   bool begin(const char* deviceName);
   
   /**
-   * @brief Process incoming Bluetooth commands
+   * @brief Process incoming commands
    */
   void handleCommands();
   
+  /**
+   * @brief Register the destination for a bulk transfer target
+   * @param target Target id (BulkTarget)
+   * @param sink Destination receiving the reassembled payload
+   */
+  void registerBulkSink(uint8_t target, BulkSink* sink);
+  
+  /**
+   * @brief Route BULK_TARGET_OTA transfers to a firmware updater
+   * @param updater OTA updater
+   */
+  void setOtaUpdater(OtaUpdater* updater);
+  
+  /**
+   * @brief Report command latency from a tracker fed by the main loop
+   * @param tracker Latency tracker
+   */
+  void setLatencyTracker(LatencyTracker* tracker) { latencyTracker = tracker; }
+  
+  /**
+   * @brief Serve trace downloads from a recorder fed by the MotorController
+   * @param recorder PWM trace recorder
+   */
+  void setTraceRecorder(PwmTraceRecorder* recorder) { traceRecorder = recorder; }
+  
+  /**
+   * @brief Report the power governor's state in diagnostics
+   * @param governor Governor, or nullptr
+   */
+  void setPowerGovernor(PowerGovernor* governor) { powerGovernor = governor; }
+  
+  /**
+   * @brief Report the per-motor thermal model in diagnostics and H
+   * @param model Thermal model, or nullptr
+   */
+  void setThermalModel(ThermalModel* model) { thermalModel = model; }
+  
+  /**
+   * @brief Report time to first motor output and to advertising in diagnostics
+   * @param profiler Boot profiler, or nullptr
+   */
+  void setBootProfiler(const BootProfiler* profiler) { bootProfiler = profiler; }
+  
+  /**
+   * @brief Enable the preset store/recall commands
+   * @param presets Preset store with its cache loaded, or nullptr
+   */
+  void setPresetStore(PresetStore* presets) { presetStore = presets; }
+  
+  Transport* getTransport() { return transport; }
+  
   /**
    * @brief Send status update
    */
   void sendStatus();
   
+  /**
+   * @brief Acknowledge a mode/intensity update applied this tick
+   */
+  void sendModeAck();
+  
+  /**
+   * @brief Send diagnostics counters
+   */
+  void sendDiagnostics();
+  
   /**
    * @brief Notify timer completion
    */
   void notifyTimerComplete();
+  
+  /**
+   * @brief Notify that a verified firmware image is ready to boot
+   */
+  void notifyOtaComplete();
 };
 
 #endif
@@ -0,0 +1,33 @@
+#include "BootProfiler.h"
+#include <stdio.h>
+
+BootProfiler::BootProfiler() : count(0), firstOutputUs(0), advertisingUs(0) {}
+
+void BootProfiler::mark(const char* name, uint32_t nowUs) {
+  if (count >= BOOT_MAX_PHASES) return;
+  names[count] = name;
+  endUs[count] = nowUs;
+  count++;
+}
+
+void BootProfiler::markFirstOutput(uint32_t nowUs) {
+  if (firstOutputUs == 0) firstOutputUs = nowUs ? nowUs : 1;
+}
+
+void BootProfiler::markAdvertising(uint32_t nowUs) {
+  if (advertisingUs == 0) advertisingUs = nowUs ? nowUs : 1;
+}
+
+size_t BootProfiler::format(char* out, size_t capacity) const {
+  if (capacity == 0) return 0;
+  size_t length = 0;
+  out[0] = '\0';
+  for (int i = 0; i < count && length < capacity; i++) {
+    length += snprintf(out + length, capacity - length, "%s=%lu,", names[i], (unsigned long)endUs[i]);
+  }
+  if (length < capacity) {
+    length += snprintf(out + length, capacity - length, "first_output=%lu,advertising=%lu",
+                       (unsigned long)firstOutputUs, (unsigned long)advertisingUs);
+  }
+  return length < capacity ? length : capacity - 1;
+}
@@ -0,0 +1,58 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BOOT_MAX_PHASES 12
+
+/**
+ * @class BootProfiler
+ * @brief Timestamps of the start-up phases and of the two milestones
+ *
+ * Times are micros() since the application started (the ROM and
+ * second-stage bootloader run before that and are not included). Phases
+ * are marked from setup() only; the Bluetooth task on the other core only
+ * sets the advertising milestone, a single aligned 32-bit store.
+ */
+class BootProfiler {
+private:
+  const char* names[BOOT_MAX_PHASES];
+  uint32_t endUs[BOOT_MAX_PHASES];
+  int count;
+  uint32_t firstOutputUs;              // 0 = not reached yet
+  volatile uint32_t advertisingUs;     // Written by the Bluetooth task
+
+public:
+  BootProfiler();
+
+  /**
+   * @brief Record the end of a start-up phase
+   * @param name Phase name (string literal, kept by pointer)
+   * @param nowUs micros()
+   */
+  void mark(const char* name, uint32_t nowUs);
+
+  /**
+   * @brief The first frame reached the motors (later calls are ignored)
+   */
+  void markFirstOutput(uint32_t nowUs);
+
+  /**
+   * @brief The device became discoverable (later calls are ignored)
+   */
+  void markAdvertising(uint32_t nowUs);
+
+  uint32_t getFirstOutputUs() const { return firstOutputUs; }
+  uint32_t getAdvertisingUs() const { return advertisingUs; }
+
+  /**
+   * @brief One line with every phase and milestone
+   *
+   * Format: name=us,name=us,...,first_output=us,advertising=us
+   * @return Characters written (excluding the terminator)
+   */
+  size_t format(char* out, size_t capacity) const;
+};
+
+#endif
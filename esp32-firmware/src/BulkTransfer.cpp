@@ -0,0 +1,324 @@
+#include "BulkTransfer.h"
+#include <string.h>
+
+static uint32_t readU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void writeU32(uint8_t* p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = (v >> 24) & 0xFF;
+}
+
+uint32_t bulkCrc32(uint32_t crc, const uint8_t* data, size_t length) {
+  // Nibble-wise table keeps the footprint at 64 bytes
+  static const uint32_t table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+size_t bulkPayloadForMtu(uint16_t mtu) {
+  if (mtu <= BULK_ATT_OVERHEAD + BULK_DATA_HEADER_SIZE) return 0;
+  return mtu - BULK_ATT_OVERHEAD - BULK_DATA_HEADER_SIZE;
+}
+
+// ---------------------------------------------------------------------------
+// BufferSink
+
+BufferSink::BufferSink(uint8_t* buf, size_t cap)
+  : buffer(buf), capacity(cap), length(0), valid(false) {}
+
+bool BufferSink::open(uint32_t totalLength) {
+  if (totalLength > capacity) return false;
+  length = totalLength;
+  valid = false;
+  return true;
+}
+
+bool BufferSink::write(uint32_t offset, const uint8_t* data, size_t count) {
+  if (offset + count > length) return false;
+  memcpy(buffer + offset, data, count);
+  return true;
+}
+
+bool BufferSink::commit() {
+  valid = true;
+  return true;
+}
+
+void BufferSink::abort() {
+  valid = false;
+}
+
+// ---------------------------------------------------------------------------
+// BulkReassembler
+
+BulkReassembler::BulkReassembler()
+  : activeSink(nullptr), sender(nullptr), activeId(0), totalLength(0), received(0)
+  , expectedCrc(0), runningCrc(0), lastAckAt(0)
+  , completedTransfers(0), failedTransfers(0) {
+  for (int i = 0; i < BULK_MAX_TARGETS; i++) sinks[i] = nullptr;
+}
+
+void BulkReassembler::registerSink(uint8_t target, BulkSink* sink) {
+  if (target < BULK_MAX_TARGETS) {
+    sinks[target] = sink;
+  }
+}
+
+size_t BulkReassembler::handleFrame(const uint8_t* frame, size_t length, uint8_t* reply) {
+  if (length < BULK_END_HEADER_SIZE) {
+    return writeAck(reply, 0, BULK_ERR_FORMAT);
+  }
+
+  switch (frame[0]) {
+    case BULK_FRAME_BEGIN:
+      return handleBegin(frame, length, reply);
+
+    case BULK_FRAME_DATA:
+      return handleData(frame, length, reply);
+
+    case BULK_FRAME_END:
+      return handleEnd(frame, reply);
+
+    case BULK_FRAME_ACK:
+      // Progress of one of our transfers; never answered
+      if (sender) sender->handleAck(frame, length);
+      return 0;
+
+    default:
+      return writeAck(reply, frame[1], BULK_ERR_FORMAT);
+  }
+}
+
+size_t BulkReassembler::handleBegin(const uint8_t* frame, size_t length, uint8_t* reply) {
+  uint8_t id = frame[1];
+  if (length < BULK_BEGIN_HEADER_SIZE) {
+    return writeAck(reply, id, BULK_ERR_FORMAT);
+  }
+
+  // A new BEGIN supersedes whatever was in flight
+  if (activeSink) {
+    activeSink->abort();
+    activeSink = nullptr;
+    failedTransfers++;
+  }
+
+  uint8_t target = frame[2];
+  BulkSink* sink = (target < BULK_MAX_TARGETS) ? sinks[target] : nullptr;
+  if (!sink) {
+    return fail(reply, id, BULK_ERR_NO_SINK);
+  }
+
+  uint32_t total = readU32(frame + 3);
+  if (!sink->open(total)) {
+    return fail(reply, id, BULK_ERR_TOO_LARGE);
+  }
+
+  activeSink = sink;
+  activeId = id;
+  totalLength = total;
+  expectedCrc = readU32(frame + 7);
+  runningCrc = 0;
+  received = 0;
+  lastAckAt = 0;
+  return writeAck(reply, id, BULK_OK);
+}
+
+size_t BulkReassembler::handleData(const uint8_t* frame, size_t length, uint8_t* reply) {
+  uint8_t id = frame[1];
+  if (!activeSink || id != activeId) {
+    return writeAck(reply, id, BULK_ERR_STATE);
+  }
+  if (length < BULK_DATA_HEADER_SIZE) {
+    return writeAck(reply, id, BULK_ERR_FORMAT);
+  }
+
+  uint32_t offset = readU32(frame + 2);
+  const uint8_t* payload = frame + BULK_DATA_HEADER_SIZE;
+  size_t payloadLength = length - BULK_DATA_HEADER_SIZE;
+
+  if (offset != received) {
+    // Lost or repeated fragment - tell the sender where to resume
+    return writeAck(reply, id, BULK_ERR_OFFSET);
+  }
+  if (received + payloadLength > totalLength) {
+    return fail(reply, id, BULK_ERR_TOO_LARGE);
+  }
+  if (!activeSink->canAccept(payloadLength)) {
+    // Destination is still busy; the sender resumes from 'received'
+    return writeAck(reply, id, BULK_ERR_OFFSET);
+  }
+  if (!activeSink->write(offset, payload, payloadLength)) {
+    return fail(reply, id, BULK_ERR_WRITE);
+  }
+
+  runningCrc = bulkCrc32(runningCrc, payload, payloadLength);
+  received += payloadLength;
+
+  // Periodic progress so the sender can pace unacknowledged writes. The
+  // last fragment is left to END's ack, so an OK for every byte always
+  // means the transfer committed.
+  if (received - lastAckAt >= BULK_ACK_WINDOW && received < totalLength) {
+    lastAckAt = received;
+    return writeAck(reply, id, BULK_OK);
+  }
+  return 0;
+}
+
+size_t BulkReassembler::handleEnd(const uint8_t* frame, uint8_t* reply) {
+  uint8_t id = frame[1];
+  if (!activeSink || id != activeId) {
+    return writeAck(reply, id, BULK_ERR_STATE);
+  }
+  if (received != totalLength) {
+    return writeAck(reply, id, BULK_ERR_OFFSET);
+  }
+  if (runningCrc != expectedCrc) {
+    return fail(reply, id, BULK_ERR_CRC);
+  }
+  if (!activeSink->isDrained()) {
+    return writeAck(reply, id, BULK_ERR_OFFSET);
+  }
+  if (!activeSink->commit()) {
+    activeSink = nullptr;
+    failedTransfers++;
+    return writeAck(reply, id, BULK_ERR_WRITE);
+  }
+
+  activeSink = nullptr;
+  completedTransfers++;
+  return writeAck(reply, id, BULK_OK);
+}
+
+size_t BulkReassembler::fail(uint8_t* reply, uint8_t id, BulkStatus status) {
+  if (activeSink) {
+    activeSink->abort();
+    activeSink = nullptr;
+  }
+  failedTransfers++;
+  return writeAck(reply, id, status);
+}
+
+size_t BulkReassembler::writeAck(uint8_t* reply, uint8_t id, BulkStatus status) {
+  reply[0] = BULK_FRAME_ACK;
+  reply[1] = id;
+  reply[2] = (uint8_t)status;
+  writeU32(reply + 3, received);
+  return BULK_ACK_SIZE;
+}
+
+// ---------------------------------------------------------------------------
+// BulkSegmenter
+
+BulkSegmenter::BulkSegmenter()
+  : source(nullptr), length(0), offset(0), crc(0)
+  , transferId(0), target(0), mtu(0), stage(3)
+  , ackedBytes(0), resumeOffset(0), resumeRequested(false), endSent(false)
+  , acknowledged(false), failure(BULK_OK), acksReceived(0) {}
+
+void BulkSegmenter::start(uint8_t id, uint8_t dest, const uint8_t* data, uint32_t dataLength, uint16_t negotiatedMtu) {
+  source = data;
+  length = dataLength;
+  offset = 0;
+  crc = bulkCrc32(0, data, dataLength);
+  transferId = id;
+  target = dest;
+  mtu = negotiatedMtu;
+  stage = bulkPayloadForMtu(mtu) > 0 ? 0 : 3;
+
+  ackedBytes = 0;
+  resumeRequested = false;
+  endSent = false;
+  acknowledged = false;
+  failure = BULK_OK;
+  acksReceived = 0;
+}
+
+size_t BulkSegmenter::nextFrame(uint8_t* out) {
+  switch (stage) {
+    case 0:
+      out[0] = BULK_FRAME_BEGIN;
+      out[1] = transferId;
+      out[2] = target;
+      writeU32(out + 3, length);
+      writeU32(out + 7, crc);
+      stage = (length > 0) ? 1 : 2;
+      return BULK_BEGIN_HEADER_SIZE;
+
+    case 1: {
+      size_t chunk = bulkPayloadForMtu(mtu);
+      if (chunk > length - offset) chunk = length - offset;
+
+      out[0] = BULK_FRAME_DATA;
+      out[1] = transferId;
+      writeU32(out + 2, offset);
+      memcpy(out + BULK_DATA_HEADER_SIZE, source + offset, chunk);
+      offset += chunk;
+      if (offset >= length) stage = 2;
+      return BULK_DATA_HEADER_SIZE + chunk;
+    }
+
+    case 2:
+      out[0] = BULK_FRAME_END;
+      out[1] = transferId;
+      stage = 3;
+      endSent = true;
+      return BULK_END_HEADER_SIZE;
+
+    default:
+      return 0;
+  }
+}
+
+void BulkSegmenter::rewind(uint32_t resumeOffset) {
+  if (resumeOffset > length) return;
+  offset = resumeOffset;
+  stage = (offset < length) ? 1 : 2;
+}
+
+void BulkSegmenter::handleAck(const uint8_t* frame, size_t frameLength) {
+  if (frameLength < BULK_ACK_SIZE || frame[1] != transferId) return;
+  acksReceived++;
+
+  uint32_t count = readU32(frame + 3);
+  switch (frame[2]) {
+    case BULK_OK:
+      if (count > ackedBytes) ackedBytes = count;
+      if (endSent && count == length) acknowledged = true;
+      break;
+
+    case BULK_ERR_OFFSET:
+      if (count > ackedBytes) ackedBytes = count;
+      resumeOffset = count;
+      resumeRequested.store(true, std::memory_order_release);
+      break;
+
+    default:
+      if (failure == BULK_OK) failure = frame[2];
+      break;
+  }
+}
+
+size_t BulkSegmenter::nextPacedFrame(uint8_t* out) {
+  if (resumeRequested.exchange(false, std::memory_order_acquire)) {
+    rewind(resumeOffset);
+  }
+  if (stage == 1 && offset + bulkPayloadForMtu(mtu) - ackedBytes > BULK_TX_WINDOW) {
+    return 0;  // Wait for the receiver to catch up
+  }
+  return nextFrame(out);
+}
@@ -0,0 +1,278 @@
+#ifndef BULK_TRANSFER_H
+#define BULK_TRANSFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Frame layout on the bulk characteristic (all integers little-endian)
+//   BEGIN: [0x01][id][target][totalLength:u32][crc32:u32]
+//   DATA:  [0x02][id][offset:u32][payload...]
+//   END:   [0x03][id]
+//   ACK:   [0x81][id][status][received:u32]   (receiver -> sender)
+#define BULK_FRAME_BEGIN 0x01
+#define BULK_FRAME_DATA 0x02
+#define BULK_FRAME_END 0x03
+#define BULK_FRAME_ACK 0x81
+
+#define BULK_BEGIN_HEADER_SIZE 11
+#define BULK_DATA_HEADER_SIZE 6
+#define BULK_END_HEADER_SIZE 2
+#define BULK_ACK_SIZE 7
+#define BULK_ATT_OVERHEAD 3       // ATT opcode + handle in every write/notify
+#define BULK_MAX_TARGETS 8
+#define BULK_ACK_WINDOW 4096      // Acknowledge progress every N bytes
+#define BULK_TX_WINDOW (2 * BULK_ACK_WINDOW)  // Unacknowledged bytes a sender keeps in flight
+
+// Destinations a transfer can be routed to
+enum BulkTarget {
+  BULK_TARGET_SCRATCH = 0,
+  BULK_TARGET_PATTERN = 1,
+  BULK_TARGET_PLAYLIST = 2,
+  BULK_TARGET_OTA = 3,
+  BULK_TARGET_TRACE = 4       // Device -> app: PWM trace download
+};
+
+enum BulkStatus {
+  BULK_OK = 0,
+  BULK_ERR_FORMAT = 1,      // Malformed or unknown frame
+  BULK_ERR_NO_SINK = 2,     // No destination registered for target
+  BULK_ERR_TOO_LARGE = 3,   // Destination cannot hold the transfer
+  BULK_ERR_STATE = 4,       // Frame does not belong to the active transfer
+  BULK_ERR_OFFSET = 5,      // Gap, duplicate or destination busy; resend from 'received'
+  BULK_ERR_WRITE = 6,       // Destination rejected the data
+  BULK_ERR_CRC = 7          // Integrity check failed
+};
+
+/**
+ * @brief Incremental CRC-32 (IEEE 802.3)
+ * @param crc Running value (0 to start)
+ * @param data Bytes to add
+ * @param length Number of bytes
+ * @return Updated CRC
+ */
+uint32_t bulkCrc32(uint32_t crc, const uint8_t* data, size_t length);
+
+/**
+ * @brief Payload bytes that fit in one DATA frame for a negotiated MTU
+ * @param mtu ATT MTU
+ * @return Payload size in bytes (0 if the MTU is too small)
+ */
+size_t bulkPayloadForMtu(uint16_t mtu);
+
+/**
+ * @class BulkSink
+ * @brief Destination for a reassembled transfer
+ *
+ * Fragments are written straight from the transport's receive buffer into
+ * the sink at their offset, so a sink backed by preallocated storage sees
+ * exactly one copy per byte.
+ */
+class BulkSink {
+public:
+  virtual ~BulkSink() {}
+
+  /**
+   * @brief Prepare for a transfer of the given size
+   * @return false if the destination cannot hold it
+   */
+  virtual bool open(uint32_t totalLength) = 0;
+
+  /**
+   * @brief Whether a fragment can be stored now without blocking
+   *
+   * A sink that drains on another task returns false while its queue is
+   * full. The fragment is then answered with BULK_ERR_OFFSET, and the
+   * sender resends from the acknowledged byte count.
+   */
+  virtual bool canAccept(size_t length) { return true; }
+
+  /**
+   * @brief Store a fragment at its offset
+   * @return false on a write failure
+   */
+  virtual bool write(uint32_t offset, const uint8_t* data, size_t length) = 0;
+
+  /**
+   * @brief Whether everything written has been processed
+   *
+   * END is answered with BULK_ERR_OFFSET until it has, so commit() never
+   * waits in the transport's receive path; the sender repeats END.
+   */
+  virtual bool isDrained() { return true; }
+
+  /**
+   * @brief Called once all bytes arrived and the CRC matched
+   * @return false if the destination could not finalise the data
+   */
+  virtual bool commit() { return true; }
+
+  /**
+   * @brief Called when a transfer is abandoned or fails verification
+   */
+  virtual void abort() {}
+};
+
+/**
+ * @class BufferSink
+ * @brief Bulk destination backed by a caller-owned RAM buffer
+ */
+class BufferSink : public BulkSink {
+private:
+  uint8_t* buffer;
+  size_t capacity;
+  size_t length;
+  bool valid;
+
+public:
+  BufferSink(uint8_t* buf, size_t cap);
+
+  bool open(uint32_t totalLength) override;
+  bool write(uint32_t offset, const uint8_t* data, size_t count) override;
+  bool commit() override;
+  void abort() override;
+
+  const uint8_t* data() const { return buffer; }
+  size_t size() const { return valid ? length : 0; }
+  bool isValid() const { return valid; }
+};
+
+class BulkSegmenter;
+
+/**
+ * @class BulkReassembler
+ * @brief Receives fragmented transfers and routes them to registered sinks
+ *
+ * Fragments must arrive in order; a gap or duplicate is answered with
+ * BULK_ERR_OFFSET and the byte count received so far, and the sender
+ * resumes from there (the CRC is computed as the data streams through).
+ */
+class BulkReassembler {
+private:
+  BulkSink* sinks[BULK_MAX_TARGETS];
+  BulkSink* activeSink;
+  BulkSegmenter* sender;
+  uint8_t activeId;
+  uint32_t totalLength;
+  uint32_t received;
+  uint32_t expectedCrc;
+  uint32_t runningCrc;
+  uint32_t lastAckAt;
+  unsigned long completedTransfers;
+  unsigned long failedTransfers;
+
+  size_t writeAck(uint8_t* reply, uint8_t id, BulkStatus status);
+  size_t fail(uint8_t* reply, uint8_t id, BulkStatus status);
+  size_t handleBegin(const uint8_t* frame, size_t length, uint8_t* reply);
+  size_t handleData(const uint8_t* frame, size_t length, uint8_t* reply);
+  size_t handleEnd(const uint8_t* frame, uint8_t* reply);
+
+public:
+  BulkReassembler();
+
+  /**
+   * @brief Register the destination for a target id
+   * @param target Target id (BulkTarget)
+   * @param sink Destination, or nullptr to unregister
+   */
+  void registerSink(uint8_t target, BulkSink* sink);
+
+  /**
+   * @brief Route ACK frames from the other side to an outgoing transfer
+   * @param segmenter Sender of our transfers, or nullptr
+   */
+  void setSender(BulkSegmenter* segmenter) { sender = segmenter; }
+
+  /**
+   * @brief Handle one incoming frame
+   * @param frame Frame bytes
+   * @param length Frame length
+   * @param reply Buffer of at least BULK_ACK_SIZE bytes for the response
+   * @return Length of the response to send (0 = none)
+   */
+  size_t handleFrame(const uint8_t* frame, size_t length, uint8_t* reply);
+
+  bool isActive() const { return activeSink != nullptr; }
+  uint32_t getReceived() const { return received; }
+  unsigned long getCompletedTransfers() const { return completedTransfers; }
+  unsigned long getFailedTransfers() const { return failedTransfers; }
+};
+
+/**
+ * @class BulkSegmenter
+ * @brief Splits an in-memory payload into frames for the negotiated MTU
+ *
+ * The receiver's ACKs (see BulkReassembler) may arrive on another task
+ * than the one producing frames; handleAck() only records them and
+ * nextPacedFrame() acts on them.
+ */
+class BulkSegmenter {
+private:
+  const uint8_t* source;
+  uint32_t length;
+  uint32_t offset;
+  uint32_t crc;
+  uint8_t transferId;
+  uint8_t target;
+  uint16_t mtu;
+  uint8_t stage;  // 0 = BEGIN, 1 = DATA, 2 = END, 3 = done
+
+  // Receiver progress, written by handleAck()
+  std::atomic<uint32_t> ackedBytes;
+  std::atomic<uint32_t> resumeOffset;
+  std::atomic<bool> resumeRequested;
+  std::atomic<bool> endSent;
+  std::atomic<bool> acknowledged;
+  std::atomic<uint8_t> failure;
+  std::atomic<uint32_t> acksReceived;
+
+public:
+  BulkSegmenter();
+
+  /**
+   * @brief Start segmenting a payload
+   * @param id Transfer id echoed in every frame
+   * @param dest Target id at the receiver
+   * @param data Payload (must stay valid until done)
+   * @param dataLength Payload length
+   * @param negotiatedMtu ATT MTU of the link
+   */
+  void start(uint8_t id, uint8_t dest, const uint8_t* data, uint32_t dataLength, uint16_t negotiatedMtu);
+
+  /**
+   * @brief Produce the next frame
+   * @param out Buffer of at least (MTU - BULK_ATT_OVERHEAD) bytes
+   * @return Frame length, or 0 when the transfer is complete
+   */
+  size_t nextFrame(uint8_t* out);
+
+  /**
+   * @brief Resume from an offset reported by the receiver
+   * @param resumeOffset Bytes the receiver already holds
+   */
+  void rewind(uint32_t resumeOffset);
+
+  /**
+   * @brief Record an ACK frame from the receiver
+   * @param frame ACK frame
+   * @param frameLength Frame length
+   */
+  void handleAck(const uint8_t* frame, size_t frameLength);
+
+  /**
+   * @brief Produce the next frame the receiver is ready for
+   *
+   * Resumes from the acknowledged offset after BULK_ERR_OFFSET and holds
+   * DATA back while BULK_TX_WINDOW bytes are unacknowledged.
+   * @param out Buffer of at least (MTU - BULK_ATT_OVERHEAD) bytes
+   * @return Frame length, or 0 if nothing may be sent now
+   */
+  size_t nextPacedFrame(uint8_t* out);
+
+  bool isDone() const { return stage == 3; }
+  bool isAcknowledged() const { return acknowledged; }          // END answered with BULK_OK
+  uint8_t getFailure() const { return failure; }                // First fatal BulkStatus, BULK_OK if none
+  uint32_t getAcksReceived() const { return acksReceived; }
+};
+
+#endif
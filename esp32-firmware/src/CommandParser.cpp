@@ -0,0 +1,68 @@
+#include "CommandParser.h"
+
+CommandParser::CommandParser()
+  : length(0), complete(false), overflow(false), overflowCount(0) {
+  buffer[0] = '\0';
+}
+
+void CommandParser::reset() {
+  length = 0;
+  complete = false;
+  overflow = false;
+  buffer[0] = '\0';
+}
+
+bool CommandParser::feed(char c) {
+  if (complete) {
+    length = 0;
+    complete = false;
+  }
+
+  if (c == '\n') {
+    if (overflow) {
+      overflow = false;
+      length = 0;
+      return false;
+    }
+
+    // Trim trailing whitespace (CR from serial terminals)
+    while (length > 0 && (buffer[length - 1] == '\r' || buffer[length - 1] == ' ' || buffer[length - 1] == '\t')) {
+      length--;
+    }
+    buffer[length] = '\0';
+    complete = length > 0;
+    return complete;
+  }
+
+  // Skip leading whitespace
+  if (length == 0 && (c == ' ' || c == '\t' || c == '\r')) return false;
+
+  if (overflow) return false;
+  if (length >= COMMAND_MAX_LENGTH) {
+    overflow = true;
+    overflowCount++;
+    return false;
+  }
+
+  buffer[length++] = c;
+  return false;
+}
+
+bool CommandParser::parseInteger(const char* text, long* value) {
+  bool negative = false;
+  if (*text == '-') {
+    negative = true;
+    text++;
+  }
+  if (*text < '0' || *text > '9') return false;
+
+  long result = 0;
+  while (*text >= '0' && *text <= '9') {
+    if (result < COMMAND_INTEGER_LIMIT) {
+      result = result * 10 + (*text - '0');  // Saturates instead of overflowing
+    }
+    text++;
+  }
+  *value = negative ? -result : result;
+  return true;
+}
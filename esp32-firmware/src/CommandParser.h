@@ -0,0 +1,57 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define COMMAND_MAX_LENGTH 96
+#define COMMAND_INTEGER_LIMIT 100000000L
+
+/**
+ * @class CommandParser
+ * @brief Splits a byte stream into newline-terminated command lines
+ *
+ * Shared by every transport. Works in a fixed buffer with no heap
+ * allocation; over-long lines are dropped and counted.
+ */
+class CommandParser {
+private:
+  char buffer[COMMAND_MAX_LENGTH + 1];
+  size_t length;
+  bool complete;
+  bool overflow;
+  unsigned long overflowCount;
+
+public:
+  CommandParser();
+
+  /**
+   * @brief Feed one received byte
+   * @param c Received byte
+   * @return true when a complete, trimmed, non-empty line is available
+   */
+  bool feed(char c);
+
+  /**
+   * @brief Last completed line (valid until the next feed)
+   */
+  const char* line() const { return buffer; }
+  size_t lineLength() const { return length; }
+
+  /**
+   * @brief Discard any partial line
+   */
+  void reset();
+
+  unsigned long getOverflowCount() const { return overflowCount; }
+
+  /**
+   * @brief Parse a decimal integer field
+   * @param text Field text (leading digits are used, like String::toInt)
+   * @param value Parsed value
+   * @return false if the field has no digits
+   */
+  static bool parseInteger(const char* text, long* value);
+};
+
+#endif
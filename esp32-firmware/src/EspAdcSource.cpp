@@ -0,0 +1,72 @@
+#ifdef ARDUINO
+
+#include "EspAdcSource.h"
+
+EspAdcSource::EspAdcSource(adc1_channel_t adcChannel)
+  : channel(adcChannel), calibrationSource(ESP_ADC_CAL_VAL_DEFAULT_VREF), running(false) {}
+
+bool EspAdcSource::begin() {
+  calibrationSource = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                               BATTERY_ADC_DEFAULT_VREF_MV, &calibration);
+
+  adc_digi_init_config_t init = {};
+  init.max_store_buf_size = BATTERY_ADC_BUFFER_BYTES;
+  init.conv_num_each_intr = BATTERY_ADC_FRAME_BYTES;
+  init.adc1_chan_mask = 1 << channel;
+  init.adc2_chan_mask = 0;
+  if (adc_digi_initialize(&init) != ESP_OK) return false;
+
+  adc_digi_pattern_config_t pattern = {};
+  pattern.atten = ADC_ATTEN_DB_11;
+  pattern.channel = channel;
+  pattern.unit = 0;  // ADC1
+  pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+  adc_digi_configuration_t config = {};
+  config.conv_limit_en = 1;
+  config.conv_limit_num = 250;
+  config.pattern_num = 1;
+  config.adc_pattern = &pattern;
+  config.sample_freq_hz = BATTERY_ADC_SAMPLE_HZ;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+    adc_digi_deinitialize();
+    return false;
+  }
+
+  running = true;
+  return true;
+}
+
+const char* EspAdcSource::getCalibrationName() const {
+  switch (calibrationSource) {
+    case ESP_ADC_CAL_VAL_EFUSE_TP: return "two-point";
+    case ESP_ADC_CAL_VAL_EFUSE_VREF: return "eFuse Vref";
+    default: return "default Vref";
+  }
+}
+
+size_t EspAdcSource::read(uint16_t* samples, size_t maxSamples) {
+  if (!running) return 0;
+
+  size_t bytes = maxSamples * SOC_ADC_DIGI_RESULT_BYTES;
+  if (bytes > sizeof(frame)) bytes = sizeof(frame);
+
+  uint32_t length = 0;
+  if (adc_digi_read_bytes(frame, bytes, &length, 0) != ESP_OK) return 0;
+
+  size_t count = 0;
+  for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+    const adc_digi_output_data_t* result = (const adc_digi_output_data_t*)&frame[i];
+    if (result->type1.channel != channel) continue;
+    samples[count++] = result->type1.data;
+  }
+  return count;
+}
+
+uint32_t EspAdcSource::toMillivolts(uint32_t raw) const {
+  return esp_adc_cal_raw_to_voltage(raw, &calibration);
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef ESP_ADC_SOURCE_H
+#define ESP_ADC_SOURCE_H
+
+#ifdef ARDUINO
+
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include "AdcSource.h"
+#include "config.h"
+
+/**
+ * @class EspAdcSource
+ * @brief ADC1 continuous mode with the chip's factory calibration
+ *
+ * The digital controller converts at BATTERY_ADC_SAMPLE_HZ into a DMA ring
+ * with no CPU involvement; read() only copies out what has accumulated.
+ * Raw counts are converted with the characterisation burned into eFuse
+ * (two-point, or the measured Vref), which removes the ~±100 mV spread
+ * between chips that the linear count-to-volts map had.
+ */
+class EspAdcSource : public AdcSource {
+private:
+  adc1_channel_t channel;
+  esp_adc_cal_characteristics_t calibration;
+  esp_adc_cal_value_t calibrationSource;
+  uint8_t frame[BATTERY_ADC_FRAME_BYTES];
+  bool running;
+
+public:
+  explicit EspAdcSource(adc1_channel_t adcChannel);
+
+  /**
+   * @brief Characterise the ADC and start continuous conversion
+   * @return true if the DMA conversion is running
+   */
+  bool begin();
+
+  /**
+   * @brief Which eFuse calibration the conversion uses
+   * @return "two-point", "eFuse Vref" or "default Vref"
+   */
+  const char* getCalibrationName() const;
+
+  bool isRunning() const { return running; }
+
+  size_t read(uint16_t* samples, size_t maxSamples) override;
+  uint32_t toMillivolts(uint32_t raw) const override;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+#ifdef ARDUINO
+
+#include "EspFlashBackend.h"
+
+EspFlashBackend::EspFlashBackend() : partition(nullptr) {}
+
+bool EspFlashBackend::begin(uint32_t imageSize) {
+  partition = esp_ota_get_next_update_partition(NULL);
+  if (!partition) return false;
+  return imageSize <= partition->size;
+}
+
+bool EspFlashBackend::eraseSector(uint32_t offset) {
+  if (!partition) return false;
+  return esp_partition_erase_range(partition, offset, FLASH_SECTOR_SIZE) == ESP_OK;
+}
+
+bool EspFlashBackend::write(uint32_t offset, const uint8_t* data, size_t length) {
+  if (!partition) return false;
+  return esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
+
+bool EspFlashBackend::activate() {
+  if (!partition) return false;
+  return esp_ota_set_boot_partition(partition) == ESP_OK;
+}
+
+void EspFlashBackend::abort() {
+  partition = nullptr;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef ESP_FLASH_BACKEND_H
+#define ESP_FLASH_BACKEND_H
+
+#ifdef ARDUINO
+
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include "FlashBackend.h"
+
+/**
+ * @class EspFlashBackend
+ * @brief Writes the image into the inactive OTA app partition
+ *
+ * The boot switch goes through esp_ota_set_boot_partition, which verifies
+ * the image and updates otadata in a single atomic step.
+ */
+class EspFlashBackend : public FlashBackend {
+private:
+  const esp_partition_t* partition;
+
+public:
+  EspFlashBackend();
+
+  bool begin(uint32_t imageSize) override;
+  bool eraseSector(uint32_t offset) override;
+  bool write(uint32_t offset, const uint8_t* data, size_t length) override;
+  bool activate() override;
+  void abort() override;
+};
+
+#endif
+
+#endif
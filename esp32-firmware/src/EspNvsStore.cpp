@@ -0,0 +1,22 @@
+#ifdef ARDUINO
+
+#include "EspNvsStore.h"
+
+EspNvsStore::EspNvsStore(const char* nvsNamespace) : name(nvsNamespace), opened(false) {}
+
+bool EspNvsStore::begin() {
+  if (!opened) opened = preferences.begin(name, false);
+  return opened;
+}
+
+bool EspNvsStore::read(const char* key, void* data, size_t length) {
+  if (!opened || preferences.getBytesLength(key) != length) return false;
+  return preferences.getBytes(key, data, length) == length;
+}
+
+bool EspNvsStore::write(const char* key, const void* data, size_t length) {
+  if (!opened) return false;
+  return preferences.putBytes(key, data, length) == length;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef ESP_NVS_STORE_H
+#define ESP_NVS_STORE_H
+
+#ifdef ARDUINO
+
+#include <Preferences.h>
+#include "NvsStore.h"
+
+/**
+ * @class EspNvsStore
+ * @brief One namespace of the nvs partition, through Preferences
+ *
+ * Every write is committed before it returns; the NVS library spreads
+ * entries over its pages, so the flash wears evenly.
+ */
+class EspNvsStore : public NvsStore {
+private:
+  const char* name;
+  Preferences preferences;
+  bool opened;
+
+public:
+  explicit EspNvsStore(const char* nvsNamespace);
+
+  bool begin() override;
+  bool read(const char* key, void* data, size_t length) override;
+  bool write(const char* key, const void* data, size_t length) override;
+};
+
+#endif
+
+#endif
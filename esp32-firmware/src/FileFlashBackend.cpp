@@ -0,0 +1,57 @@
+#ifndef ARDUINO
+
+#include "FileFlashBackend.h"
+#include <string.h>
+
+FileFlashBackend::FileFlashBackend(const char* image, const char* boot, uint32_t slotSize)
+  : imagePath(image), bootPath(boot), capacity(slotSize), imageSize(0), file(nullptr) {}
+
+FileFlashBackend::~FileFlashBackend() {
+  if (file) fclose(file);
+}
+
+bool FileFlashBackend::begin(uint32_t size) {
+  if (size > capacity) return false;
+  if (file) fclose(file);
+
+  file = fopen(imagePath.c_str(), "w+b");
+  imageSize = size;
+  return file != nullptr;
+}
+
+bool FileFlashBackend::eraseSector(uint32_t offset) {
+  if (!file || offset % FLASH_SECTOR_SIZE != 0 || offset >= capacity) return false;
+
+  uint8_t erased[FLASH_SECTOR_SIZE];
+  memset(erased, 0xFF, sizeof(erased));
+  if (fseek(file, offset, SEEK_SET) != 0) return false;
+  return fwrite(erased, 1, sizeof(erased), file) == sizeof(erased);
+}
+
+bool FileFlashBackend::write(uint32_t offset, const uint8_t* data, size_t length) {
+  if (!file || offset + length > capacity) return false;
+  if (fseek(file, offset, SEEK_SET) != 0) return false;
+  return fwrite(data, 1, length, file) == length;
+}
+
+bool FileFlashBackend::activate() {
+  if (!file) return false;
+  fflush(file);
+
+  std::string tmpPath = bootPath + ".tmp";
+  FILE* boot = fopen(tmpPath.c_str(), "w");
+  if (!boot) return false;
+  fprintf(boot, "%s %u\n", imagePath.c_str(), (unsigned)imageSize);
+  fclose(boot);
+
+  return rename(tmpPath.c_str(), bootPath.c_str()) == 0;
+}
+
+void FileFlashBackend::abort() {
+  if (file) {
+    fclose(file);
+    file = nullptr;
+  }
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef FILE_FLASH_BACKEND_H
+#define FILE_FLASH_BACKEND_H
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <string>
+#include "FlashBackend.h"
+
+/**
+ * @class FileFlashBackend
+ * @brief Host stand-in for the OTA partition, backed by a file
+ *
+ * Erase fills a sector with 0xFF like NOR flash. activate() writes the
+ * boot selection to a temporary file and renames it over bootPath, so the
+ * switch is atomic the same way otadata is on the device.
+ */
+class FileFlashBackend : public FlashBackend {
+private:
+  std::string imagePath;
+  std::string bootPath;
+  uint32_t capacity;
+  uint32_t imageSize;
+  FILE* file;
+
+public:
+  FileFlashBackend(const char* image, const char* boot, uint32_t slotSize);
+  ~FileFlashBackend();
+
+  bool begin(uint32_t size) override;
+  bool eraseSector(uint32_t offset) override;
+  bool write(uint32_t offset, const uint8_t* data, size_t length) override;
+  bool activate() override;
+  void abort() override;
+};
+
+#endif
+
+#endif
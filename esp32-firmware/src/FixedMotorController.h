@@ -0,0 +1,220 @@
+#ifndef FIXED_MOTOR_CONTROLLER_H
+#define FIXED_MOTOR_CONTROLLER_H
+
+#include <Arduino.h>
+#include <string.h>
+#include "config.h"
+#include "MotorCommitPipeline.h"
+#include "RaindropEngine.h"
+#include "SpatialPattern.h"
+
+/**
+ * @class FixedMotorController
+ * @brief MotorController with the channel count and duty limit fixed at compile time
+ *
+ * Renders exactly the same frames as MotorController (checked by the
+ * pattern regression), but with N and MaxDuty as constants the loops
+ * have fixed trip counts, the wave modulo and the intensity mapping
+ * become multiplies, and the frame buffers and spatial tables are sized
+ * to N. The spatial modes share SpatialPatternEngine with
+ * MotorController, so they need the same setLayout() call to render the
+ * same frames.
+ *
+ * Both classes commit through MotorCommitPipeline, so either can drive
+ * the motors in main.cpp.
+ *
+ * @tparam N Number of motors
+ * @tparam MaxDuty Highest duty cycle written (8-bit PWM)
+ */
+template <int N, int MaxDuty>
+class FixedMotorController {
+  static_assert(N > 0 && N <= MOTOR_MAX_CHANNELS, "Motor count out of range");
+  static_assert(MaxDuty > 0 && MaxDuty <= 255, "Duty limit must fit 8-bit PWM");
+
+private:
+  const int* motorPins;
+  uint8_t frameDuty[N];
+  uint8_t committedDuty[N];
+  MotorCommitPipeline pipeline;
+  
+  MassageMode activeMode;
+  RaindropEngine raindrops;
+  FixedSpatialPatternEngine<N> spatial;
+
+  static int intensityToDuty(int intensity) {
+    intensity = constrain(intensity, 0, 100);
+    return intensity * MaxDuty / 100;  // Same result as map(intensity, 0, 100, 0, MaxDuty)
+  }
+  
+  void clearFrame() {
+    memset(frameDuty, 0, sizeof(frameDuty));
+  }
+  
+public:
+  explicit FixedMotorController(const int* pins)
+    : motorPins(pins), activeMode(MODE_OFF) {
+    memset(frameDuty, 0, sizeof(frameDuty));
+    memset(committedDuty, 0, sizeof(committedDuty));
+    seedRandom(0);
+    resetPatternState();
+    spatial.setLayout(nullptr, N);
+  }
+  
+  /**
+   * @brief Set the motors' physical positions for the spatial modes
+   * @param positions (x, y) in mm per motor (must stay valid), or nullptr
+   *                  for motors evenly spaced on a line
+   */
+  void setLayout(const int16_t (*positions)[2]) { spatial.setLayout(positions, N); }
+  
+  /**
+   * @brief Drive an external output backend instead of the LEDC channels
+   * @param backend Output backend, or nullptr for LEDC (before begin())
+   */
+  void setOutput(PwmOutput* backend) { pipeline.setOutput(backend); }
+  
+  /**
+   * @brief Initialize PWM channels for all motors
+   * @return true if initialization successful
+   */
+  bool begin() { return pipeline.begin(motorPins, N); }
+  
+  /**
+   * @brief Limit the rendered frame and write it to the PWM channels
+   * @return Time the frame took effect (micros)
+   */
+  uint32_t commitFrame() { return pipeline.commit(frameDuty, committedDuty, N); }
+  
+  void setTraceRecorder(PwmTraceRecorder* recorder) { pipeline.setTraceRecorder(recorder); }
+  void setGovernor(PowerGovernor* powerGovernor) { pipeline.setGovernor(powerGovernor); }
+  void setThermalModel(ThermalModel* model) { pipeline.setThermalModel(model); }
+  uint32_t getCommittedDutySum() const { return pipeline.getCommittedDutySum(); }
+  
+  int getCommittedDuty(int motorIndex) const {
+    return (motorIndex >= 0 && motorIndex < N) ? committedDuty[motorIndex] : 0;
+  }
+  
+  int getFrameDuty(int motorIndex) const {
+    return (motorIndex >= 0 && motorIndex < N) ? frameDuty[motorIndex] : 0;
+  }
+  
+  void seedRandom(uint32_t seed) {
+    raindrops.seed(seed);
+  }
+  
+  void resetPatternState() {
+    raindrops.reset();
+  }
+  
+  void setMotor(int motorIndex, int dutyCycle) {
+    if (motorIndex >= 0 && motorIndex < N) {
+      frameDuty[motorIndex] = constrain(dutyCycle, 0, MaxDuty);
+    }
+  }
+  
+  void setAllMotors(int dutyCycle) {
+    memset(frameDuty, constrain(dutyCycle, 0, MaxDuty), sizeof(frameDuty));
+  }
+  
+  void stopAll() {
+    clearFrame();
+  }
+  
+  void applyConstant(int intensity) {
+    memset(frameDuty, intensityToDuty(intensity), sizeof(frameDuty));
+  }
+  
+  void applyPulse(int intensity, unsigned long timestamp) {
+    if (timestamp % PULSE_CYCLE_MS < PULSE_ON_DURATION_MS) {
+      applyConstant(intensity);
+    } else {
+      clearFrame();
+    }
+  }
+  
+  void applyWave(int intensity, unsigned long timestamp) {
+    int duty = intensityToDuty(intensity);
+    int primaryMotor = (timestamp / WAVE_STEP_MS) % N;
+    int secondaryMotor = (primaryMotor + 1 == N) ? 0 : primaryMotor + 1;
+    
+    clearFrame();
+    frameDuty[secondaryMotor] = duty / 2;
+    frameDuty[primaryMotor] = duty;  // Wins when N == 1
+  }
+  
+  void applyHeartbeat(int intensity, unsigned long timestamp) {
+    const int centerA = (N / 2) - 1;
+    const int centerB = (N / 2);
+    unsigned long cyclePos = timestamp % HEARTBEAT_CYCLE_MS;
+    int duty = intensityToDuty(intensity);
+    
+    clearFrame();
+    
+    if (cyclePos < HEARTBEAT_SHORT_ON_MS) {
+      if (centerA - 1 >= 0) frameDuty[centerA - 1] = duty / 3;
+      if (centerB + 1 < N) frameDuty[centerB + 1] = duty / 3;
+      if (centerA >= 0) frameDuty[centerA] = duty;
+      frameDuty[centerB] = duty;
+    } else if (cyclePos >= HEARTBEAT_SHORT_ON_MS + HEARTBEAT_SHORT_OFF_MS &&
+               cyclePos < HEARTBEAT_SHORT_ON_MS + HEARTBEAT_SHORT_OFF_MS + HEARTBEAT_SHORT_ON_MS) {
+      if (centerA >= 0) frameDuty[centerA] = duty;
+      frameDuty[centerB] = duty;
+    }
+  }
+  
+  void applyRaindrops(int intensity, unsigned long timestamp) {
+    raindrops.render(intensityToDuty(intensity), timestamp, frameDuty, N);
+  }
+  
+  void applySpatial(SpatialShape shape, int intensity, unsigned long timestamp) {
+    spatial.select(shape);
+    spatial.render(intensityToDuty(intensity), timestamp, frameDuty);
+  }
+  
+  void applyMode(MassageMode mode, int intensity, unsigned long timestamp) {
+    if (mode != activeMode) {
+      resetPatternState();
+      activeMode = mode;
+    }
+    
+    switch (mode) {
+      case MODE_PULSE:
+        applyPulse(intensity, timestamp);
+        break;
+        
+      case MODE_WAVE:
+        applyWave(intensity, timestamp);
+        break;
+        
+      case MODE_CONSTANT:
+        applyConstant(intensity);
+        break;
+        
+      case MODE_HEARTBEAT:
+        applyHeartbeat(intensity, timestamp);
+        break;
+        
+      case MODE_RAINDROPS:
+        applyRaindrops(intensity, timestamp);
+        break;
+        
+      case MODE_SWEEP:
+        applySpatial(SPATIAL_SWEEP, intensity, timestamp);
+        break;
+        
+      case MODE_RIPPLE:
+        applySpatial(SPATIAL_RIPPLE, intensity, timestamp);
+        break;
+        
+      case MODE_SPOT:
+        applySpatial(SPATIAL_SPOT, intensity, timestamp);
+        break;
+        
+      default:
+        clearFrame();
+        break;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef FLASH_BACKEND_H
+#define FLASH_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FLASH_SECTOR_SIZE 4096
+
+/**
+ * @class FlashBackend
+ * @brief Storage for a firmware image being written by OtaUpdater
+ *
+ * Offsets are relative to the start of the update slot. Sectors are
+ * erased before they are written, one FLASH_SECTOR_SIZE at a time.
+ */
+class FlashBackend {
+public:
+  virtual ~FlashBackend() {}
+
+  /**
+   * @brief Select the update slot for an image of the given size
+   * @return false if no slot can hold the image
+   */
+  virtual bool begin(uint32_t imageSize) = 0;
+
+  /**
+   * @brief Erase one sector of the update slot
+   * @param offset Sector-aligned offset
+   */
+  virtual bool eraseSector(uint32_t offset) = 0;
+
+  /**
+   * @brief Write image bytes into an erased region
+   */
+  virtual bool write(uint32_t offset, const uint8_t* data, size_t length) = 0;
+
+  /**
+   * @brief Atomically mark the written slot as the next boot image
+   */
+  virtual bool activate() = 0;
+
+  /**
+   * @brief Abandon the update; the current boot slot is untouched
+   */
+  virtual void abort() {}
+};
+
+#endif
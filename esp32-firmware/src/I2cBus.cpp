@@ -0,0 +1,54 @@
+#include "I2cBus.h"
+#include <string.h>
+
+CountingI2cBus::CountingI2cBus()
+  : deviceCount(0), transactions(0), bytes(0), clocks(0) {
+  memset(addresses, 0, sizeof(addresses));
+  memset(registers, 0, sizeof(registers));
+}
+
+int CountingI2cBus::findDevice(uint8_t address) const {
+  for (int i = 0; i < deviceCount; i++) {
+    if (addresses[i] == address) return i;
+  }
+  return -1;
+}
+
+bool CountingI2cBus::addDevice(uint8_t address) {
+  if (deviceCount >= I2C_MODEL_DEVICES) return false;
+  addresses[deviceCount++] = address;
+  return true;
+}
+
+bool CountingI2cBus::write(uint8_t address, const uint8_t* data, size_t length) {
+  // The address byte goes out (and costs bus time) whether or not it is acknowledged
+  transactions++;
+  bytes += length + 1;
+  clocks += 9ULL * (length + 1) + 2;
+
+  int device = findDevice(address);
+  if (device < 0) return false;
+  if (length == 0) return true;
+
+  uint8_t pointer = data[0];
+  for (size_t i = 1; i < length; i++) {
+    registers[device][pointer++] = data[i];  // Auto-increment, wrapping at 0xFF
+  }
+  return true;
+}
+
+const uint8_t* CountingI2cBus::getRegisters(uint8_t address) const {
+  int device = findDevice(address);
+  return device < 0 ? nullptr : registers[device];
+}
+
+void CountingI2cBus::resetCounters() {
+  transactions = 0;
+  bytes = 0;
+  clocks = 0;
+}
+
+unsigned long CountingI2cBus::getBusMicros(uint32_t clockHz) const {
+  if (clockHz == 0) return 0;
+  return (unsigned long)(clocks * 1000000ULL / clockHz);
+}
@@ -0,0 +1,76 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define I2C_MODEL_DEVICES 4
+#define I2C_MODEL_REGISTERS 256
+
+/**
+ * @class I2cBus
+ * @brief Master-side I2C writes (one START ... STOP transaction per call)
+ */
+class I2cBus {
+public:
+  virtual ~I2cBus() {}
+
+  /**
+   * @brief Write bytes to a device in one transaction
+   * @param address 7-bit device address
+   * @param data Bytes after the address byte (register pointer first)
+   * @param length Number of bytes
+   * @return false if the device did not acknowledge
+   */
+  virtual bool write(uint8_t address, const uint8_t* data, size_t length) = 0;
+};
+
+/**
+ * @class CountingI2cBus
+ * @brief I2C stand-in that counts bus traffic and keeps device registers
+ *
+ * Each registered device gets an auto-incrementing register file, so
+ * host checks can read back what a driver wrote. Bus time is modelled as
+ * 9 clocks per byte (8 data + ACK) including the address byte, plus one
+ * clock each for START and STOP.
+ */
+class CountingI2cBus : public I2cBus {
+private:
+  uint8_t addresses[I2C_MODEL_DEVICES];
+  uint8_t registers[I2C_MODEL_DEVICES][I2C_MODEL_REGISTERS];
+  int deviceCount;
+  unsigned long transactions;
+  unsigned long bytes;       // Including address bytes
+  unsigned long long clocks;
+
+  int findDevice(uint8_t address) const;
+
+public:
+  CountingI2cBus();
+
+  /**
+   * @brief Attach a modelled device (writes to others are NACKed)
+   * @return false if the model is full
+   */
+  bool addDevice(uint8_t address);
+
+  bool write(uint8_t address, const uint8_t* data, size_t length) override;
+
+  /**
+   * @brief Register file of a modelled device (nullptr if unknown)
+   */
+  const uint8_t* getRegisters(uint8_t address) const;
+
+  void resetCounters();
+  unsigned long getTransactions() const { return transactions; }
+  unsigned long getBytes() const { return bytes; }
+
+  /**
+   * @brief Time the counted traffic takes on the wire
+   * @param clockHz SCL frequency (e.g. 400000, 1000000)
+   * @return Bus time in microseconds
+   */
+  unsigned long getBusMicros(uint32_t clockHz) const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "LatencyTracker.h"
+#include <stdio.h>
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+void LatencyHistogram::reset() {
+  for (int i = 0; i < LATENCY_BUCKETS; i++) counts[i] = 0;
+  total = 0;
+  maxValue = 0;
+}
+
+int LatencyHistogram::bucketFor(uint32_t value) {
+  if (value < LATENCY_SUB_BUCKETS) return value;
+
+  int msb = 31 - __builtin_clz(value);
+  if (msb > LATENCY_MAX_MSB) return LATENCY_BUCKETS - 1;
+
+  int sub = (value >> (msb - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+  return (msb - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(int bucket) {
+  if (bucket < LATENCY_SUB_BUCKETS) return bucket;
+
+  int msb = bucket / LATENCY_SUB_BUCKETS + LATENCY_SUB_BITS - 1;
+  int sub = bucket % LATENCY_SUB_BUCKETS;
+  uint32_t lower = (uint32_t)(LATENCY_SUB_BUCKETS + sub) << (msb - LATENCY_SUB_BITS);
+  return lower + (1UL << (msb - LATENCY_SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint32_t value) {
+  counts[bucketFor(value)]++;
+  total++;
+  if (value > maxValue) maxValue = value;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t percent) const {
+  if (total == 0) return 0;
+
+  // Rank of the requested sample, rounded up
+  uint32_t rank = ((uint64_t)total * percent + 99) / 100;
+  if (rank == 0) rank = 1;
+
+  uint32_t seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      uint32_t bound = bucketUpperBound(i);
+      return bound < maxValue ? bound : maxValue;
+    }
+  }
+  return maxValue;
+}
+
+LatencyTracker::LatencyTracker() {
+  reset();
+}
+
+void LatencyTracker::reset() {
+  endToEnd.reset();
+  queueTotal = 0;
+  tickWaitTotal = 0;
+  actuationTotal = 0;
+}
+
+void LatencyTracker::record(const CommandTrace& trace, uint32_t committedUs) {
+  // Unsigned differences stay correct across micros() wrap-around
+  endToEnd.record(committedUs - trace.receivedUs);
+  queueTotal += trace.parsedUs - trace.receivedUs;
+  tickWaitTotal += trace.appliedUs - trace.parsedUs;
+  actuationTotal += committedUs - trace.appliedUs;
+}
+
+size_t LatencyTracker::format(char* out, size_t capacity) const {
+  uint32_t n = endToEnd.getCount();
+  int written = snprintf(out, capacity,
+                         "n=%lu,p50=%lu,p90=%lu,p99=%lu,max=%lu,queue=%lu,tick_wait=%lu,actuation=%lu",
+                         (unsigned long)n,
+                         (unsigned long)endToEnd.percentile(50),
+                         (unsigned long)endToEnd.percentile(90),
+                         (unsigned long)endToEnd.percentile(99),
+                         (unsigned long)endToEnd.getMax(),
+                         (unsigned long)(n ? queueTotal / n : 0),
+                         (unsigned long)(n ? tickWaitTotal / n : 0),
+                         (unsigned long)(n ? actuationTotal / n : 0));
+  if (written < 0) return 0;
+  return (size_t)written < capacity ? (size_t)written : capacity - 1;
+}
@@ -0,0 +1,90 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Log-linear histogram: 8 sub-buckets per power of two (<= 12.5% error)
+#define LATENCY_SUB_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_MSB 24                     // Values up to ~16.7 s (in us)
+#define LATENCY_BUCKETS ((LATENCY_MAX_MSB - LATENCY_SUB_BITS + 2) * LATENCY_SUB_BUCKETS)
+
+/**
+ * @brief Timestamps (micros) a command collects on its way to the motors
+ */
+struct CommandTrace {
+  uint32_t receivedUs;   // Write reached the transport
+  uint32_t parsedUs;     // Complete line parsed by the command core
+  uint32_t appliedUs;    // SessionManager applied it at an engine tick
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size histogram for percentile estimates
+ */
+class LatencyHistogram {
+private:
+  uint32_t counts[LATENCY_BUCKETS];
+  uint32_t total;
+  uint32_t maxValue;
+
+  static int bucketFor(uint32_t value);
+  static uint32_t bucketUpperBound(int bucket);
+
+public:
+  LatencyHistogram();
+
+  void reset();
+  void record(uint32_t value);
+
+  /**
+   * @brief Estimate a percentile
+   * @param percent Percentile (0-100)
+   * @return Upper bound of the bucket holding that percentile
+   */
+  uint32_t percentile(uint8_t percent) const;
+
+  uint32_t getCount() const { return total; }
+  uint32_t getMax() const { return maxValue; }
+};
+
+/**
+ * @class LatencyTracker
+ * @brief Command-to-actuation latency: end-to-end distribution and stage means
+ *
+ * Fed once per command that reaches the motors, with the trace it
+ * collected and the time of the first MotorController frame commit that
+ * reflects it.
+ */
+class LatencyTracker {
+private:
+  LatencyHistogram endToEnd;
+  uint64_t queueTotal;      // received -> parsed
+  uint64_t tickWaitTotal;   // parsed -> applied
+  uint64_t actuationTotal;  // applied -> committed
+
+public:
+  LatencyTracker();
+
+  void reset();
+
+  /**
+   * @brief Record one command's journey
+   * @param trace Timestamps collected by the command
+   * @param committedUs Time the motor frame reflecting it was committed
+   */
+  void record(const CommandTrace& trace, uint32_t committedUs);
+
+  /**
+   * @brief Format as key=value pairs (microseconds)
+   * @param out Destination
+   * @param capacity Destination size
+   * @return Number of characters written
+   */
+  size_t format(char* out, size_t capacity) const;
+
+  const LatencyHistogram& getHistogram() const { return endToEnd; }
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef ARDUINO
+
+#include "LoopbackGattClient.h"
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+LoopbackGattClient::LoopbackGattClient() : fd(-1), mtu(GATT_LOOPBACK_DEFAULT_MTU) {}
+
+LoopbackGattClient::~LoopbackGattClient() {
+  disconnect();
+}
+
+bool LoopbackGattClient::connect(const char* socketPath) {
+  struct sockaddr_un addr;
+  if (strlen(socketPath) >= sizeof(addr.sun_path)) return false;
+
+  fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+  if (fd < 0) return false;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+  if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    disconnect();
+    return false;
+  }
+  mtu = GATT_LOOPBACK_DEFAULT_MTU;
+  return true;
+}
+
+void LoopbackGattClient::disconnect() {
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+uint16_t LoopbackGattClient::exchangeMtu(uint16_t requested, int timeoutMs) {
+  uint8_t req[3] = {GATT_OP_MTU_REQ, (uint8_t)(requested & 0xFF), (uint8_t)(requested >> 8)};
+  if (fd < 0 || send(fd, req, sizeof(req), MSG_NOSIGNAL) < 0) return 0;
+
+  // Notifications arriving before the response are dropped, as on a fresh link
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while (::poll(&pfd, 1, timeoutMs) > 0) {
+    uint8_t rsp[GATT_LOOPBACK_MAX_MTU];
+    ssize_t n = recv(fd, rsp, sizeof(rsp), 0);
+    if (n <= 0) return 0;
+    if (rsp[0] == GATT_OP_MTU_RSP && n >= 3) {
+      mtu = rsp[1] | (rsp[2] << 8);
+      return mtu;
+    }
+  }
+  return 0;
+}
+
+bool LoopbackGattClient::writeValue(uint8_t handle, const uint8_t* data, size_t length) {
+  if (fd < 0 || length > (size_t)mtu - BULK_ATT_OVERHEAD) return false;
+
+  uint8_t pdu[GATT_LOOPBACK_MAX_MTU + 2];
+  pdu[0] = GATT_OP_WRITE_CMD;
+  pdu[1] = handle;
+  memcpy(pdu + 2, data, length);
+  return send(fd, pdu, length + 2, MSG_NOSIGNAL) == (ssize_t)(length + 2);
+}
+
+bool LoopbackGattClient::writeCommand(const char* command) {
+  return writeValue(GATT_HANDLE_COMMAND, (const uint8_t*)command, strlen(command));
+}
+
+bool LoopbackGattClient::writeBulk(const uint8_t* frame, size_t length) {
+  return writeValue(GATT_HANDLE_BULK, frame, length);
+}
+
+int LoopbackGattClient::waitForNotify(uint8_t* handle, uint8_t* buffer, size_t capacity, int timeoutMs) {
+  if (fd < 0) return -1;
+
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while (::poll(&pfd, 1, timeoutMs) > 0) {
+    uint8_t pdu[GATT_LOOPBACK_MAX_MTU + 2];
+    ssize_t n = recv(fd, pdu, sizeof(pdu), 0);
+    if (n <= 0) return -1;
+    if (pdu[0] != GATT_OP_NOTIFY || n < 2) continue;
+
+    size_t length = (size_t)n - 2;
+    if (length > capacity) length = capacity;
+    *handle = pdu[1];
+    memcpy(buffer, pdu + 2, length);
+    return (int)length;
+  }
+  return -1;
+}
+
+#endif
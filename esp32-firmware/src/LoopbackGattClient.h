@@ -0,0 +1,69 @@
+#ifndef LOOPBACK_GATT_CLIENT_H
+#define LOOPBACK_GATT_CLIENT_H
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include "LoopbackGattTransport.h"
+
+/**
+ * @class LoopbackGattClient
+ * @brief Central side of LoopbackGattTransport for host test clients
+ *
+ * Mirrors what the app does over react-native-ble-plx: exchange MTU,
+ * write the command and bulk characteristics, and wait for notifications.
+ * Command traces recorded from the app can be replayed line by line.
+ */
+class LoopbackGattClient {
+private:
+  int fd;
+  uint16_t mtu;
+
+  bool writeValue(uint8_t handle, const uint8_t* data, size_t length);
+
+public:
+  LoopbackGattClient();
+  ~LoopbackGattClient();
+
+  /**
+   * @brief Connect to a LoopbackGattTransport socket
+   * @param socketPath Path passed to the transport
+   */
+  bool connect(const char* socketPath);
+  void disconnect();
+
+  /**
+   * @brief Exchange MTU and wait for the server's answer
+   * @param requested MTU to request (the app asks for 512)
+   * @param timeoutMs Time to wait for the response
+   * @return Negotiated MTU (0 on timeout)
+   */
+  uint16_t exchangeMtu(uint16_t requested, int timeoutMs);
+
+  /**
+   * @brief Write to the command characteristic (e.g. "M245\n")
+   */
+  bool writeCommand(const char* command);
+
+  /**
+   * @brief Write one frame to the bulk characteristic
+   */
+  bool writeBulk(const uint8_t* frame, size_t length);
+
+  /**
+   * @brief Wait for the next notification
+   * @param handle Characteristic handle it arrived on
+   * @param buffer Destination for the value
+   * @param capacity Destination size
+   * @param timeoutMs Time to wait
+   * @return Value length, or -1 on timeout/disconnect
+   */
+  int waitForNotify(uint8_t* handle, uint8_t* buffer, size_t capacity, int timeoutMs);
+
+  uint16_t getMtu() const { return mtu; }
+};
+
+#endif
+
+#endif
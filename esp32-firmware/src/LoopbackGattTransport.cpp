@@ -0,0 +1,224 @@
+#ifndef ARDUINO
+
+#include "LoopbackGattTransport.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+LoopbackGattTransport::LoopbackGattTransport(const char* socketPath, const GattLinkConfig& config)
+  : path(socketPath), link(config), listenFd(-1), clientFd(-1), mtu(GATT_LOOPBACK_DEFAULT_MTU)
+  , rngState(config.seed ? config.seed : 1), connectedAt(0), lastEvent(0), bulkReceiver(nullptr)
+  , writesReceived(0), writesLost(0), notificationsSent(0) {}
+
+LoopbackGattTransport::~LoopbackGattTransport() {
+  closeClient();
+  if (listenFd >= 0) {
+    close(listenFd);
+    unlink(path.c_str());
+  }
+}
+
+unsigned long LoopbackGattTransport::nowMs() const {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t LoopbackGattTransport::nowUs() const {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool LoopbackGattTransport::lose() {
+  if (link.lossPercent == 0) return false;
+
+  // xorshift32 keeps loss patterns reproducible for a given seed
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (rngState % 100) < link.lossPercent;
+}
+
+bool LoopbackGattTransport::begin(const char* deviceName) {
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path)) return false;
+
+  listenFd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+  if (listenFd < 0) return false;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  unlink(path.c_str());
+
+  if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 1) < 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+  printf("%s advertising on %s (interval %u ms, loss %u%%)\n",
+         deviceName, path.c_str(), (unsigned)link.intervalMs, (unsigned)link.lossPercent);
+  return true;
+}
+
+void LoopbackGattTransport::poll(unsigned long timestamp) {
+  if (clientFd < 0) {
+    if (listenFd < 0) return;
+    clientFd = accept(listenFd, nullptr, nullptr);
+    if (clientFd < 0) return;
+
+    fcntl(clientFd, F_SETFL, O_NONBLOCK);
+    mtu = GATT_LOOPBACK_DEFAULT_MTU;
+    connectedAt = nowMs();
+    lastEvent = connectedAt;
+  }
+
+  receivePdus();
+
+  // Run every connection event that has elapsed since the last poll
+  unsigned long now = nowMs();
+  unsigned long interval = link.intervalMs > 0 ? link.intervalMs : 1;
+  while (clientFd >= 0 && now - lastEvent >= interval) {
+    lastEvent += interval;
+    runConnectionEvent();
+  }
+}
+
+void LoopbackGattTransport::receivePdus() {
+  uint8_t buffer[GATT_LOOPBACK_MAX_MTU];
+  while (clientFd >= 0) {
+    ssize_t n = recv(clientFd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      inbound.push_back(Pdu(buffer, buffer + n));
+    } else {
+      if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) closeClient();
+      return;
+    }
+  }
+}
+
+void LoopbackGattTransport::runConnectionEvent() {
+  for (int i = 0; i < link.packetsPerEvent && !inbound.empty(); i++) {
+    deliver(inbound.front());
+    inbound.pop_front();
+  }
+
+  for (int i = 0; i < link.packetsPerEvent && !outbound.empty() && clientFd >= 0; i++) {
+    const Pdu& pdu = outbound.front();
+    if (send(clientFd, pdu.data(), pdu.size(), MSG_NOSIGNAL) < 0) {
+      closeClient();
+      return;
+    }
+    outbound.pop_front();
+    notificationsSent++;
+  }
+}
+
+void LoopbackGattTransport::deliver(const Pdu& pdu) {
+  if (pdu.empty()) return;
+
+  switch (pdu[0]) {
+    case GATT_OP_MTU_REQ: {
+      if (pdu.size() < 3) return;
+      uint16_t requested = pdu[1] | (pdu[2] << 8);
+      mtu = requested < GATT_LOOPBACK_MAX_MTU ? requested : GATT_LOOPBACK_MAX_MTU;
+      if (mtu < GATT_LOOPBACK_DEFAULT_MTU) mtu = GATT_LOOPBACK_DEFAULT_MTU;
+
+      outbound.push_back(Pdu{GATT_OP_MTU_RSP, (uint8_t)(mtu & 0xFF), (uint8_t)(mtu >> 8)});
+      break;
+    }
+
+    case GATT_OP_WRITE_CMD: {
+      if (pdu.size() < 2) return;
+      writesReceived++;
+      if (lose()) {
+        writesLost++;
+        return;
+      }
+
+      // A real stack truncates writes to MTU - 3
+      size_t length = pdu.size() - 2;
+      if (length > (size_t)mtu - BULK_ATT_OVERHEAD) length = mtu - BULK_ATT_OVERHEAD;
+
+      if (pdu[1] == GATT_HANDLE_COMMAND) {
+        commandBytes.insert(commandBytes.end(), pdu.begin() + 2, pdu.begin() + 2 + length);
+        uint32_t now = nowUs();
+        for (size_t i = 2; i < 2 + length; i++) {
+          if (pdu[i] == '\n') commandStamps.push_back(now);
+        }
+      } else if (pdu[1] == GATT_HANDLE_BULK && bulkReceiver) {
+        uint8_t reply[BULK_ACK_SIZE];
+        size_t replyLength = bulkReceiver->handleFrame(pdu.data() + 2, length, reply);
+        if (replyLength > 0) queueNotify(GATT_HANDLE_BULK, reply, replyLength);
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+void LoopbackGattTransport::queueNotify(uint8_t handle, const uint8_t* data, size_t length) {
+  if (clientFd < 0) return;
+  if (length > (size_t)mtu - BULK_ATT_OVERHEAD) length = mtu - BULK_ATT_OVERHEAD;
+
+  Pdu pdu;
+  pdu.reserve(length + 2);
+  pdu.push_back(GATT_OP_NOTIFY);
+  pdu.push_back(handle);
+  pdu.insert(pdu.end(), data, data + length);
+  outbound.push_back(pdu);
+}
+
+size_t LoopbackGattTransport::read(uint8_t* buffer, size_t capacity) {
+  size_t count = 0;
+  while (count < capacity && !commandBytes.empty()) {
+    buffer[count++] = commandBytes.front();
+    commandBytes.pop_front();
+  }
+  return count;
+}
+
+bool LoopbackGattTransport::takeCommandTimestamp(uint32_t* receivedUs) {
+  if (commandStamps.empty()) return false;
+  *receivedUs = commandStamps.front();
+  commandStamps.pop_front();
+  return true;
+}
+
+void LoopbackGattTransport::sendMessage(const char* message) {
+  queueNotify(GATT_HANDLE_COMMAND, (const uint8_t*)message, strlen(message));
+}
+
+bool LoopbackGattTransport::sendBulk(const uint8_t* data, size_t length) {
+  if (clientFd < 0) return false;
+  queueNotify(GATT_HANDLE_BULK, data, length);
+  return true;
+}
+
+size_t LoopbackGattTransport::formatDiagnostics(char* out, size_t capacity) const {
+  int n = snprintf(out, capacity, "link_interval_ms=%u,mtu=%u,writes=%lu,writes_lost=%lu,notifies=%lu",
+                   (unsigned)link.intervalMs, (unsigned)mtu, writesReceived, writesLost, notificationsSent);
+  if (n < 0) return 0;
+  return (size_t)n < capacity ? (size_t)n : capacity - 1;
+}
+
+void LoopbackGattTransport::closeClient() {
+  if (clientFd >= 0) {
+    close(clientFd);
+    clientFd = -1;
+  }
+  inbound.clear();
+  outbound.clear();
+  commandBytes.clear();
+  commandStamps.clear();
+}
+
+#endif
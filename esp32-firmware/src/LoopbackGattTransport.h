@@ -0,0 +1,103 @@
+#ifndef LOOPBACK_GATT_TRANSPORT_H
+#define LOOPBACK_GATT_TRANSPORT_H
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "Transport.h"
+
+// PDUs on the loopback socket reuse the ATT opcodes they stand in for
+#define GATT_OP_MTU_REQ 0x02      // [op][mtu:u16]
+#define GATT_OP_MTU_RSP 0x03      // [op][mtu:u16]
+#define GATT_OP_WRITE_CMD 0x52    // [op][handle][value...]
+#define GATT_OP_NOTIFY 0x1B       // [op][handle][value...]
+
+#define GATT_HANDLE_COMMAND 1     // CHARACTERISTIC_UUID
+#define GATT_HANDLE_BULK 2        // BULK_CHARACTERISTIC_UUID
+
+#define GATT_LOOPBACK_MAX_MTU 512
+#define GATT_LOOPBACK_DEFAULT_MTU 23
+
+/**
+ * @brief Radio behaviour simulated by LoopbackGattTransport
+ */
+struct GattLinkConfig {
+  uint16_t intervalMs;        // Connection interval; PDUs move only at events
+  uint8_t packetsPerEvent;    // PDUs per direction per connection event
+  uint8_t lossPercent;        // Incoming writes dropped (0-100)
+  uint32_t seed;              // Loss PRNG seed, for reproducible runs
+};
+
+/**
+ * @class LoopbackGattTransport
+ * @brief Host stand-in for the BLE GATT server over a Unix socket
+ *
+ * Each SOCK_SEQPACKET datagram is one ATT-style PDU, so writes and
+ * notifications keep their boundaries like they do over the air. Writes
+ * and notifications are held until the next simulated connection event
+ * and limited per event; incoming writes can be dropped at a configured
+ * rate to exercise bulk-transfer resume.
+ */
+class LoopbackGattTransport : public Transport {
+private:
+  typedef std::vector<uint8_t> Pdu;
+
+  std::string path;
+  GattLinkConfig link;
+  int listenFd;
+  int clientFd;
+  uint16_t mtu;
+  uint32_t rngState;
+  unsigned long connectedAt;
+  unsigned long lastEvent;
+
+  std::deque<Pdu> inbound;
+  std::deque<Pdu> outbound;
+  std::deque<uint8_t> commandBytes;
+  std::deque<uint32_t> commandStamps;   // Delivery time of each queued newline
+  BulkReassembler* bulkReceiver;
+
+  unsigned long writesReceived;
+  unsigned long writesLost;
+  unsigned long notificationsSent;
+
+  unsigned long nowMs() const;
+  uint32_t nowUs() const;
+  bool lose();
+  void receivePdus();
+  void runConnectionEvent();
+  void deliver(const Pdu& pdu);
+  void queueNotify(uint8_t handle, const uint8_t* data, size_t length);
+  void closeClient();
+
+public:
+  LoopbackGattTransport(const char* socketPath, const GattLinkConfig& config);
+  ~LoopbackGattTransport();
+
+  // Transport
+  bool begin(const char* deviceName) override;
+  size_t read(uint8_t* buffer, size_t capacity) override;
+  bool takeCommandTimestamp(uint32_t* receivedUs) override;
+  void sendMessage(const char* message) override;
+  bool isConnected() const override { return clientFd >= 0; }
+  void poll(unsigned long timestamp) override;
+  void setBulkReceiver(BulkReassembler* receiver) override { bulkReceiver = receiver; }
+  bool sendBulk(const uint8_t* data, size_t length) override;
+  uint16_t getMtu() const override { return mtu; }
+  size_t formatDiagnostics(char* out, size_t capacity) const override;
+
+  /**
+   * @brief Change the simulated link at runtime (e.g. a profile switch)
+   */
+  void setLinkConfig(const GattLinkConfig& config) { link = config; }
+
+  unsigned long getWritesReceived() const { return writesReceived; }
+  unsigned long getWritesLost() const { return writesLost; }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+#include "MotorCommitPipeline.h"
+#include "PwmPhase.h"
+#include <string.h>
+#include <driver/ledc.h>
+
+#define PWM_PERIOD_COUNTS (1 << PWM_RESOLUTION)
+
+MotorCommitPipeline::MotorCommitPipeline()
+  : traceRecorder(nullptr), output(nullptr), governor(nullptr), thermal(nullptr)
+  , committedDutySum(0) {}
+
+bool MotorCommitPipeline::begin(const int* pins, int count) {
+  if (output) {
+    return output->begin(count);
+  }
+  
+  for (int i = 0; i < count; i++) {
+    int rc = ledcSetup(i, PWM_FREQUENCY, PWM_RESOLUTION);
+    if (rc < 0) {
+      Serial.printf("ERROR: ledcSetup channel %d failed with code %d\n", i, rc);
+      return false;  // PWM setup failed
+    }
+    ledcAttachPin(pins[i], i);
+#if PWM_STAGGER_PHASES
+    // Arduino gives each channel pair its own timer; hpoints only line up
+    // against each other on a shared counter
+    ledc_bind_channel_timer((ledc_mode_t)(i / 8), (ledc_channel_t)(i % 8), LEDC_TIMER_0);
+#endif
+    ledcWrite(i, 0);
+  }
+  return true;
+}
+
+void MotorCommitPipeline::writeLedc(int channel, uint8_t duty, int count) {
+#if PWM_STAGGER_PHASES
+  // Arduino maps channels 0-7 to the high-speed group and 8-15 to low-speed
+  ledc_mode_t group = (ledc_mode_t)(channel / 8);
+  ledc_channel_t ledcChannel = (ledc_channel_t)(channel % 8);
+  uint16_t hpoint = pwmStaggeredHpoint(channel, count, duty, PWM_PERIOD_COUNTS);
+  ledc_set_duty_with_hpoint(group, ledcChannel, duty, hpoint);
+  ledc_update_duty(group, ledcChannel);  // Latches at the end of the current period
+#else
+  ledcWrite(channel, duty);
+#endif
+}
+
+uint32_t MotorCommitPipeline::commit(uint8_t* frame, uint8_t* committed, int count) {
+  if (thermal) {
+    thermal->limit(frame);
+  }
+  if (governor) {
+    governor->apply(frame, count);
+  }
+  
+  if (output) {
+    // A failed write leaves committed alone so the next commit retries it
+    if (output->commit(frame, committed, count)) {
+      memcpy(committed, frame, count);
+    }
+  } else {
+    for (int i = 0; i < count; i++) {
+      if (frame[i] != committed[i]) {
+        writeLedc(i, frame[i], count);
+        committed[i] = frame[i];
+      }
+    }
+  }
+  uint32_t committedAt = micros();
+  
+  committedDutySum = 0;
+  for (int i = 0; i < count; i++) {
+    committedDutySum += committed[i];
+  }
+  if (thermal) {
+    thermal->update(committed);
+  }
+  if (traceRecorder) {
+    traceRecorder->record(millis(), committed);
+  }
+  return committedAt;
+}
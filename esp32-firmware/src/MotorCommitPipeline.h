@@ -0,0 +1,61 @@
+#ifndef MOTOR_COMMIT_PIPELINE_H
+#define MOTOR_COMMIT_PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "PwmTraceRecorder.h"
+#include "PwmOutput.h"
+#include "PowerGovernor.h"
+#include "ThermalModel.h"
+
+/**
+ * @class MotorCommitPipeline
+ * @brief Takes a rendered duty frame the rest of the way to the motors
+ *
+ * Thermal derating, then the power governor, then the output backend (or
+ * LEDC, writing only channels that changed); the thermal model and the
+ * trace then see what was committed. MotorController and
+ * FixedMotorController only differ in how they render, so both commit
+ * through this.
+ */
+class MotorCommitPipeline {
+private:
+  PwmTraceRecorder* traceRecorder;
+  PwmOutput* output;   // External PWM hardware; nullptr = LEDC on the motor pins
+  PowerGovernor* governor;
+  ThermalModel* thermal;
+  uint32_t committedDutySum;   // Aggregate load of the committed frame
+
+  /**
+   * @brief Write one LEDC channel, staggering its switch-on point
+   */
+  void writeLedc(int channel, uint8_t duty, int count);
+
+public:
+  MotorCommitPipeline();
+
+  /**
+   * @brief Initialize the output backend, or LEDC channels 0..count-1
+   * @param pins GPIO per channel (LEDC only)
+   * @param count Number of channels
+   * @return true if initialization successful
+   */
+  bool begin(const int* pins, int count);
+
+  /**
+   * @brief Limit a rendered frame and write it out
+   * @param frame Rendered duties; limited in place
+   * @param committed Duties last written; updated to what took effect
+   * @param count Number of channels
+   * @return Time the frame took effect (micros)
+   */
+  uint32_t commit(uint8_t* frame, uint8_t* committed, int count);
+
+  void setOutput(PwmOutput* backend) { output = backend; }
+  void setTraceRecorder(PwmTraceRecorder* recorder) { traceRecorder = recorder; }
+  void setGovernor(PowerGovernor* powerGovernor) { governor = powerGovernor; }
+  void setThermalModel(ThermalModel* model) { thermal = model; }
+  uint32_t getCommittedDutySum() const { return committedDutySum; }
+};
+
+#endif
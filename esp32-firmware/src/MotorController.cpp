@@ -1,19 +1,82 @@
 #include "MotorController.h"
 
 MotorController::MotorController(const int* pins, int count, int maxDuty)
-  : motorPins(pins), numMotors(count), maxDutyCycle(maxDuty) {}
+  : motorPins(pins), numMotors(constrain(count, 0, MOTOR_MAX_CHANNELS)), maxDutyCycle(maxDuty)
+  , activeMode(MODE_OFF) {
+  seedRandom(0);
+  resetPatternState();
+  spatial.setLayout(nullptr, numMotors);
+  for (int i = 0; i < MOTOR_MAX_CHANNELS; i++) {
+    frameDuty[i] = 0;
+    committedDuty[i] = 0;
+  }
+}
 
-bool MotorController::begin() {
-  for (int i = 0; i < numMotors; i++) {
-    int rc = ledcSetup(i, PWM_FREQUENCY, PWM_RESOLUTION);
-    if (rc < 0) {
-      Serial.printf("ERROR: ledcSetup channel %d failed with code %d\n", i, rc);
-      return false;  // PWM setup failed
-    }
-    ledcAttachPin(motorPins[i], i);
-    ledcWrite(i, 0);
+int MotorController::getCommittedDuty(int motorIndex) const {
+  if (motorIndex < 0 || motorIndex >= numMotors) return 0;
+  return committedDuty[motorIndex];
+}
+
+int MotorController::getFrameDuty(int motorIndex) const {
+  if (motorIndex < 0 || motorIndex >= numMotors) return 0;
+  return frameDuty[motorIndex];
+}
+
+void MotorController::seedRandom(uint32_t seed) {
+  raindrops.seed(seed);
+}
+
+void MotorController::resetPatternState() {
+  raindrops.reset();
+}
+
+void MotorController::applyMode(MassageMode mode, int intensity, unsigned long timestamp) {
+  if (mode != activeMode) {
+    resetPatternState();
+    activeMode = mode;
+  }
+  
+  switch (mode) {
+    case MODE_OFF:
+      stopAll();
+      break;
+      
+    case MODE_PULSE:
+      applyPulse(intensity, timestamp);
+      break;
+      
+    case MODE_WAVE:
+      applyWave(intensity, timestamp);
+      break;
+      
+    case MODE_CONSTANT:
+      applyConstant(intensity);
+      break;
+      
+    case MODE_HEARTBEAT:
+      applyHeartbeat(intensity, timestamp);
+      break;
+      
+    case MODE_RAINDROPS:
+      applyRaindrops(intensity, timestamp);
+      break;
+      
+    case MODE_SWEEP:
+      applySpatial(SPATIAL_SWEEP, intensity, timestamp);
+      break;
+      
+    case MODE_RIPPLE:
+      applySpatial(SPATIAL_RIPPLE, intensity, timestamp);
+      break;
+      
+    case MODE_SPOT:
+      applySpatial(SPATIAL_SPOT, intensity, timestamp);
+      break;
+      
+    default:
+      stopAll();
+      break;
   }
-  return true;
 }
 
 int MotorController::intensityToDuty(int intensity) {
@@ -24,15 +87,14 @@ int MotorController::intensityToDuty(int intensity) {
 
 void MotorController::setMotor(int motorIndex, int dutyCycle) {
   if (motorIndex >= 0 && motorIndex < numMotors) {
-    dutyCycle = constrain(dutyCycle, 0, maxDutyCycle);
-    ledcWrite(motorIndex, dutyCycle);
+    frameDuty[motorIndex] = constrain(dutyCycle, 0, maxDutyCycle);
   }
 }
 
 void MotorController::setAllMotors(int dutyCycle) {
   dutyCycle = constrain(dutyCycle, 0, maxDutyCycle);
   for (int i = 0; i < numMotors; i++) {
-    ledcWrite(i, dutyCycle);
+    frameDuty[i] = dutyCycle;
   }
 }
 
@@ -99,27 +161,11 @@ void MotorController::applyHeartbeat(int intensity, unsigned long timestamp) {
 }
 
 void MotorController::applyRaindrops(int intensity, unsigned long timestamp) {
-  static unsigned long lastStep = 0;
-  static int activeMotor = -1;
-  static unsigned long dropStart = 0;
-
-  unsigned long step = timestamp / RAINDROP_STEP_MS;
-
-  if (step != lastStep) {
-    lastStep = step;
-    // Decide whether to trigger a new drop this step
-    if (random(100) < RAINDROP_CHANCE_PERCENT) {
-      activeMotor = random(numMotors);
-      dropStart = timestamp;
-    } else {
-      activeMotor = -1;
-    }
-  }
-
-  // Default off
-  for (int i = 0; i < numMotors; i++) setMotor(i, 0);
+  raindrops.render(intensityToDuty(intensity), timestamp, frameDuty, numMotors);
+}
 
-  if (activeMotor >= 0 && (timestamp - dropStart) < RAINDROP_TAP_MS) {
-    setMotor(activeMotor, intensityToDuty(intensity));
-  }
+void MotorController::applySpatial(SpatialShape shape, int intensity, unsigned long timestamp) {
+  // Tables are only rebuilt when the shape changes; rendering never exceeds the duty
+  spatial.select(shape);
+  spatial.render(intensityToDuty(intensity), timestamp, frameDuty);
 }
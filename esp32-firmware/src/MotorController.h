@@ -3,19 +3,34 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "MotorCommitPipeline.h"
+#include "SpatialPattern.h"
+#include "RaindropEngine.h"
 
 /**
  * @class MotorController
  * @brief Manages motor PWM control and intensity mapping
  * 
  * Handles low-level motor operations including PWM setup,
- * duty cycle calculations, and motor state management
+ * duty cycle calculations, and motor state management.
+ * Patterns render into a frame buffer; commitFrame() pushes it through
+ * the MotorCommitPipeline in one step, writing only channels that changed.
+ * On LEDC the channels share one timer and switch on at staggered
+ * points of the period (PWM_STAGGER_PHASES) to flatten supply current.
  */
 class MotorController {
 private:
   const int* motorPins;
   int numMotors;
   int maxDutyCycle;
+  uint8_t frameDuty[MOTOR_MAX_CHANNELS];       // Rendered, not yet committed
+  uint8_t committedDuty[MOTOR_MAX_CHANNELS];   // Last values written to LEDC (8-bit PWM)
+  MotorCommitPipeline pipeline;
+  
+  // Pattern state, kept per controller so rendering is reproducible
+  MassageMode activeMode;   // Pattern state resets when this changes
+  RaindropEngine raindrops;
+  FixedSpatialPatternEngine<MOTOR_MAX_CHANNELS> spatial;
 
   /**
    * @brief Maps intensity percentage to PWM duty cycle
@@ -27,11 +42,90 @@ private:
 public:
   MotorController(const int* pins, int count, int maxDuty);
   
+  /**
+   * @brief Drive an external output backend instead of the LEDC channels
+   *
+   * Must be called before begin().
+   * @param backend Output backend, or nullptr for LEDC
+   */
+  void setOutput(PwmOutput* backend) { pipeline.setOutput(backend); }
+  
+  /**
+   * @brief Set the motors' physical positions for the spatial modes
+   * @param positions (x, y) in mm per motor (must stay valid), or nullptr
+   *                  for motors evenly spaced on a line
+   */
+  void setLayout(const int16_t (*positions)[2]) { spatial.setLayout(positions, numMotors); }
+  
   /**
    * @brief Initialize PWM channels for all motors
    * @return true if initialization successful
    */
-  bool begin();
+  bool begin() { return pipeline.begin(motorPins, numMotors); }
+  
+  /**
+   * @brief Write the rendered frame to the PWM channels
+   * @return Time the frame took effect (micros)
+   */
+  uint32_t commitFrame() { return pipeline.commit(frameDuty, committedDuty, numMotors); }
+  
+  /**
+   * @brief Record every committed frame into a trace
+   * @param recorder Trace recorder, or nullptr to stop tracing
+   */
+  void setTraceRecorder(PwmTraceRecorder* recorder) { pipeline.setTraceRecorder(recorder); }
+  
+  /**
+   * @brief Scale every frame to the governor's power budget before it is committed
+   * @param powerGovernor Governor, or nullptr for no aggregate limit
+   */
+  void setGovernor(PowerGovernor* powerGovernor) { pipeline.setGovernor(powerGovernor); }
+  
+  /**
+   * @brief Derate motors the thermal model finds running hot, and feed it every commit
+   * @param model Thermal model sized for this controller, or nullptr
+   */
+  void setThermalModel(ThermalModel* model) { pipeline.setThermalModel(model); }
+  
+  /**
+   * @brief Get the duty cycle last committed to a motor
+   * @param motorIndex Motor index (0-7)
+   * @return Duty cycle value (0 if out of range)
+   */
+  int getCommittedDuty(int motorIndex) const;
+  
+  /**
+   * @brief Sum of the duties last committed (proportional to motor current)
+   */
+  uint32_t getCommittedDutySum() const { return pipeline.getCommittedDutySum(); }
+  
+  /**
+   * @brief Get the duty cycle rendered for the next commit
+   * @param motorIndex Motor index (0-7)
+   * @return Duty cycle value (0 if out of range)
+   */
+  int getFrameDuty(int motorIndex) const;
+  
+  /**
+   * @brief Seed the PRNG used by random patterns
+   * @param seed Seed value; the same seed reproduces the same output
+   */
+  void seedRandom(uint32_t seed);
+  
+  /**
+   * @brief Forget per-pattern state (e.g. drops still fading)
+   */
+  void resetPatternState();
+  
+  /**
+   * @brief Render the pattern for a mode
+   *
+   * Switching to a different mode resets the pattern state first.
+   * @param mode Massage mode
+   * @param intensity Intensity percentage (0-100)
+   * @param timestamp Current time in milliseconds
+   */
+  void applyMode(MassageMode mode, int intensity, unsigned long timestamp);
   
   /**
    * @brief Set duty cycle for a specific motor
@@ -47,7 +141,7 @@ public:
   void setAllMotors(int dutyCycle);
   
   /**
-   * @brief Turn off all motors
+   * @brief Turn off all motors (takes effect at the next commitFrame)
    */
   void stopAll();
   
@@ -79,11 +173,19 @@ public:
   void applyHeartbeat(int intensity, unsigned long timestamp);
 
   /**
-   * @brief Apply raindrops pattern (random short taps)
+   * @brief Apply raindrops pattern (overlapping random taps)
    * @param intensity Intensity percentage (0-100)
    * @param timestamp Current time in milliseconds
    */
   void applyRaindrops(int intensity, unsigned long timestamp);
+
+  /**
+   * @brief Apply a pattern defined over the motor layout (sweep, ripple, spot)
+   * @param shape Spatial shape
+   * @param intensity Intensity percentage (0-100)
+   * @param timestamp Current time in milliseconds
+   */
+  void applySpatial(SpatialShape shape, int intensity, unsigned long timestamp);
 };
 
 #endif
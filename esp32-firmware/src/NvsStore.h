@@ -0,0 +1,40 @@
+#ifndef NVS_STORE_H
+#define NVS_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @class NvsStore
+ * @brief Small keyed blobs that survive a reset
+ *
+ * Each write replaces one entry atomically: after a power loss the entry
+ * holds either the old or the new value, never a mix.
+ */
+class NvsStore {
+public:
+  virtual ~NvsStore() {}
+
+  /**
+   * @brief Open the store
+   * @return false if the storage is unavailable
+   */
+  virtual bool begin() = 0;
+
+  /**
+   * @brief Read an entry
+   * @param key Entry name (at most 15 characters)
+   * @param data Destination
+   * @param length Expected size of the entry
+   * @return false if the entry is missing or has a different size
+   */
+  virtual bool read(const char* key, void* data, size_t length) = 0;
+
+  /**
+   * @brief Replace an entry
+   * @return false if the write did not complete
+   */
+  virtual bool write(const char* key, const void* data, size_t length) = 0;
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include "OtaUpdater.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define OTA_WORKER_STACK_SIZE 4096
+#define OTA_WORKER_PRIORITY 1
+#define OTA_WORKER_CORE 1
+
+static unsigned long otaMicros() { return micros(); }
+static void otaYield() { vTaskDelay(1); }
+#else
+#include <chrono>
+
+static unsigned long otaMicros() {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+static void otaYield() { std::this_thread::yield(); }
+#endif
+
+OtaUpdater::OtaUpdater(FlashBackend* backend)
+  : flash(backend), queuedBytes(0), flushedBytes(0)
+  , workerStop(false), workerDone(true), writeFailed(false), hashArmed(false)
+  , state(OTA_IDLE), imageSize(0), startMicros(0), refusedWrites(0), flashMicros(0)
+  , durationMs(0), rebootPending(false) {}
+
+void OtaUpdater::setExpectedHash(const uint8_t* digest) {
+  memcpy(expectedHash, digest, SHA256_DIGEST_SIZE);
+  hashArmed = true;
+}
+
+unsigned long OtaUpdater::getThroughput() const {
+  return durationMs > 0 ? imageSize / durationMs : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Flash worker
+
+void OtaUpdater::workerEntry(void* arg) {
+  static_cast<OtaUpdater*>(arg)->workerLoop();
+#ifdef ARDUINO
+  vTaskDelete(NULL);
+#endif
+}
+
+void OtaUpdater::workerLoop() {
+  while (!workerStop) {
+    if (!processPendingSector()) {
+      otaYield();
+    }
+  }
+  workerDone = true;
+}
+
+bool OtaUpdater::startWorker() {
+  workerStop = false;
+  workerDone = false;
+#ifdef ARDUINO
+  BaseType_t rc = xTaskCreatePinnedToCore(workerEntry, "ota_flash", OTA_WORKER_STACK_SIZE,
+                                          this, OTA_WORKER_PRIORITY, NULL, OTA_WORKER_CORE);
+  if (rc != pdPASS) {
+    workerDone = true;
+    return false;
+  }
+  return true;
+#else
+  workerThread = std::thread(workerEntry, this);
+  return true;
+#endif
+}
+
+void OtaUpdater::stopWorker() {
+  workerStop = true;
+#ifdef ARDUINO
+  while (!workerDone) otaYield();
+#else
+  if (workerThread.joinable()) workerThread.join();
+#endif
+}
+
+bool OtaUpdater::processPendingSector() {
+  uint32_t offset = flushedBytes.load(std::memory_order_relaxed);
+  uint32_t queued = queuedBytes.load(std::memory_order_acquire);
+  uint32_t length = imageSize - offset;
+  if (length > FLASH_SECTOR_SIZE) length = FLASH_SECTOR_SIZE;
+  if (length == 0 || queued - offset < length) return false;
+
+  const uint8_t* sector = queue + offset % OTA_QUEUE_SIZE;
+  unsigned long start = otaMicros();
+  if (!writeFailed) {
+    // Erase sector N here while the receiver queues sector N+1
+    if (!flash->eraseSector(offset) || !flash->write(offset, sector, length)) {
+      writeFailed = true;
+    } else {
+      hash.update(sector, length);
+    }
+  }
+  flashMicros += otaMicros() - start;
+
+  flushedBytes.store(offset + length, std::memory_order_release);  // Hand the space back
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Receiver side (bulk transport)
+
+bool OtaUpdater::canAccept(size_t length) {
+  uint32_t pending = queuedBytes.load(std::memory_order_relaxed) -
+                     flushedBytes.load(std::memory_order_acquire);
+  if (pending + length <= OTA_QUEUE_SIZE) return true;
+  refusedWrites++;
+  return false;
+}
+
+bool OtaUpdater::isDrained() {
+  return writeFailed || flushedBytes.load(std::memory_order_acquire) == queuedBytes.load(std::memory_order_relaxed);
+}
+
+bool OtaUpdater::open(uint32_t totalLength) {
+  if (state == OTA_RECEIVING) abort();
+
+  rebootPending = false;
+  if (!hashArmed || totalLength == 0 || !flash->begin(totalLength)) {
+    state = OTA_FAILED;
+    return false;
+  }
+
+  hash.reset();
+  queuedBytes = 0;
+  flushedBytes = 0;
+  writeFailed = false;
+  imageSize = totalLength;
+  refusedWrites = 0;
+  flashMicros = 0;
+  durationMs = 0;
+
+  if (!startWorker()) {
+    flash->abort();
+    state = OTA_FAILED;
+    return false;
+  }
+
+  startMicros = otaMicros();
+  state = OTA_RECEIVING;
+  return true;
+}
+
+bool OtaUpdater::write(uint32_t offset, const uint8_t* data, size_t length) {
+  uint32_t queued = queuedBytes.load(std::memory_order_relaxed);
+  if (state != OTA_RECEIVING || writeFailed || offset != queued || length > imageSize - queued) {
+    return false;
+  }
+  // Never wait here: this runs in the BLE stack's callback
+  uint32_t pending = queued - flushedBytes.load(std::memory_order_acquire);
+  if (pending + length > OTA_QUEUE_SIZE) return false;
+
+  while (length > 0) {
+    size_t at = queued % OTA_QUEUE_SIZE;
+    size_t chunk = OTA_QUEUE_SIZE - at;
+    if (chunk > length) chunk = length;
+
+    memcpy(queue + at, data, chunk);
+    queued += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+  queuedBytes.store(queued, std::memory_order_release);
+  return true;
+}
+
+bool OtaUpdater::commit() {
+  if (state != OTA_RECEIVING) return false;
+  if (queuedBytes.load(std::memory_order_relaxed) != imageSize) {
+    abort();
+    return false;
+  }
+
+  // The bulk transport holds END until isDrained(), so this does not wait there
+  while (!isDrained()) otaYield();
+  stopWorker();
+
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  hash.finish(digest);
+  hashArmed = false;
+
+  if (writeFailed || memcmp(digest, expectedHash, SHA256_DIGEST_SIZE) != 0 || !flash->activate()) {
+    flash->abort();
+    state = OTA_FAILED;
+    return false;
+  }
+
+  durationMs = (otaMicros() - startMicros) / 1000;
+  state = OTA_COMPLETE;
+  rebootPending = true;
+  return true;
+}
+
+void OtaUpdater::abort() {
+  if (state != OTA_RECEIVING) return;
+
+  writeFailed = true;  // Worker skips remaining sectors
+  stopWorker();
+  flash->abort();
+  hashArmed = false;
+  state = OTA_FAILED;
+}
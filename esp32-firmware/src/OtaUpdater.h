@@ -0,0 +1,111 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "BulkTransfer.h"
+#include "FlashBackend.h"
+#include "Sha256.h"
+
+#ifndef ARDUINO
+#include <thread>
+#endif
+
+#define OTA_QUEUE_SECTORS 2
+#define OTA_QUEUE_SIZE (OTA_QUEUE_SECTORS * FLASH_SECTOR_SIZE)
+
+enum OtaState {
+  OTA_IDLE = 0,
+  OTA_RECEIVING = 1,
+  OTA_COMPLETE = 2,     // Image verified and boot slot switched
+  OTA_FAILED = 3
+};
+
+/**
+ * @class OtaUpdater
+ * @brief Streams a firmware image from the bulk transport into flash
+ *
+ * Fragments arrive in the BLE stack's write callback, which must never
+ * wait on flash. write() only copies them into a byte queue and returns;
+ * a worker task erases and writes each sector straight out of the queue
+ * once it is complete, so flash latency overlaps with reception. While
+ * the queue is full, canAccept() refuses the fragment and the bulk
+ * transport answers with BULK_ERR_OFFSET, so the sender resends it later.
+ * The image is hashed by the worker in write order and must match the
+ * SHA-256 armed with setExpectedHash() before the boot slot is switched.
+ */
+class OtaUpdater : public BulkSink {
+private:
+  FlashBackend* flash;
+
+  // Image bytes from the receiver (producer) to the flash worker (consumer).
+  // Image offset n sits at queue[n % OTA_QUEUE_SIZE], so every sector is
+  // contiguous in the queue.
+  uint8_t queue[OTA_QUEUE_SIZE];
+  std::atomic<uint32_t> queuedBytes;    // Image bytes received
+  std::atomic<uint32_t> flushedBytes;   // Image bytes written to flash
+
+  std::atomic<bool> workerStop;
+  std::atomic<bool> workerDone;
+  std::atomic<bool> writeFailed;
+#ifndef ARDUINO
+  std::thread workerThread;
+#endif
+
+  Sha256 hash;
+  uint8_t expectedHash[SHA256_DIGEST_SIZE];
+  bool hashArmed;
+
+  OtaState state;
+  uint32_t imageSize;
+  unsigned long startMicros;
+  unsigned long refusedWrites;
+  unsigned long flashMicros;
+  unsigned long durationMs;
+  bool rebootPending;
+
+  static void workerEntry(void* arg);
+  void workerLoop();
+  bool startWorker();
+  void stopWorker();
+
+public:
+  OtaUpdater(FlashBackend* backend);
+
+  /**
+   * @brief Arm the next OTA transfer with the image's SHA-256
+   * @param digest Expected digest (SHA256_DIGEST_SIZE bytes)
+   */
+  void setExpectedHash(const uint8_t* digest);
+
+  /**
+   * @brief Erase and write one complete sector from the queue (runs on the
+   *        flash worker); the image's last sector may be partial
+   * @return true if a sector was processed
+   */
+  bool processPendingSector();
+
+  // BulkSink
+  bool open(uint32_t totalLength) override;
+  bool canAccept(size_t length) override;
+  bool write(uint32_t offset, const uint8_t* data, size_t length) override;
+  bool isDrained() override;
+  bool commit() override;
+  void abort() override;
+
+  OtaState getState() const { return state; }
+  bool isRebootPending() const { return rebootPending; }
+  uint32_t getImageSize() const { return imageSize; }
+  unsigned long getDurationMs() const { return durationMs; }
+  unsigned long getRefusedWrites() const { return refusedWrites; }
+  unsigned long getFlashMicros() const { return flashMicros; }
+
+  /**
+   * @brief Throughput of the last completed update
+   * @return Bytes per millisecond (~KB/s)
+   */
+  unsigned long getThroughput() const;
+};
+
+#endif
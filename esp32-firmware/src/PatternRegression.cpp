@@ -0,0 +1,137 @@
+#include "PatternRegression.h"
+#include "MotorController.h"
+#include "FixedMotorController.h"
+#include "BulkTransfer.h"
+
+// Rendered with PATTERN_REGRESSION_SEED over PATTERN_REGRESSION_TICKS on
+// MOTOR_LAYOUT_MM (the spatial modes depend on it).
+// Only update these together with an intended change to a pattern.
+static const PatternGolden patternGoldens[] = {
+  {MODE_PULSE,     25,  0x842032FD},
+  {MODE_PULSE,     60,  0xE4DC975A},
+  {MODE_PULSE,     100, 0xA7DE6F68},
+  {MODE_WAVE,      25,  0x4616F73F},
+  {MODE_WAVE,      60,  0x723C3D99},
+  {MODE_WAVE,      100, 0x758F557B},
+  {MODE_CONSTANT,  25,  0xF918BA55},
+  {MODE_CONSTANT,  60,  0x14A915BF},
+  {MODE_CONSTANT,  100, 0xECF91DCB},
+  {MODE_HEARTBEAT, 25,  0xC5E08EFC},
+  {MODE_HEARTBEAT, 60,  0xF71911C6},
+  {MODE_HEARTBEAT, 100, 0x359047C8},
+  {MODE_RAINDROPS, 25,  0x3FB3FFCD},
+  {MODE_RAINDROPS, 60,  0xCD0E7186},
+  {MODE_RAINDROPS, 100, 0xF7CD69B4},
+  {MODE_SWEEP,     25,  0x18B13D9E},
+  {MODE_SWEEP,     60,  0xFB2BCAE1},
+  {MODE_SWEEP,     100, 0x2CEABE50},
+  {MODE_RIPPLE,    25,  0x7F8CD84B},
+  {MODE_RIPPLE,    60,  0x4C45877E},
+  {MODE_RIPPLE,    100, 0x0831220C},
+  {MODE_SPOT,      25,  0xBC8C1666},
+  {MODE_SPOT,      60,  0x3605DB6A},
+  {MODE_SPOT,      100, 0x08EE9E8B},
+};
+
+typedef FixedMotorController<NUM_MOTORS, MAX_DUTY_CYCLE> FixedRenderer;
+
+template <typename Controller>
+static void startRender(Controller& renderer, uint32_t seed) {
+  renderer.seedRandom(seed);
+  renderer.resetPatternState();
+}
+
+template <typename Controller>
+static void renderFrame(Controller& renderer, MassageMode mode, int intensity, int tick, uint8_t* frame) {
+  renderer.applyMode(mode, intensity, (unsigned long)tick * UPDATE_INTERVAL_MS);
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    frame[i] = (uint8_t)renderer.getFrameDuty(i);
+  }
+}
+
+template <typename Controller>
+static uint32_t renderDigest(Controller& renderer, MassageMode mode, int intensity, uint32_t seed, int ticks) {
+  startRender(renderer, seed);
+  
+  uint8_t frame[NUM_MOTORS];
+  uint32_t digest = 0;
+  for (int tick = 0; tick < ticks; tick++) {
+    renderFrame(renderer, mode, intensity, tick, frame);
+    digest = bulkCrc32(digest, frame, sizeof(frame));
+  }
+  return digest;
+}
+
+uint32_t renderPatternDigest(MassageMode mode, int intensity, uint32_t seed, int ticks) {
+  MotorController renderer(MOTOR_PINS, NUM_MOTORS, MAX_DUTY_CYCLE);
+  renderer.setLayout(MOTOR_LAYOUT_MM);
+  return renderDigest(renderer, mode, intensity, seed, ticks);
+}
+
+void renderPatternFrames(MassageMode mode, int intensity, uint32_t seed, int ticks, bool fixed, uint8_t* frames) {
+  if (fixed) {
+    FixedRenderer renderer(MOTOR_PINS);
+    renderer.setLayout(MOTOR_LAYOUT_MM);
+    startRender(renderer, seed);
+    for (int tick = 0; tick < ticks; tick++) renderFrame(renderer, mode, intensity, tick, frames + tick * NUM_MOTORS);
+  } else {
+    MotorController renderer(MOTOR_PINS, NUM_MOTORS, MAX_DUTY_CYCLE);
+    renderer.setLayout(MOTOR_LAYOUT_MM);
+    startRender(renderer, seed);
+    for (int tick = 0; tick < ticks; tick++) renderFrame(renderer, mode, intensity, tick, frames + tick * NUM_MOTORS);
+  }
+}
+
+const PatternGolden* getPatternGoldens(size_t* count) {
+  *count = sizeof(patternGoldens) / sizeof(patternGoldens[0]);
+  return patternGoldens;
+}
+
+// Renders a failed case on both controllers side by side and prints the
+// first duty they disagree on
+static void reportDivergence(FixedRenderer& fixedRenderer, const PatternGolden& golden) {
+  MotorController renderer(MOTOR_PINS, NUM_MOTORS, MAX_DUTY_CYCLE);
+  renderer.setLayout(MOTOR_LAYOUT_MM);
+  startRender(renderer, PATTERN_REGRESSION_SEED);
+  startRender(fixedRenderer, PATTERN_REGRESSION_SEED);
+  
+  uint8_t frame[NUM_MOTORS];
+  uint8_t fixedFrame[NUM_MOTORS];
+  for (int tick = 0; tick < PATTERN_REGRESSION_TICKS; tick++) {
+    renderFrame(renderer, golden.mode, golden.intensity, tick, frame);
+    renderFrame(fixedRenderer, golden.mode, golden.intensity, tick, fixedFrame);
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      if (frame[i] != fixedFrame[i]) {
+        Serial.printf("    tick %d motor %d: runtime %d, fixed %d\n", tick, i, frame[i], fixedFrame[i]);
+        return;
+      }
+    }
+  }
+  Serial.println("    both controllers agree; run test_pattern_regression on the host for the first changed frame");
+}
+
+bool runPatternRegression() {
+  int failures = 0;
+  FixedRenderer fixedRenderer(MOTOR_PINS);
+  fixedRenderer.setLayout(MOTOR_LAYOUT_MM);
+  
+  Serial.println("Pattern regression (mode, intensity, digest, fixed digest, expected, result)");
+  
+  for (const PatternGolden& golden : patternGoldens) {
+    uint32_t digest = renderPatternDigest(golden.mode, golden.intensity,
+                                          PATTERN_REGRESSION_SEED, PATTERN_REGRESSION_TICKS);
+    uint32_t fixedDigest = renderDigest(fixedRenderer, golden.mode, golden.intensity,
+                                        PATTERN_REGRESSION_SEED, PATTERN_REGRESSION_TICKS);
+    bool pass = digest == golden.digest && fixedDigest == golden.digest;
+    if (!pass) failures++;
+    
+    Serial.printf("  %d, %3d, 0x%08lX, 0x%08lX, 0x%08lX, %s\n", (int)golden.mode, golden.intensity,
+                  (unsigned long)digest, (unsigned long)fixedDigest, (unsigned long)golden.digest,
+                  pass ? "PASS" : "FAIL");
+    if (!pass) reportDivergence(fixedRenderer, golden);
+  }
+  
+  Serial.printf("Pattern regression: %d of %d cases failed\n", failures,
+                (int)(sizeof(patternGoldens) / sizeof(patternGoldens[0])));
+  return failures == 0;
+}
@@ -0,0 +1,64 @@
+#ifndef PATTERN_REGRESSION_H
+#define PATTERN_REGRESSION_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define PATTERN_REGRESSION_SEED 0x5EED1234UL
+#define PATTERN_REGRESSION_TICKS 240   // 12 s of engine ticks per case
+
+/**
+ * @brief Checked-in digest of one rendered pattern
+ */
+struct PatternGolden {
+  MassageMode mode;
+  uint8_t intensity;
+  uint32_t digest;   // CRC-32 over every rendered duty frame
+};
+
+/**
+ * @brief Render a mode tick by tick on a detached MotorController laid out
+ * as MOTOR_LAYOUT_MM
+ *
+ * The controller is never started, so nothing reaches the PWM hardware.
+ * @param mode Massage mode
+ * @param intensity Intensity percentage (0-100)
+ * @param seed Pattern PRNG seed
+ * @param ticks Number of UPDATE_INTERVAL_MS ticks to render
+ * @return CRC-32 over the duty frames (one byte per motor per tick)
+ */
+uint32_t renderPatternDigest(MassageMode mode, int intensity, uint32_t seed, int ticks);
+
+/**
+ * @brief Render a mode tick by tick and keep every duty frame
+ * @param mode Massage mode
+ * @param intensity Intensity percentage (0-100)
+ * @param seed Pattern PRNG seed
+ * @param ticks Number of UPDATE_INTERVAL_MS ticks to render
+ * @param fixed Render on FixedMotorController instead of MotorController
+ * @param frames Receives ticks * NUM_MOTORS duties, tick-major
+ */
+void renderPatternFrames(MassageMode mode, int intensity, uint32_t seed, int ticks, bool fixed, uint8_t* frames);
+
+/**
+ * @brief The checked-in golden cases
+ * @param count Receives the number of cases
+ */
+const PatternGolden* getPatternGoldens(size_t* count);
+
+/**
+ * @brief Compare every pattern against its golden trace digest
+ *
+ * Guards rewrites of the pattern code (lookup tables, keyframes, SIMD)
+ * against changing what the user feels. Both MotorController and the
+ * compile-time FixedMotorController must reproduce every digest. Prints one line per case to
+ * Serial, with the rendered digest for updating the table after an
+ * intended change. For a failed case it re-renders both controllers and
+ * prints the first tick and motor where they disagree; if they agree, the
+ * pattern itself changed and the host test (per-frame goldens) shows the
+ * first changed frame.
+ * @return true if every case matched
+ */
+bool runPatternRegression();
+
+#endif
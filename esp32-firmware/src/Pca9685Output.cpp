@@ -0,0 +1,104 @@
+#include "Pca9685Output.h"
+#include <Arduino.h>
+
+Pca9685Output::Pca9685Output(I2cBus* i2c, uint8_t address, uint16_t pwmFrequency)
+  : bus(i2c), baseAddress(address), frequency(pwmFrequency), chips(0)
+  , transactions(0), failedWrites(0) {}
+
+bool Pca9685Output::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+  uint8_t data[2] = {reg, value};
+  transactions++;
+  return bus->write(address, data, sizeof(data));
+}
+
+bool Pca9685Output::begin(int channels) {
+  chips = (channels + PCA9685_CHANNELS - 1) / PCA9685_CHANNELS;
+  if (chips < 1 || chips > PCA9685_MAX_CHIPS) return false;
+
+  // prescale = round(osc / (4096 * f)) - 1, clamped to the chip's 3..255
+  long prescale = (PCA9685_OSCILLATOR_HZ + 2048L * frequency) / (4096L * frequency) - 1;
+  if (prescale < 3) prescale = 3;
+  if (prescale > 255) prescale = 255;
+
+  for (int chip = 0; chip < chips; chip++) {
+    uint8_t address = baseAddress + chip;
+
+    // The prescaler can only be written while the oscillator sleeps
+    if (!writeRegister(address, PCA9685_MODE1, PCA9685_MODE1_SLEEP | PCA9685_MODE1_AI) ||
+        !writeRegister(address, PCA9685_PRE_SCALE, (uint8_t)prescale) ||
+        !writeRegister(address, PCA9685_MODE2, PCA9685_MODE2_OUTDRV) ||
+        !writeRegister(address, PCA9685_MODE1, PCA9685_MODE1_AI)) {
+      return false;
+    }
+
+    // PWM may only be restarted once the oscillator has settled
+    delayMicroseconds(PCA9685_OSCILLATOR_STARTUP_US);
+    if (!writeRegister(address, PCA9685_MODE1, PCA9685_MODE1_AI | PCA9685_MODE1_RESTART)) {
+      return false;
+    }
+
+    // Every channel full off, written per channel so the registers match
+    // the all-zero frame MotorController starts from
+    size_t length = 0;
+    txBuffer[length++] = PCA9685_LED0_ON_L;
+    for (int i = 0; i < PCA9685_CHANNELS; i++) {
+      encodeDuty(0, txBuffer + length);
+      length += 4;
+    }
+    transactions++;
+    if (!bus->write(address, txBuffer, length)) return false;
+  }
+  return true;
+}
+
+void Pca9685Output::encodeDuty(uint8_t duty, uint8_t* out) {
+  out[0] = 0;  // ON at count 0
+  out[1] = 0;
+  if (duty == 0) {
+    out[2] = 0;
+    out[3] = PCA9685_FULL;  // Full off - no glitch pulse
+  } else if (duty == 255) {
+    out[1] = PCA9685_FULL;  // Full on
+    out[2] = 0;
+    out[3] = 0;
+  } else {
+    uint16_t off = ((uint16_t)duty * 4095 + 127) / 255;  // 8-bit to 12-bit
+    out[2] = off & 0xFF;
+    out[3] = off >> 8;
+  }
+}
+
+bool Pca9685Output::commit(const uint8_t* frame, const uint8_t* previous, int channels) {
+  bool ok = true;
+
+  for (int chip = 0; chip < chips; chip++) {
+    int base = chip * PCA9685_CHANNELS;
+    int count = channels - base;
+    if (count > PCA9685_CHANNELS) count = PCA9685_CHANNELS;
+
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < count; i++) {
+      if (frame[base + i] != previous[base + i]) {
+        if (first < 0) first = i;
+        last = i;
+      }
+    }
+    if (first < 0) continue;  // Nothing changed on this chip
+
+    // One auto-increment write: register pointer, then 4 bytes per channel
+    size_t length = 0;
+    txBuffer[length++] = PCA9685_LED0_ON_L + 4 * first;
+    for (int i = first; i <= last; i++) {
+      encodeDuty(frame[base + i], txBuffer + length);
+      length += 4;
+    }
+
+    transactions++;
+    if (!bus->write(baseAddress + chip, txBuffer, length)) {
+      failedWrites++;
+      ok = false;
+    }
+  }
+  return ok;
+}
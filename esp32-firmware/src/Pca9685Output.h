@@ -0,0 +1,69 @@
+#ifndef PCA9685_OUTPUT_H
+#define PCA9685_OUTPUT_H
+
+#include <stdint.h>
+#include "PwmOutput.h"
+#include "I2cBus.h"
+
+#define PCA9685_CHANNELS 16
+#define PCA9685_MAX_CHIPS 4           // Up to 64 motors
+
+// Registers
+#define PCA9685_MODE1 0x00
+#define PCA9685_MODE2 0x01
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_PRE_SCALE 0xFE
+
+#define PCA9685_MODE1_RESTART 0x80
+#define PCA9685_MODE1_SLEEP 0x10
+#define PCA9685_MODE1_AI 0x20         // Register auto-increment
+#define PCA9685_MODE2_OUTDRV 0x04     // Totem-pole outputs for the MOSFET gates
+#define PCA9685_FULL 0x10             // Full-on / full-off bit in ON_H / OFF_H
+
+#define PCA9685_OSCILLATOR_HZ 25000000UL
+#define PCA9685_OSCILLATOR_STARTUP_US 500   // Wake-up time after SLEEP is cleared
+
+/**
+ * @class Pca9685Output
+ * @brief Motor output through one or more PCA9685 16-channel I2C PWM expanders
+ *
+ * Chips sit at consecutive addresses from the base address, 16 motors
+ * each. A commit sends one auto-increment transaction per chip covering
+ * the span from its first to its last changed channel; untouched chips
+ * cost nothing on the bus.
+ */
+class Pca9685Output : public PwmOutput {
+private:
+  I2cBus* bus;
+  uint8_t baseAddress;
+  uint16_t frequency;
+  int chips;
+  uint8_t txBuffer[1 + PCA9685_CHANNELS * 4];
+  unsigned long transactions;
+  unsigned long failedWrites;
+
+  bool writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+
+public:
+  /**
+   * @param i2c Bus the expanders are on
+   * @param address Address of the first chip (0x40 with A0-A5 low)
+   * @param pwmFrequency Output frequency in Hz (24-1526)
+   */
+  Pca9685Output(I2cBus* i2c, uint8_t address, uint16_t pwmFrequency);
+
+  bool begin(int channels) override;
+  bool commit(const uint8_t* frame, const uint8_t* previous, int channels) override;
+
+  /**
+   * @brief Encode an 8-bit duty into LEDn_ON_L..LEDn_OFF_H
+   * @param duty Duty cycle (0-255)
+   * @param out Four register bytes
+   */
+  static void encodeDuty(uint8_t duty, uint8_t* out);
+
+  unsigned long getTransactions() const { return transactions; }
+  unsigned long getFailedWrites() const { return failedWrites; }
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "PowerGovernor.h"
+
+PowerGovernor::PowerGovernor(int channels, int maxDuty, int budgetPercent)
+  : maxFrameSum((uint32_t)channels * maxDuty)
+  , filteredMillivolts(0), limitedFrames(0) {
+  fullBudget = maxFrameSum * budgetPercent / 100;
+  tickBudget = fullBudget;
+  reset();
+}
+
+void PowerGovernor::reset() {
+  for (int i = 0; i < POWER_WINDOW_TICKS; i++) window[i] = 0;
+  windowSum = 0;
+  head = 0;
+  lastScale = POWER_SCALE_ONE;
+}
+
+void PowerGovernor::updateBattery(uint32_t millivolts) {
+  if (filteredMillivolts == 0) {
+    filteredMillivolts = millivolts;
+  } else {
+    filteredMillivolts += ((int32_t)millivolts - (int32_t)filteredMillivolts) / 8;
+  }
+
+  // Linear taper between the two thresholds
+  uint32_t share;
+  if (filteredMillivolts >= POWER_TAPER_START_MV) {
+    share = 100;
+  } else if (filteredMillivolts <= POWER_TAPER_END_MV) {
+    share = POWER_LOW_BATTERY_PERCENT;
+  } else {
+    share = POWER_LOW_BATTERY_PERCENT +
+            (100 - POWER_LOW_BATTERY_PERCENT) * (filteredMillivolts - POWER_TAPER_END_MV) /
+            (POWER_TAPER_START_MV - POWER_TAPER_END_MV);
+  }
+  tickBudget = fullBudget * share / 100;
+}
+
+uint16_t PowerGovernor::apply(uint8_t* frame, int channels) {
+  uint32_t sum = 0;
+  for (int i = 0; i < channels; i++) sum += frame[i];
+
+  // What the window can still take once the oldest frame drops out
+  uint32_t remaining = windowSum - window[head];
+  uint32_t windowBudget = tickBudget * POWER_WINDOW_TICKS;
+  uint32_t allowed = windowBudget > remaining ? windowBudget - remaining : 0;
+  if (allowed < tickBudget) allowed = tickBudget;
+
+  uint16_t scale = POWER_SCALE_ONE;
+  if (sum > allowed) {
+    scale = (uint16_t)(allowed * POWER_SCALE_ONE / sum);
+    sum = 0;
+    for (int i = 0; i < channels; i++) {
+      frame[i] = (uint8_t)((frame[i] * scale) >> 8);
+      sum += frame[i];
+    }
+    limitedFrames++;
+  }
+
+  windowSum = remaining + sum;
+  window[head] = sum;
+  head = (head + 1) % POWER_WINDOW_TICKS;
+  lastScale = scale;
+  return scale;
+}
+
+int PowerGovernor::getBudgetPercent() const {
+  return maxFrameSum > 0 ? (int)(tickBudget * 100 / maxFrameSum) : 0;
+}
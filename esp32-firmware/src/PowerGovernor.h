@@ -0,0 +1,78 @@
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define POWER_SCALE_ONE 256   // Frame scale factor meaning "unchanged"
+
+/**
+ * @class PowerGovernor
+ * @brief Caps the aggregate motor duty over a sliding window
+ *
+ * Every committed frame is charged its duty sum (proportional to the
+ * current it draws for one tick). Over the last POWER_WINDOW_TICKS frames
+ * the average may not exceed the per-tick budget; a frame that would push
+ * it over is scaled down proportionally on every channel, so patterns
+ * keep their shape. A frame may always use one tick's budget, which lets
+ * bursty modes (pulse, heartbeat) run untouched while a sustained high
+ * load (constant at 100%) settles at the budget instead of stepping off.
+ *
+ * The budget shrinks linearly as the filtered battery voltage falls from
+ * POWER_TAPER_START_MV to POWER_TAPER_END_MV, down to
+ * POWER_LOW_BATTERY_PERCENT of the full budget.
+ */
+class PowerGovernor {
+private:
+  uint32_t fullBudget;                    // Per-tick duty sum on a healthy battery
+  uint32_t tickBudget;                    // Per-tick duty sum allowed now
+  uint32_t maxFrameSum;                   // Every channel at its duty limit
+  uint32_t window[POWER_WINDOW_TICKS];    // Duty sums of recent frames
+  uint32_t windowSum;
+  int head;
+  uint32_t filteredMillivolts;            // 0 until the first sample
+  uint16_t lastScale;
+  unsigned long limitedFrames;
+
+public:
+  /**
+   * @param channels Number of motors
+   * @param maxDuty Duty limit of one motor
+   * @param budgetPercent Allowed window average, % of every motor at maxDuty
+   */
+  PowerGovernor(int channels, int maxDuty, int budgetPercent);
+
+  /**
+   * @brief Feed a battery voltage sample (IIR filtered, 1/8 per sample)
+   * @param millivolts Battery voltage
+   */
+  void updateBattery(uint32_t millivolts);
+
+  /**
+   * @brief Scale a frame to fit the budget and charge it to the window
+   * @param frame Duty per motor, scaled in place
+   * @param channels Number of motors
+   * @return Scale applied (POWER_SCALE_ONE = unchanged)
+   */
+  uint16_t apply(uint8_t* frame, int channels);
+
+  /**
+   * @brief Forget the window (e.g. after the motors were stopped for a while)
+   */
+  void reset();
+
+  /**
+   * @brief Current budget as % of every motor at its duty limit
+   */
+  int getBudgetPercent() const;
+
+  /**
+   * @brief Scale applied to the last frame, in %
+   */
+  int getScalePercent() const { return lastScale * 100 / POWER_SCALE_ONE; }
+
+  unsigned long getLimitedFrames() const { return limitedFrames; }
+  uint32_t getFilteredMillivolts() const { return filteredMillivolts; }
+};
+
+#endif
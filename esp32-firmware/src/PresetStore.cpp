@@ -0,0 +1,66 @@
+#include "PresetStore.h"
+#include <stdio.h>
+#include <string.h>
+
+// Layout of one NVS entry; bump PRESET_VERSION when it changes
+struct PresetRecord {
+  uint8_t version;
+  uint8_t mode;
+  uint8_t intensity;
+  uint8_t reserved;
+  uint32_t timerSeconds;
+};
+
+PresetStore::PresetStore(NvsStore* nvs) : store(nvs) {
+  memset(cache, 0, sizeof(cache));
+  for (int i = 0; i < PRESET_SLOTS; i++) occupied[i] = false;
+}
+
+void PresetStore::keyFor(int slot, char* key) {
+  snprintf(key, 12, "preset%d", slot);
+}
+
+int PresetStore::load() {
+  int loaded = 0;
+  char key[12];
+  for (int i = 0; i < PRESET_SLOTS; i++) {
+    PresetRecord record;
+    keyFor(i, key);
+    occupied[i] = store->read(key, &record, sizeof(record)) && record.version == PRESET_VERSION &&
+                  record.mode <= MODE_SPOT && record.intensity <= 100;
+    if (!occupied[i]) continue;
+    cache[i].mode = record.mode;
+    cache[i].intensity = record.intensity;
+    cache[i].timerSeconds = record.timerSeconds;
+    loaded++;
+  }
+  return loaded;
+}
+
+bool PresetStore::save(int slot, const SessionPreset& preset) {
+  if (slot < 0 || slot >= PRESET_SLOTS) return false;
+  if (occupied[slot] && cache[slot].mode == preset.mode && cache[slot].intensity == preset.intensity &&
+      cache[slot].timerSeconds == preset.timerSeconds) {
+    return true;  // Already stored; spare the flash
+  }
+
+  PresetRecord record;
+  memset(&record, 0, sizeof(record));
+  record.version = PRESET_VERSION;
+  record.mode = preset.mode;
+  record.intensity = preset.intensity;
+  record.timerSeconds = preset.timerSeconds;
+
+  char key[12];
+  keyFor(slot, key);
+  if (!store->write(key, &record, sizeof(record))) return false;
+  cache[slot] = preset;
+  occupied[slot] = true;
+  return true;
+}
+
+bool PresetStore::get(int slot, SessionPreset* preset) const {
+  if (slot < 0 || slot >= PRESET_SLOTS || !occupied[slot]) return false;
+  *preset = cache[slot];
+  return true;
+}
@@ -0,0 +1,56 @@
+#ifndef PRESET_STORE_H
+#define PRESET_STORE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "NvsStore.h"
+
+/**
+ * @brief A saved session configuration
+ */
+struct SessionPreset {
+  uint8_t mode;               // MassageMode
+  uint8_t intensity;          // 0-100
+  uint32_t timerSeconds;      // Session timer, 0 = no timer
+};
+
+/**
+ * @class PresetStore
+ * @brief PRESET_SLOTS session presets in NVS with a RAM copy
+ *
+ * All slots are read once at boot; recalling a preset never touches
+ * flash. Storing writes through to NVS (one entry per slot, so a power
+ * loss damages at most the slot being written) and skips the write when
+ * the slot already holds the same preset.
+ */
+class PresetStore {
+private:
+  NvsStore* store;
+  SessionPreset cache[PRESET_SLOTS];
+  bool occupied[PRESET_SLOTS];
+
+  static void keyFor(int slot, char* key);
+
+public:
+  explicit PresetStore(NvsStore* nvs);
+
+  /**
+   * @brief Fill the RAM cache from NVS (boot)
+   * @return Number of slots holding a preset
+   */
+  int load();
+
+  /**
+   * @brief Save a preset to a slot
+   * @return false if the slot is out of range or NVS rejected the write
+   */
+  bool save(int slot, const SessionPreset& preset);
+
+  /**
+   * @brief Read a preset from the cache
+   * @return false if the slot is out of range or empty
+   */
+  bool get(int slot, SessionPreset* preset) const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PWM_OUTPUT_H
+#define PWM_OUTPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @class PwmOutput
+ * @brief Hardware that turns a committed duty frame into motor drive
+ *
+ * MotorController drives the ESP32 LEDC channels itself; an output
+ * backend replaces that path for external PWM hardware (I2C expanders,
+ * shift registers) with more channels than the chip has.
+ */
+class PwmOutput {
+public:
+  virtual ~PwmOutput() {}
+
+  /**
+   * @brief Bring up the hardware with every channel off
+   * @param channels Number of motor channels
+   * @return true if initialization successful
+   */
+  virtual bool begin(int channels) = 0;
+
+  /**
+   * @brief Push a frame to the hardware
+   * @param frame Duty per channel (8-bit)
+   * @param previous Frame committed last time, for sending only what changed
+   * @param channels Number of channels
+   * @return false if the write failed (the frame is retried next commit)
+   */
+  virtual bool commit(const uint8_t* frame, const uint8_t* previous, int channels) = 0;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "PwmPhase.h"
+#include <math.h>
+
+#define PWM_PHASE_MAX_PERIOD 1024
+
+uint16_t pwmStaggeredHpoint(int channel, int channels, uint16_t duty, uint16_t period) {
+  if (channels <= 1 || duty >= period) return 0;
+  // Spread over the window where the whole pulse still fits in the period
+  return (uint16_t)((uint32_t)channel * (period - duty) / (channels - 1));
+}
+
+PwmCurrentStats pwmAggregateCurrent(const uint8_t* duty, const uint16_t* hpoint, int channels,
+                                    uint16_t period, uint16_t motorMilliamps) {
+  PwmCurrentStats stats = {0, 0, 0};
+  if (period == 0 || period > PWM_PHASE_MAX_PERIOD) return stats;
+
+  // Edge counts per slot: +1 where a channel turns on, -1 where it turns off
+  static int16_t edges[PWM_PHASE_MAX_PERIOD + 1];
+  for (int t = 0; t <= period; t++) edges[t] = 0;
+
+  for (int i = 0; i < channels; i++) {
+    uint32_t on = hpoint[i];
+    uint32_t off = on + duty[i];
+    if (off > period) off = period;  // The LEDC does not wrap a pulse
+    if (on >= off) continue;
+    edges[on]++;
+    edges[off]--;
+  }
+
+  int active = 0;
+  uint64_t sumSquares = 0;
+  uint32_t sum = 0;
+  for (int t = 0; t < period; t++) {
+    active += edges[t];
+    uint32_t current = (uint32_t)active * motorMilliamps;
+    if (current > stats.peakMilliamps) stats.peakMilliamps = current;
+    sum += current;
+    sumSquares += (uint64_t)current * current;
+  }
+
+  stats.meanMilliamps = sum / period;
+  stats.rmsMilliamps = (uint32_t)lround(sqrt((double)sumSquares / period));
+  return stats;
+}
@@ -0,0 +1,46 @@
+#ifndef PWM_PHASE_H
+#define PWM_PHASE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Switch-on point that spreads channels evenly across the PWM period
+ *
+ * The LEDC turns a channel off at hpoint + duty without wrapping, so a
+ * pulse can start anywhere in [0, period - duty]; channel i of n starts
+ * at i/(n-1) of that window. Switch-on edges never coincide, and pulses
+ * shorter than half the period overlap far less. Above half the period
+ * every pulse covers the middle of it, so only the edges move.
+ * @param channel Channel index
+ * @param channels Number of channels sharing the supply
+ * @param duty Duty in PWM counts
+ * @param period PWM period in counts (1 << resolution)
+ * @return hpoint in counts
+ */
+uint16_t pwmStaggeredHpoint(int channel, int channels, uint16_t duty, uint16_t period);
+
+// Aggregate supply current over one PWM period
+struct PwmCurrentStats {
+  uint32_t peakMilliamps;
+  uint32_t rmsMilliamps;
+  uint32_t meanMilliamps;
+};
+
+/**
+ * @brief Model the summed motor current over one PWM period
+ *
+ * Each channel draws motorMilliamps from hpoint to hpoint + duty and
+ * nothing otherwise (resistive motors, no inductive smoothing), which
+ * is the worst case for supply ripple. The mean depends only on the
+ * duties; peak and RMS show what a phase schedule buys.
+ * @param duty Duty per channel in counts
+ * @param hpoint Switch-on point per channel in counts
+ * @param channels Number of channels
+ * @param period PWM period in counts (at most 1024)
+ * @param motorMilliamps Current of one motor while driven
+ * @return Peak, RMS and mean current
+ */
+PwmCurrentStats pwmAggregateCurrent(const uint8_t* duty, const uint16_t* hpoint, int channels,
+                                    uint16_t period, uint16_t motorMilliamps);
+
+#endif
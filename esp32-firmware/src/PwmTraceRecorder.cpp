@@ -0,0 +1,260 @@
+#include "PwmTraceRecorder.h"
+#include <string.h>
+
+PwmTraceRecorder::PwmTraceRecorder(uint8_t channelCount)
+  : channels(channelCount > PWM_TRACE_MAX_CHANNELS ? PWM_TRACE_MAX_CHANNELS : channelCount)
+  , paused(false) {
+  clear();
+}
+
+void PwmTraceRecorder::clear() {
+  memset(image, 0, sizeof(image));
+  image[0] = 'P';
+  image[1] = 'T';
+  image[2] = PWM_TRACE_VERSION;
+  image[3] = channels;
+  image[4] = PWM_TRACE_BLOCKS;
+  image[5] = PWM_TRACE_BLOCK_SIZE & 0xFF;
+  image[6] = PWM_TRACE_BLOCK_SIZE >> 8;
+  image[7] = 0;  // Oldest block
+
+  memset(lastDuty, 0, sizeof(lastDuty));
+  currentBlock = 0;
+  blockUsed = 0;
+  lastRecordMs = 0;
+  heldCommits = 0;
+  started = false;
+  framesRecorded = 0;
+  blocksRecycled = 0;
+}
+
+size_t PwmTraceRecorder::varintSize(uint32_t value) {
+  size_t n = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    n++;
+  }
+  return n;
+}
+
+size_t PwmTraceRecorder::tagSize() const {
+  return heldCommits < PWM_TRACE_HELD_ESCAPE ? 1 : 1 + varintSize(heldCommits);
+}
+
+void PwmTraceRecorder::writeTag(uint8_t type) {
+  uint8_t* out = block(currentBlock);
+  if (heldCommits < PWM_TRACE_HELD_ESCAPE) {
+    out[blockUsed++] = (type << 6) | heldCommits;
+  } else {
+    out[blockUsed++] = (type << 6) | PWM_TRACE_HELD_ESCAPE;
+    writeVarint(heldCommits);
+  }
+  heldCommits = 0;
+}
+
+void PwmTraceRecorder::writeVarint(uint32_t value) {
+  uint8_t* out = block(currentBlock);
+  while (value >= 0x80) {
+    out[blockUsed++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  out[blockUsed++] = value;
+}
+
+void PwmTraceRecorder::startBlock(uint32_t timestampMs, const uint8_t* duty) {
+  if (started) {
+    currentBlock = (currentBlock + 1) % PWM_TRACE_BLOCKS;
+    if (currentBlock == image[7]) {
+      // Ring is full - recycle the oldest block
+      image[7] = (image[7] + 1) % PWM_TRACE_BLOCKS;
+      blocksRecycled++;
+    }
+    memset(block(currentBlock), 0, PWM_TRACE_BLOCK_SIZE);
+  }
+  started = true;
+  blockUsed = 0;
+
+  writeTag(PWM_TRACE_RECORD_KEY);
+  uint8_t* out = block(currentBlock);
+  out[blockUsed++] = timestampMs & 0xFF;
+  out[blockUsed++] = (timestampMs >> 8) & 0xFF;
+  out[blockUsed++] = (timestampMs >> 16) & 0xFF;
+  out[blockUsed++] = (timestampMs >> 24) & 0xFF;
+  for (int i = 0; i < channels; i++) {
+    lastDuty[i] = duty[i];
+    out[blockUsed++] = lastDuty[i];
+  }
+  lastRecordMs = timestampMs;
+}
+
+void PwmTraceRecorder::record(uint32_t timestampMs, const uint8_t* duty) {
+  if (paused) return;
+  framesRecorded++;
+
+  if (!started) {
+    startBlock(timestampMs, duty);
+    return;
+  }
+
+  int changed = 0;
+  for (int i = 0; i < channels; i++) {
+    if (duty[i] != lastDuty[i]) changed++;
+  }
+  if (changed == 0) {
+    heldCommits++;
+    return;
+  }
+
+  size_t maskBytes = (channels + 7) / 8;
+  uint32_t dt = timestampMs - lastRecordMs;
+  size_t needed = tagSize() + varintSize(dt) + maskBytes + changed;
+
+  // Keep one zero byte at the end so readers see where the block stops
+  if (blockUsed + needed >= PWM_TRACE_BLOCK_SIZE) {
+    startBlock(timestampMs, duty);
+    return;
+  }
+
+  writeTag(PWM_TRACE_RECORD_CHANGE);
+  writeVarint(dt);
+
+  uint8_t* out = block(currentBlock);
+  uint8_t* mask = out + blockUsed;
+  memset(mask, 0, maskBytes);
+  blockUsed += maskBytes;
+  for (int i = 0; i < channels; i++) {
+    if (duty[i] != lastDuty[i]) {
+      mask[i / 8] |= 1 << (i % 8);
+      lastDuty[i] = duty[i];
+      out[blockUsed++] = lastDuty[i];
+    }
+  }
+  lastRecordMs = timestampMs;
+}
+
+void PwmTraceRecorder::flush(uint32_t timestampMs) {
+  if (!started || heldCommits == 0) return;
+
+  uint32_t dt = timestampMs - lastRecordMs;
+  if (blockUsed + tagSize() + varintSize(dt) >= PWM_TRACE_BLOCK_SIZE) {
+    uint8_t duty[PWM_TRACE_MAX_CHANNELS];
+    memcpy(duty, lastDuty, channels);
+    heldCommits--;                  // The keyframe stands for the last held commit
+    startBlock(timestampMs, duty);
+    return;
+  }
+
+  writeTag(PWM_TRACE_RECORD_HOLD);
+  writeVarint(dt);
+  lastRecordMs = timestampMs;
+}
+
+// ---------------------------------------------------------------------------
+// PwmTraceReader
+
+PwmTraceReader::PwmTraceReader(const uint8_t* data, size_t length)
+  : image(data), imageSize(length), blockCount(0), blockSize(0), oldest(0)
+  , blocksVisited(0), position(0), valid(false) {
+  memset(&state, 0, sizeof(state));
+  if (length < PWM_TRACE_HEADER_SIZE || data[0] != 'P' || data[1] != 'T' ||
+      data[2] != PWM_TRACE_VERSION || data[3] > PWM_TRACE_MAX_CHANNELS) {
+    return;
+  }
+
+  state.channels = data[3];
+  blockCount = data[4];
+  blockSize = data[5] | (data[6] << 8);
+  oldest = data[7];
+  valid = blockCount > 0 && oldest < blockCount &&
+          length >= PWM_TRACE_HEADER_SIZE + (size_t)blockCount * blockSize;
+}
+
+bool PwmTraceReader::readVarint(const uint8_t* blk, uint32_t* value) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (position >= blockSize) return false;
+    uint8_t b = blk[position++];
+    result |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PwmTraceReader::next(PwmTraceFrame* frame) {
+  if (!valid) return false;
+
+  const uint8_t* blk;
+  while (true) {
+    if (blocksVisited >= blockCount) return false;
+    blk = image + PWM_TRACE_HEADER_SIZE + ((oldest + blocksVisited) % blockCount) * blockSize;
+    if (position < blockSize && blk[position] != 0) break;
+
+    // End of this block (or an unused one) - move on
+    blocksVisited++;
+    position = 0;
+  }
+
+  uint8_t tag = blk[position++];
+  uint8_t type = tag >> 6;
+  uint32_t held = tag & PWM_TRACE_HELD_ESCAPE;
+  if (held == PWM_TRACE_HELD_ESCAPE && !readVarint(blk, &held)) {
+    valid = false;
+    return false;
+  }
+
+  uint32_t dt;
+  switch (type) {
+    case PWM_TRACE_RECORD_KEY:
+      if (position + 4 + state.channels > blockSize) {
+        valid = false;
+        return false;
+      }
+      state.timestampMs = (uint32_t)blk[position] | ((uint32_t)blk[position + 1] << 8) |
+                          ((uint32_t)blk[position + 2] << 16) | ((uint32_t)blk[position + 3] << 24);
+      position += 4;
+      memcpy(state.duty, blk + position, state.channels);
+      position += state.channels;
+      break;
+
+    case PWM_TRACE_RECORD_CHANGE: {
+      size_t maskBytes = (state.channels + 7) / 8;
+      if (!readVarint(blk, &dt) || position + maskBytes > blockSize) {
+        valid = false;
+        return false;
+      }
+      const uint8_t* mask = blk + position;
+      position += maskBytes;
+      for (int i = 0; i < state.channels; i++) {
+        if (mask[i / 8] & (1 << (i % 8))) {
+          if (position >= blockSize) {
+            valid = false;
+            return false;
+          }
+          state.duty[i] = blk[position++];
+        }
+      }
+      state.timestampMs += dt;
+      break;
+    }
+
+    case PWM_TRACE_RECORD_HOLD:
+      if (!readVarint(blk, &dt)) {
+        valid = false;
+        return false;
+      }
+      state.timestampMs += dt;
+      break;
+
+    default:
+      valid = false;
+      return false;
+  }
+
+  state.type = type;
+  state.heldCommits = held;
+  *frame = state;
+  return true;
+}
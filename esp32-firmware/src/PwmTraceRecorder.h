@@ -0,0 +1,138 @@
+#ifndef PWM_TRACE_RECORDER_H
+#define PWM_TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PWM_TRACE_BLOCK_SIZE 256
+#define PWM_TRACE_BLOCKS 32             // 8 KB: minutes of wave, far more of steady modes
+#define PWM_TRACE_MAX_CHANNELS 64
+#define PWM_TRACE_HEADER_SIZE 8
+#define PWM_TRACE_IMAGE_SIZE (PWM_TRACE_HEADER_SIZE + PWM_TRACE_BLOCKS * PWM_TRACE_BLOCK_SIZE)
+#define PWM_TRACE_VERSION 1
+
+// Image layout (downloaded as-is):
+//   header: ['P']['T'][version][channels][blockCount][blockSize:u16][oldestBlock]
+//   blocks: blockCount x blockSize bytes, ring order starting at oldestBlock
+//
+// Each block starts with a keyframe so it decodes on its own; the oldest
+// block is recycled when the ring is full. Records inside a block:
+//   tag byte: [type:2][held:6]  held = unchanged commits before this record
+//             (63 = varint follows)
+//   KEY    (1): [timestampMs:u32][duty x channels]
+//   CHANGE (2): [dtMs:varint][changed mask: ceil(channels/8)][duty per set bit]
+//   HOLD   (3): [dtMs:varint]     (flushed before a download)
+//   tag 0x00 ends the block.
+#define PWM_TRACE_RECORD_KEY 1
+#define PWM_TRACE_RECORD_CHANGE 2
+#define PWM_TRACE_RECORD_HOLD 3
+#define PWM_TRACE_HELD_ESCAPE 63
+
+/**
+ * @class PwmTraceRecorder
+ * @brief Circular RAM trace of committed motor duty frames
+ *
+ * Fed from MotorController::commitFrame(). Identical frames only bump a
+ * run counter and changed frames store just the channels that moved, so
+ * steady modes cost nothing and the wave pattern about 7 bytes per step.
+ */
+class PwmTraceRecorder {
+private:
+  uint8_t image[PWM_TRACE_IMAGE_SIZE];
+  uint8_t channels;
+  uint8_t lastDuty[PWM_TRACE_MAX_CHANNELS];
+  uint8_t currentBlock;
+  uint16_t blockUsed;
+  uint32_t lastRecordMs;
+  uint32_t heldCommits;
+  bool started;
+  bool paused;
+  unsigned long framesRecorded;
+  unsigned long blocksRecycled;
+
+  uint8_t* block(uint8_t index) { return image + PWM_TRACE_HEADER_SIZE + index * PWM_TRACE_BLOCK_SIZE; }
+  static size_t varintSize(uint32_t value);
+  size_t tagSize() const;
+  void writeTag(uint8_t type);
+  void writeVarint(uint32_t value);
+  void startBlock(uint32_t timestampMs, const uint8_t* duty);
+
+public:
+  /**
+   * @param channelCount Channels per frame (up to PWM_TRACE_MAX_CHANNELS)
+   */
+  explicit PwmTraceRecorder(uint8_t channelCount);
+
+  /**
+   * @brief Drop all history
+   */
+  void clear();
+
+  /**
+   * @brief Record one committed frame
+   * @param timestampMs Commit time in milliseconds
+   * @param duty Duty cycle per channel
+   */
+  void record(uint32_t timestampMs, const uint8_t* duty);
+
+  /**
+   * @brief Write out the pending run of unchanged frames
+   * @param timestampMs Current time in milliseconds
+   */
+  void flush(uint32_t timestampMs);
+
+  /**
+   * @brief Stop recording (e.g. while the image is being downloaded)
+   */
+  void setPaused(bool pause) { paused = pause; }
+
+  const uint8_t* data() const { return image; }
+  size_t size() const { return sizeof(image); }
+  unsigned long getFramesRecorded() const { return framesRecorded; }
+  unsigned long getBlocksRecycled() const { return blocksRecycled; }
+};
+
+/**
+ * @brief One frame decoded from a trace image
+ */
+struct PwmTraceFrame {
+  uint32_t timestampMs;   // Time of the record that produced this frame
+  uint32_t heldCommits;   // Identical commits between the previous record and this one
+  uint8_t type;           // PWM_TRACE_RECORD_*
+  uint8_t channels;
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS];
+};
+
+/**
+ * @class PwmTraceReader
+ * @brief Walks a trace image oldest to newest (host tools, self-checks)
+ */
+class PwmTraceReader {
+private:
+  const uint8_t* image;
+  size_t imageSize;
+  uint8_t blockCount;
+  uint16_t blockSize;
+  uint8_t oldest;
+  uint8_t blocksVisited;
+  size_t position;        // Within the current block
+  bool valid;
+  PwmTraceFrame state;
+
+  bool readVarint(const uint8_t* blk, uint32_t* value);
+
+public:
+  PwmTraceReader(const uint8_t* data, size_t length);
+
+  bool isValid() const { return valid; }
+  uint8_t getChannels() const { return state.channels; }
+
+  /**
+   * @brief Decode the next record
+   * @param frame Receives the full duty frame after the record
+   * @return false at the end of the trace or on a malformed record
+   */
+  bool next(PwmTraceFrame* frame);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "RaindropEngine.h"
+#include <string.h>
+
+#define RAINDROP_LIFETIME_MS (RAINDROP_ATTACK_MS + RAINDROP_DECAY_MS)
+
+RaindropEngine::RaindropEngine() {
+  seed(0);
+  reset();
+}
+
+void RaindropEngine::seed(uint32_t seed) {
+  rngState = seed ? seed : 0x9E3779B9;  // xorshift must not start at zero
+}
+
+uint32_t RaindropEngine::nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+void RaindropEngine::reset() {
+  for (int i = 0; i < RAINDROP_POOL_SIZE; i++) {
+    pool[i].active = false;
+  }
+  lastStep = 0;
+}
+
+RaindropEngine::Drop* RaindropEngine::allocate() {
+  Drop* oldest = &pool[0];
+  for (int i = 0; i < RAINDROP_POOL_SIZE; i++) {
+    if (!pool[i].active) return &pool[i];
+    if (pool[i].start < oldest->start) oldest = &pool[i];
+  }
+  return oldest;
+}
+
+void RaindropEngine::render(int duty, unsigned long timestamp, uint8_t* frame, int motors) {
+  unsigned long step = timestamp / RAINDROP_STEP_MS;
+
+  if (step != lastStep && motors > 0) {
+    lastStep = step;
+    for (int i = 0; i < RAINDROP_SPAWN_TRIES; i++) {
+      if (nextRandom() % 100 >= RAINDROP_CHANCE_PERCENT) continue;
+      Drop* drop = allocate();
+      drop->start = timestamp;
+      drop->motor = nextRandom() % motors;
+      drop->peak = RAINDROP_MIN_PEAK + nextRandom() % (256 - RAINDROP_MIN_PEAK);
+      drop->active = true;
+    }
+  }
+
+  memset(frame, 0, motors);
+
+  for (int i = 0; i < RAINDROP_POOL_SIZE; i++) {
+    Drop& drop = pool[i];
+    if (!drop.active) continue;
+
+    unsigned long age = timestamp - drop.start;
+    if (age >= RAINDROP_LIFETIME_MS || drop.motor >= motors) {
+      drop.active = false;
+      continue;
+    }
+
+    // Linear attack then linear decay, 0-256
+    uint32_t envelope;
+    if (age < RAINDROP_ATTACK_MS) {
+      envelope = (age + 1) * 256 / RAINDROP_ATTACK_MS;
+    } else {
+      envelope = (RAINDROP_LIFETIME_MS - age) * 256 / RAINDROP_DECAY_MS;
+    }
+
+    uint8_t value = (uint8_t)((uint32_t)duty * drop.peak * envelope >> 16);
+    if (value > frame[drop.motor]) frame[drop.motor] = value;
+  }
+}
+
+int RaindropEngine::getActiveDrops() const {
+  int count = 0;
+  for (int i = 0; i < RAINDROP_POOL_SIZE; i++) {
+    if (pool[i].active) count++;
+  }
+  return count;
+}
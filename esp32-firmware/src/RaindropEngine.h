@@ -0,0 +1,71 @@
+#ifndef RAINDROP_ENGINE_H
+#define RAINDROP_ENGINE_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @class RaindropEngine
+ * @brief Overlapping raindrop taps from a fixed pool
+ *
+ * Every RAINDROP_STEP_MS up to RAINDROP_SPAWN_TRIES drops may land, each
+ * with RAINDROP_CHANCE_PERCENT probability, on a random motor with a random
+ * peak. A drop ramps up over RAINDROP_ATTACK_MS and fades over
+ * RAINDROP_DECAY_MS; where drops overlap on a motor the stronger one wins.
+ * Drops live in a RAINDROP_POOL_SIZE slot pool (no allocation); when it is
+ * full the oldest drop is recycled. The PRNG is per instance, so a seed
+ * replays exactly the same rain.
+ */
+class RaindropEngine {
+private:
+  struct Drop {
+    unsigned long start;
+    uint8_t motor;
+    uint8_t peak;     // Fraction of the pattern duty (255 = full)
+    bool active;
+  };
+
+  Drop pool[RAINDROP_POOL_SIZE];
+  uint32_t rngState;
+  unsigned long lastStep;
+
+  /**
+   * @brief Next PRNG value (xorshift32)
+   */
+  uint32_t nextRandom();
+
+  /**
+   * @brief Free slot, or the oldest drop if every slot is taken
+   */
+  Drop* allocate();
+
+public:
+  RaindropEngine();
+
+  /**
+   * @brief Seed the PRNG; the same seed reproduces the same rain
+   * @param seed Seed value (0 maps to a fixed non-zero seed)
+   */
+  void seed(uint32_t seed);
+
+  /**
+   * @brief Drop every active drop and restart the step clock
+   */
+  void reset();
+
+  /**
+   * @brief Spawn, age and render drops for one frame
+   * @param duty Peak duty cycle of a full-strength drop
+   * @param timestamp Current time in milliseconds
+   * @param frame Receives one duty per motor (fully overwritten)
+   * @param motors Number of motors
+   */
+  void render(int duty, unsigned long timestamp, uint8_t* frame, int motors);
+
+  /**
+   * @brief Drops currently fading in or out
+   */
+  int getActiveDrops() const;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "RuntimePredictor.h"
+
+RuntimePredictor::RuntimePredictor() {
+  reset();
+}
+
+void RuntimePredictor::reset() {
+  for (int i = 0; i < RUNTIME_WINDOW_TICKS; i++) window[i] = 0;
+  windowSum = 0;
+  head = 0;
+  filled = 0;
+}
+
+void RuntimePredictor::record(uint32_t dutySum) {
+  if (dutySum > 0xFFFF) dutySum = 0xFFFF;
+  windowSum += dutySum - window[head];
+  window[head] = (uint16_t)dutySum;
+  head = (head + 1) % RUNTIME_WINDOW_TICKS;
+  if (filled < RUNTIME_WINDOW_TICKS) filled++;
+}
+
+uint32_t RuntimePredictor::getMeanMilliamps() const {
+  uint32_t meanDutySum = filled > 0 ? windowSum / filled : 0;
+  return BatteryEstimator::loadForDutySum(meanDutySum);
+}
+
+int RuntimePredictor::predictMinutes(const BatteryEstimator& battery) const {
+  return battery.predictMinutes(getMeanMilliamps());
+}
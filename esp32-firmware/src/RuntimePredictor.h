@@ -0,0 +1,54 @@
+#ifndef RUNTIME_PREDICTOR_H
+#define RUNTIME_PREDICTOR_H
+
+#include <stdint.h>
+#include "config.h"
+#include "BatteryEstimator.h"
+
+/**
+ * @class RuntimePredictor
+ * @brief Minutes left at the energy draw of the pattern that is running
+ *
+ * Keeps the committed duty sum of the last RUNTIME_WINDOW_TICKS frames in a
+ * ring with a running total, so the mean draw is updated in O(1) per tick
+ * and always spans whole pattern cycles (pulse, heartbeat, sweep...) rather
+ * than the instant the battery happened to be sampled. The window restarts
+ * when the mode or intensity changes, so a new pattern is judged on its own
+ * frames from the first tick.
+ */
+class RuntimePredictor {
+private:
+  uint16_t window[RUNTIME_WINDOW_TICKS];   // Duty sum per frame
+  uint32_t windowSum;
+  int head;
+  int filled;
+
+public:
+  RuntimePredictor();
+
+  /**
+   * @brief Add one committed frame
+   * @param dutySum Sum of the frame's duties
+   */
+  void record(uint32_t dutySum);
+
+  /**
+   * @brief Start over (mode or intensity changed)
+   */
+  void reset();
+
+  /**
+   * @brief Mean battery current of the frames in the window
+   * @return mA including BATTERY_IDLE_MA
+   */
+  uint32_t getMeanMilliamps() const;
+
+  /**
+   * @brief Predicted minutes until the battery is empty
+   * @param battery Estimator providing the state of charge
+   * @return Minutes, or -1 if there is no estimate yet
+   */
+  int predictMinutes(const BatteryEstimator& battery) const;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "SessionCheckpoint.h"
+#include <string.h>
+
+// Layout of the NVS entry; bump the version when it changes
+struct CheckpointRecord {
+  uint8_t version;
+  uint8_t mode;
+  uint8_t intensity;
+  uint8_t reserved;
+  uint16_t playlistPosition;
+  uint16_t reserved2;
+  uint32_t remainingSeconds;
+};
+
+SessionCheckpoint::SessionCheckpoint(NvsStore* nvs)
+  : store(nvs), lastWriteMs(0), written(false), writes(0), failedWrites(0) {
+  memset(&saved, 0, sizeof(saved));  // Nothing stored = session off
+}
+
+bool SessionCheckpoint::restore(SessionSnapshot* snapshot) {
+  CheckpointRecord record;
+  if (!store->read(CHECKPOINT_KEY, &record, sizeof(record))) return false;
+  if (record.version != CHECKPOINT_VERSION || record.mode > MODE_SPOT || record.intensity > 100) {
+    return false;
+  }
+
+  saved.mode = record.mode;
+  saved.intensity = record.intensity;
+  saved.playlistPosition = record.playlistPosition;
+  saved.remainingSeconds = record.remainingSeconds;
+  *snapshot = saved;
+  return true;
+}
+
+bool SessionCheckpoint::differs(const SessionSnapshot& snapshot) const {
+  if (snapshot.mode != saved.mode || snapshot.intensity != saved.intensity ||
+      snapshot.playlistPosition != saved.playlistPosition) {
+    return true;
+  }
+  // Timer started, stopped or extended, or has run down by a step
+  if ((snapshot.remainingSeconds == 0) != (saved.remainingSeconds == 0)) return true;
+  if (snapshot.remainingSeconds > saved.remainingSeconds) return true;
+  return saved.remainingSeconds - snapshot.remainingSeconds >= CHECKPOINT_TIMER_STEP_S;
+}
+
+bool SessionCheckpoint::update(const SessionSnapshot& snapshot, unsigned long nowMs) {
+  if (!differs(snapshot)) return false;
+
+  bool stopping = snapshot.mode == MODE_OFF && saved.mode != MODE_OFF;
+  if (written && !stopping && nowMs - lastWriteMs < CHECKPOINT_MIN_INTERVAL_MS) return false;
+
+  CheckpointRecord record;
+  memset(&record, 0, sizeof(record));
+  record.version = CHECKPOINT_VERSION;
+  record.mode = snapshot.mode;
+  record.intensity = snapshot.intensity;
+  record.playlistPosition = snapshot.playlistPosition;
+  record.remainingSeconds = snapshot.remainingSeconds;
+
+  // A failed write is retried after the interval, not on every tick
+  lastWriteMs = nowMs;
+  written = true;
+  if (!store->write(CHECKPOINT_KEY, &record, sizeof(record))) {
+    failedWrites++;
+    return false;
+  }
+  saved = snapshot;
+  writes++;
+  return true;
+}
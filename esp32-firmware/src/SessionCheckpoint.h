@@ -0,0 +1,63 @@
+#ifndef SESSION_CHECKPOINT_H
+#define SESSION_CHECKPOINT_H
+
+#include <stdint.h>
+#include "config.h"
+#include "NvsStore.h"
+
+/**
+ * @brief Session state worth resuming after a reset
+ */
+struct SessionSnapshot {
+  uint8_t mode;               // MassageMode
+  uint8_t intensity;          // 0-100
+  uint16_t playlistPosition;  // Entry of the playlist being played
+  uint32_t remainingSeconds;  // Session timer, 0 = no timer
+};
+
+/**
+ * @class SessionCheckpoint
+ * @brief Keeps the last session in NVS so a brownout or reset resumes it
+ *
+ * update() runs every tick but only writes when the session differs from
+ * what NVS already holds, and then at most once per
+ * CHECKPOINT_MIN_INTERVAL_MS, so a slider drag costs one write rather than
+ * one per step. A running timer only counts as a change once it has moved
+ * CHECKPOINT_TIMER_STEP_S, so a resumed session may get up to that much
+ * extra time but never less. Stopping is written at once: resuming a
+ * session the user ended is worse than the extra write.
+ */
+class SessionCheckpoint {
+private:
+  NvsStore* store;
+  SessionSnapshot saved;       // What NVS holds
+  unsigned long lastWriteMs;
+  bool written;                // lastWriteMs is valid
+  unsigned long writes;
+  unsigned long failedWrites;
+
+  bool differs(const SessionSnapshot& snapshot) const;
+
+public:
+  explicit SessionCheckpoint(NvsStore* nvs);
+
+  /**
+   * @brief Load the checkpoint (boot)
+   * @param snapshot Receives the stored session
+   * @return false if there is none or it is not valid for this firmware
+   */
+  bool restore(SessionSnapshot* snapshot);
+
+  /**
+   * @brief Write the session if it changed and the write interval allows
+   * @param snapshot Session as it is now
+   * @param nowMs millis()
+   * @return true if NVS was written
+   */
+  bool update(const SessionSnapshot& snapshot, unsigned long nowMs);
+
+  unsigned long getWrites() const { return writes; }
+  unsigned long getFailedWrites() const { return failedWrites; }
+};
+
+#endif
@@ -4,7 +4,22 @@ SessionManager::SessionManager()
   : currentMode(MODE_OFF)
   , currentIntensity(0)
   , timerEndTime(0)
-  , timerActive(false) {}
+  , timerActive(false)
+  , timerDuration(0)
+  , playlistPosition(0)
+  , pending()
+  , updatePending(false)
+  , appliedPreset(-1)
+  , appliedOperations(0)
+  , pendingAckCount(0)
+  , appliedAckCount(0)
+  , appliedUpdates(0)
+  , coalescedUpdates(0)
+  , pendingTrace()
+  , appliedTrace()
+  , appliedTraceReady(false)
+  , batteryEstimator(nullptr)
+  , runtimePredictor(nullptr) {}
 
 void SessionManager::setMode(MassageMode mode) {
   currentMode = mode;
@@ -14,9 +29,98 @@ void SessionManager::setIntensity(int intensity) {
   currentIntensity = constrain(intensity, 0, 100);
 }
 
+void SessionManager::requestUpdate(MassageMode mode, int intensity, const CommandTrace& trace) {
+  SessionUpdate update = {};
+  update.setMode = true;
+  update.mode = mode;
+  update.setIntensity = true;
+  update.intensity = intensity;
+  update.presetSlot = -1;
+  requestTransaction(update, trace);
+}
+
+void SessionManager::requestPreset(int slot, const SessionPreset& preset, const CommandTrace& trace) {
+  SessionUpdate update = {};
+  update.setMode = true;
+  update.mode = (MassageMode)preset.mode;
+  update.setIntensity = true;
+  update.intensity = preset.intensity;
+  update.setTimer = true;
+  update.timerSeconds = preset.timerSeconds;
+  update.presetSlot = slot;
+  requestTransaction(update, trace);
+}
+
+void SessionManager::requestTransaction(const SessionUpdate& update, const CommandTrace& trace) {
+  if (updatePending) {
+    coalescedUpdates++;  // Superseded before it reached the motors
+  } else {
+    pending = SessionUpdate();
+    pending.presetSlot = -1;
+    pendingAckCount = 0;
+  }
+  if (update.setMode) {
+    pending.setMode = true;
+    pending.mode = update.mode;
+  }
+  if (update.setIntensity) {
+    pending.setIntensity = true;
+    pending.intensity = constrain(update.intensity, 0, 100);
+  }
+  if (update.setTimer) {
+    pending.setTimer = true;
+    pending.timerSeconds = update.timerSeconds;
+  }
+  if (update.presetSlot >= 0) pending.presetSlot = update.presetSlot;
+  if (update.operations > 0) pending.operations = update.operations;
+
+  // This request's ack moves behind any of another kind already owed
+  SessionAck ack = update.operations > 0 ? SESSION_ACK_BATCH
+                 : update.presetSlot >= 0 ? SESSION_ACK_PRESET : SESSION_ACK_MODE;
+  int kept = 0;
+  for (int i = 0; i < pendingAckCount; i++) {
+    if (pendingAcks[i] != ack) pendingAcks[kept++] = pendingAcks[i];
+  }
+  pendingAcks[kept] = ack;
+  pendingAckCount = kept + 1;
+  pendingTrace = trace;
+  updatePending = true;
+}
+
+bool SessionManager::commitPendingUpdate() {
+  if (!updatePending) return false;
+  
+  // Everything in the register lands in the same tick
+  if (pending.setMode) currentMode = pending.mode;
+  if (pending.setIntensity) currentIntensity = pending.intensity;
+  if (pending.setTimer) {
+    timerActive = false;
+    startTimer((int)pending.timerSeconds);
+  }
+  appliedPreset = pending.presetSlot;
+  appliedOperations = pending.operations;
+  for (int i = 0; i < pendingAckCount; i++) appliedAcks[i] = pendingAcks[i];
+  appliedAckCount = pendingAckCount;
+  updatePending = false;
+  appliedUpdates++;
+  
+  appliedTrace = pendingTrace;
+  appliedTrace.appliedUs = micros();
+  appliedTraceReady = true;
+  return true;
+}
+
+bool SessionManager::takeAppliedTrace(CommandTrace* trace) {
+  if (!appliedTraceReady) return false;
+  *trace = appliedTrace;
+  appliedTraceReady = false;
+  return true;
+}
+
 void SessionManager::startTimer(int durationSeconds) {
   if (durationSeconds > 0) {
     timerEndTime = millis() + (durationSeconds * 1000UL);
+    timerDuration = durationSeconds;
     timerActive = true;
   }
 }
@@ -33,6 +137,26 @@ void SessionManager::stopSession() {
   currentMode = MODE_OFF;
   currentIntensity = 0;
   timerActive = false;
+  playlistPosition = 0;
+  updatePending = false;  // Don't let a stale update restart the motors
+}
+
+SessionSnapshot SessionManager::getSnapshot() const {
+  SessionSnapshot snapshot;
+  snapshot.mode = (uint8_t)currentMode;
+  snapshot.intensity = (uint8_t)currentIntensity;
+  snapshot.playlistPosition = playlistPosition;
+  // A timer in its last second must not read as "no timer"
+  snapshot.remainingSeconds = timerActive && getTimeRemaining() == 0 ? 1 : getTimeRemaining();
+  return snapshot;
+}
+
+void SessionManager::restoreSnapshot(const SessionSnapshot& snapshot) {
+  currentMode = (MassageMode)snapshot.mode;
+  currentIntensity = constrain((int)snapshot.intensity, 0, 100);
+  playlistPosition = snapshot.playlistPosition;
+  timerActive = false;
+  startTimer((int)snapshot.remainingSeconds);
 }
 
 unsigned long SessionManager::getTimeRemaining() const {
@@ -46,31 +170,28 @@ unsigned long SessionManager::getTimeRemaining() const {
 
 float SessionManager::getBatteryVoltage() const {
   // Read ADC value multiple times for accuracy
-  int adcSum = 0;
+  uint32_t millivoltSum = 0;
   const int numSamples = 10;
   
   for (int i = 0; i < numSamples; i++) {
-    adcSum += analogRead(BATTERY_PIN);
+    millivoltSum += analogReadMilliVolts(BATTERY_PIN);  // eFuse-calibrated
     delay(5);
   }
   
-  int adcValue = adcSum / numSamples;
-  
-  // Convert ADC reading to voltage (with 11db attenuation: 0-3.6V)
-  float voltage = (adcValue / ADC_RESOLUTION) * 3.6;
-  
   // Account for voltage divider
-  voltage *= BATTERY_VOLTAGE_DIVIDER;
+  float voltage = millivoltSum / (float)numSamples / 1000.0 * BATTERY_VOLTAGE_DIVIDER;
   
-  Serial.print("Battery ADC: ");
-  Serial.print(adcValue);
-  Serial.print(" Voltage: ");
+  Serial.print("Battery Voltage: ");
   Serial.println(voltage);
   
   return voltage;
 }
 
 int SessionManager::getBatteryPercentage() const {
+  if (batteryEstimator && batteryEstimator->getPercent() >= 0) {
+    return batteryEstimator->getPercent();
+  }
+  
   float voltage = getBatteryVoltage();
   
   // Clamp voltage to valid range
@@ -88,3 +209,8 @@ int SessionManager::getBatteryPercentage() const {
   
   return batteryPercent;
 }
+
+int SessionManager::getRuntimeMinutes() const {
+  if (!batteryEstimator || !runtimePredictor) return -1;
+  return runtimePredictor->predictMinutes(*batteryEstimator);
+}
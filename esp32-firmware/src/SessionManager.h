@@ -3,6 +3,36 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "LatencyTracker.h"
+#include "BatteryEstimator.h"
+#include "RuntimePredictor.h"
+#include "SessionCheckpoint.h"
+#include "PresetStore.h"
+
+/**
+ * @brief Session fields an update sets; fields not set are left as they are
+ */
+struct SessionUpdate {
+  bool setMode;
+  MassageMode mode;
+  bool setIntensity;
+  int intensity;
+  bool setTimer;
+  unsigned long timerSeconds;   // 0 clears the timer
+  int presetSlot;               // Preset the fields came from, -1 = none
+  int operations;               // Operations of a batch command, 0 = single command
+};
+
+/**
+ * @brief Acknowledgement a request is waiting for
+ */
+enum SessionAck {
+  SESSION_ACK_MODE = 0,     // OK: Mode=...
+  SESSION_ACK_PRESET = 1,   // OK: Preset=...
+  SESSION_ACK_BATCH = 2     // OK: Batch=...
+};
+
+#define SESSION_ACK_KINDS 3
 
 /**
  * @class SessionManager
@@ -16,6 +46,32 @@ private:
   int currentIntensity;
   unsigned long timerEndTime;
   bool timerActive;
+  unsigned long timerDuration;   // Seconds the running timer was started with
+  uint16_t playlistPosition;
+
+  // Latest-value-wins register (per field) for updates from the app
+  SessionUpdate pending;
+  bool updatePending;
+  int appliedPreset;
+  int appliedOperations;
+
+  // Acks owed for the pending and the applied update: one per kind of
+  // request merged into it, in the order their latest request arrived
+  SessionAck pendingAcks[SESSION_ACK_KINDS];
+  int pendingAckCount;
+  SessionAck appliedAcks[SESSION_ACK_KINDS];
+  int appliedAckCount;
+  unsigned long appliedUpdates;
+  unsigned long coalescedUpdates;
+
+  // Latency trace of the pending update and of the last one applied
+  CommandTrace pendingTrace;
+  CommandTrace appliedTrace;
+  bool appliedTraceReady;
+
+  // Load-compensated state of charge; nullptr = direct ADC reading
+  const BatteryEstimator* batteryEstimator;
+  const RuntimePredictor* runtimePredictor;
 
 public:
   SessionManager();
@@ -32,6 +88,56 @@ public:
    */
   void setIntensity(int intensity);
   
+  /**
+   * @brief Queue a mode/intensity update for the next engine tick
+   *
+   * A newer request overwrites one that has not been applied yet, so a
+   * burst of slider updates within one tick is applied only once.
+   * @param mode Requested massage mode
+   * @param intensity Requested intensity percentage (0-100)
+   * @param trace Timestamps the command collected so far
+   */
+  void requestUpdate(MassageMode mode, int intensity, const CommandTrace& trace);
+  
+  /**
+   * @brief Queue a preset for the next engine tick
+   *
+   * Mode, intensity and timer are applied together by the same commit, so
+   * the motors never run the new mode under the old timer.
+   * @param slot Preset slot, reported in the acknowledgement
+   * @param preset Configuration to apply
+   * @param trace Timestamps the command collected so far
+   */
+  void requestPreset(int slot, const SessionPreset& preset, const CommandTrace& trace);
+  
+  /**
+   * @brief Queue a set of field updates to be applied by one commit
+   *
+   * Fields the update sets overwrite those of a pending update; the others
+   * keep their pending values. So do the preset slot and batch size, so a
+   * batch or preset followed by a plain mode change in the same tick is
+   * still acknowledged as such (see getAppliedAck()).
+   * @param update Fields to change
+   * @param trace Timestamps the command collected so far
+   */
+  void requestTransaction(const SessionUpdate& update, const CommandTrace& trace);
+  
+  /**
+   * @brief Apply the pending mode/intensity update, if any
+   * @return true if an update was applied this tick
+   */
+  bool commitPendingUpdate();
+  
+  /**
+   * @brief Take the trace of the update applied by the last commit
+   *
+   * Only the request that won the tick is traced; coalesced ones never
+   * reached the motors.
+   * @param trace Receives the trace
+   * @return false if no applied update is waiting to be measured
+   */
+  bool takeAppliedTrace(CommandTrace* trace);
+  
   /**
    * @brief Start session timer
    * @param durationSeconds Timer duration in seconds
@@ -49,14 +155,55 @@ public:
    */
   void stopSession();
   
+  /**
+   * @brief Session state for the NVS checkpoint
+   */
+  SessionSnapshot getSnapshot() const;
+  
+  /**
+   * @brief Resume a checkpointed session (boot, before the first tick)
+   * @param snapshot Session restored from NVS
+   */
+  void restoreSnapshot(const SessionSnapshot& snapshot);
+  
+  /**
+   * @brief Record which playlist entry is playing, so it is checkpointed
+   * @param position Entry index
+   */
+  void setPlaylistPosition(uint16_t position) { playlistPosition = position; }
+  
   /**
    * @brief Read current battery voltage
+   *
+   * Blocking one-shot reads; only for builds without a BatteryEstimator,
+   * since ADC1 cannot do one-shot reads while continuous mode runs.
    * @return Battery voltage in volts
    */
   float getBatteryVoltage() const;
   
+  /**
+   * @brief Report state of charge from an estimator instead of a direct reading
+   * @param estimator Estimator fed by the main loop, or nullptr
+   */
+  void setBatteryEstimator(const BatteryEstimator* estimator) { batteryEstimator = estimator; }
+  
+  /**
+   * @brief Predict runtime from the energy profile of the running pattern
+   * @param predictor Predictor fed with every committed frame, or nullptr
+   */
+  void setRuntimePredictor(const RuntimePredictor* predictor) { runtimePredictor = predictor; }
+  
+  /**
+   * @brief Minutes the battery lasts at the running pattern's average draw
+   * @return Minutes, or -1 if unknown
+   */
+  int getRuntimeMinutes() const;
+  
   /**
    * @brief Get battery percentage
+   *
+   * Uses the battery estimator once it has a sample, otherwise maps a
+   * fresh ADC reading linearly.
    * @return Battery level as percentage (0-100)
    */
   int getBatteryPercentage() const;
@@ -65,6 +212,21 @@ public:
   MassageMode getMode() const { return currentMode; }
   int getIntensity() const { return currentIntensity; }
   bool isTimerActive() const { return timerActive; }
+  unsigned long getTimerDuration() const { return timerActive ? timerDuration : 0; }
+  int getAppliedPreset() const { return appliedPreset; }   // Slot applied by the last commit, or -1
+  int getAppliedOperations() const { return appliedOperations; }   // Batch size of the last commit, or 0
+  
+  /**
+   * @brief Acks owed for the last commit
+   *
+   * One per kind of request it merged, oldest first. A request followed
+   * in the same tick by another of its kind is acknowledged only once.
+   */
+  int getAppliedAckCount() const { return appliedAckCount; }
+  SessionAck getAppliedAck(int index) const { return appliedAcks[index]; }
+  uint16_t getPlaylistPosition() const { return playlistPosition; }
+  unsigned long getAppliedUpdates() const { return appliedUpdates; }
+  unsigned long getCoalescedUpdates() const { return coalescedUpdates; }
   unsigned long getTimeRemaining() const;
 };
 
@@ -0,0 +1,47 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHA256_DIGEST_SIZE 32
+
+/**
+ * @class Sha256
+ * @brief Incremental SHA-256 used to verify streamed firmware images
+ *
+ * Plain C++ so the OTA pipeline verifies images the same way on the
+ * device and in the host flash stand-in.
+ */
+class Sha256 {
+private:
+  uint32_t state[8];
+  uint8_t block[64];
+  uint64_t totalLength;
+  size_t blockLength;
+
+  void transform(const uint8_t* data);
+
+public:
+  Sha256();
+
+  /**
+   * @brief Reset to the initial hash state
+   */
+  void reset();
+
+  /**
+   * @brief Add bytes to the hash
+   * @param data Input bytes
+   * @param length Number of bytes
+   */
+  void update(const uint8_t* data, size_t length);
+
+  /**
+   * @brief Finish and write the digest
+   * @param digest Output buffer of SHA256_DIGEST_SIZE bytes
+   */
+  void finish(uint8_t* digest);
+};
+
+#endif
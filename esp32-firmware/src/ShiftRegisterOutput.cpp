@@ -0,0 +1,70 @@
+#include "ShiftRegisterOutput.h"
+
+#ifdef ARDUINO
+
+#define SHIFT_REFRESH_TASK_STACK 2048
+#define SHIFT_REFRESH_TASK_PRIORITY 5
+
+ShiftRegisterOutput::ShiftRegisterOutput(int data, int clock, int latch, uint32_t spiClockHz)
+  : host(HSPI_HOST), device(nullptr), refreshTask(nullptr)
+  , dataPin(data), clockPin(clock), latchPin(latch), clockHz(spiClockHz), refreshes(0) {
+  memset(transactions, 0, sizeof(transactions));
+}
+
+bool ShiftRegisterOutput::begin(int channels) {
+  if (!encoder.begin(channels)) return false;
+
+  spi_bus_config_t bus = {};
+  bus.mosi_io_num = dataPin;    // Data 0: SER
+  bus.miso_io_num = latchPin;   // Data 1: RCLK
+  bus.sclk_io_num = clockPin;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = BAM_BUFFER_SIZE;
+  bus.flags = SPICOMMON_BUSFLAG_MASTER | SPICOMMON_BUSFLAG_DUAL;
+  if (spi_bus_initialize(host, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+    Serial.println("ERROR: SPI bus init failed");
+    return false;
+  }
+
+  // No chip select: the latches are in the stream
+  spi_device_interface_config_t config = {};
+  config.mode = 0;
+  config.clock_speed_hz = clockHz;
+  config.spics_io_num = -1;
+  config.flags = SPI_DEVICE_HALFDUPLEX;
+  config.queue_size = SHIFT_TRANSACTIONS_QUEUED;
+  if (spi_bus_add_device(host, &config, &device) != ESP_OK) {
+    Serial.println("ERROR: SPI device init failed");
+    return false;
+  }
+
+  for (int i = 0; i < SHIFT_TRANSACTIONS_QUEUED; i++) {
+    transactions[i].flags = SPI_TRANS_MODE_DIO;
+    transactions[i].length = encoder.streamLength() * 8;
+    transactions[i].tx_buffer = encoder.stream();
+    spi_device_queue_trans(device, &transactions[i], portMAX_DELAY);
+  }
+  xTaskCreatePinnedToCore(refreshLoop, "bam_refresh", SHIFT_REFRESH_TASK_STACK, this,
+                          SHIFT_REFRESH_TASK_PRIORITY, &refreshTask, 0);
+  return true;
+}
+
+void ShiftRegisterOutput::refreshLoop(void* arg) {
+  ShiftRegisterOutput* self = static_cast<ShiftRegisterOutput*>(arg);
+  spi_transaction_t* done;
+
+  for (;;) {
+    if (spi_device_get_trans_result(self->device, &done, portMAX_DELAY) != ESP_OK) continue;
+    self->refreshes += self->encoder.getRepeats();
+    spi_device_queue_trans(self->device, done, portMAX_DELAY);
+  }
+}
+
+bool ShiftRegisterOutput::commit(const uint8_t* frame, const uint8_t* previous, int channels) {
+  // Patched in place; at worst one BAM period mixes old and new planes
+  encoder.update(frame, previous);
+  return true;
+}
+
+#endif
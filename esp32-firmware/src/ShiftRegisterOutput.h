@@ -0,0 +1,61 @@
+#ifndef SHIFT_REGISTER_OUTPUT_H
+#define SHIFT_REGISTER_OUTPUT_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <driver/spi_master.h>
+#include "PwmOutput.h"
+#include "BamEncoder.h"
+
+#define SHIFT_TRANSACTIONS_QUEUED 2   // One sending, one ready for the driver to start
+
+/**
+ * @class ShiftRegisterOutput
+ * @brief Software PWM on chained 74HC595s driven by SPI DMA
+ *
+ * The bus runs half duplex in dual (DIO) mode: MOSI feeds SER, MISO is a
+ * second output carrying RCLK, and SCLK feeds SRCLK. The BAM stream (see
+ * BamEncoder) latches the chain from inside the data, so one transaction
+ * covers whole BAM periods with no gap between planes. Two transactions
+ * over the same buffer stay queued; the driver starts the next one from
+ * its interrupt, and a small task only re-queues the finished one, once
+ * per buffer rather than once per plane. Commits only patch the plane
+ * bits of channels that changed.
+ */
+class ShiftRegisterOutput : public PwmOutput {
+private:
+  BamEncoder encoder;
+  spi_host_device_t host;
+  spi_device_handle_t device;
+  spi_transaction_t transactions[SHIFT_TRANSACTIONS_QUEUED];
+  TaskHandle_t refreshTask;
+  int dataPin;
+  int clockPin;
+  int latchPin;
+  uint32_t clockHz;
+  volatile unsigned long refreshes;
+
+  static void refreshLoop(void* arg);
+
+public:
+  /**
+   * @param data Pin wired to SER of the first register
+   * @param clock Pin wired to SRCLK
+   * @param latch Pin wired to RCLK (driven as the SPI MISO / data 1 line)
+   * @param spiClockHz SPI clock; sets the BAM period with the chain length
+   */
+  ShiftRegisterOutput(int data, int clock, int latch, uint32_t spiClockHz);
+
+  bool begin(int channels) override;
+  bool commit(const uint8_t* frame, const uint8_t* previous, int channels) override;
+
+  /**
+   * @brief BAM periods sent since begin()
+   */
+  unsigned long getRefreshes() const { return refreshes; }
+};
+
+#endif
+
+#endif
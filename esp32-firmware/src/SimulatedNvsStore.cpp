@@ -0,0 +1,32 @@
+#ifndef ARDUINO
+
+#include "SimulatedNvsStore.h"
+#include <string.h>
+
+SimulatedNvsStore::SimulatedNvsStore() : writesBeforeLoss(-1), powered(true), writeCount(0) {}
+
+bool SimulatedNvsStore::read(const char* key, void* data, size_t length) {
+  if (!powered) return false;
+  std::map<std::string, std::vector<uint8_t>>::const_iterator it = entries.find(key);
+  if (it == entries.end() || it->second.size() != length) return false;
+  memcpy(data, it->second.data(), length);
+  return true;
+}
+
+bool SimulatedNvsStore::write(const char* key, const void* data, size_t length) {
+  if (powered && writesBeforeLoss == 0) powered = false;
+  if (!powered) return false;
+  if (writesBeforeLoss > 0) writesBeforeLoss--;
+
+  const uint8_t* bytes = (const uint8_t*)data;
+  entries[key].assign(bytes, bytes + length);
+  writeCount++;
+  return true;
+}
+
+void SimulatedNvsStore::powerCycle() {
+  powered = true;
+  writesBeforeLoss = -1;
+}
+
+#endif
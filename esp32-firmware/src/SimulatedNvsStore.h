@@ -0,0 +1,51 @@
+#ifndef SIMULATED_NVS_STORE_H
+#define SIMULATED_NVS_STORE_H
+
+#ifndef ARDUINO
+
+#include <map>
+#include <string>
+#include <vector>
+#include "NvsStore.h"
+
+/**
+ * @class SimulatedNvsStore
+ * @brief Host stand-in for NVS that can lose power between writes
+ *
+ * After setPowerLossAfter(n) the next n writes land and every later one
+ * is lost, as if the supply collapsed; powerCycle() brings it back with
+ * whatever had been written. Entries are replaced whole, matching the
+ * atomicity of NVS. The write count shows how hard a caller wears flash.
+ */
+class SimulatedNvsStore : public NvsStore {
+private:
+  std::map<std::string, std::vector<uint8_t>> entries;
+  int writesBeforeLoss;   // -1 = never lose power
+  bool powered;
+  unsigned long writeCount;
+
+public:
+  SimulatedNvsStore();
+
+  bool begin() override { return powered; }
+  bool read(const char* key, void* data, size_t length) override;
+  bool write(const char* key, const void* data, size_t length) override;
+
+  /**
+   * @brief Schedule a power loss
+   * @param writes Writes that still complete before the supply drops
+   */
+  void setPowerLossAfter(int writes) { writesBeforeLoss = writes; }
+
+  /**
+   * @brief Restore power; entries written before the loss are kept
+   */
+  void powerCycle();
+
+  bool isPowered() const { return powered; }
+  unsigned long getWriteCount() const { return writeCount; }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef ARDUINO
+
+#include "SocketTransport.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+SocketTransport::SocketTransport(const char* socketPath)
+  : path(socketPath), listenFd(-1), clientFd(-1) {}
+
+SocketTransport::~SocketTransport() {
+  closeClient();
+  if (listenFd >= 0) {
+    close(listenFd);
+    unlink(path.c_str());
+  }
+}
+
+bool SocketTransport::begin(const char* deviceName) {
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path)) return false;
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) return false;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  unlink(path.c_str());
+
+  if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 1) < 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+  printf("%s listening on %s\n", deviceName, path.c_str());
+  return true;
+}
+
+void SocketTransport::poll(unsigned long timestamp) {
+  if (clientFd >= 0 || listenFd < 0) return;
+
+  clientFd = accept(listenFd, nullptr, nullptr);
+  if (clientFd >= 0) {
+    fcntl(clientFd, F_SETFL, O_NONBLOCK);
+  }
+}
+
+size_t SocketTransport::read(uint8_t* buffer, size_t capacity) {
+  if (clientFd < 0) return 0;
+
+  ssize_t n = recv(clientFd, buffer, capacity, 0);
+  if (n > 0) return (size_t)n;
+  if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+    closeClient();  // Peer closed; accept the next one in poll()
+  }
+  return 0;
+}
+
+void SocketTransport::sendMessage(const char* message) {
+  if (clientFd < 0) return;
+
+  if (send(clientFd, message, strlen(message), MSG_NOSIGNAL) < 0 ||
+      send(clientFd, "\n", 1, MSG_NOSIGNAL) < 0) {
+    closeClient();
+  }
+}
+
+void SocketTransport::closeClient() {
+  if (clientFd >= 0) {
+    close(clientFd);
+    clientFd = -1;
+  }
+}
+
+#endif
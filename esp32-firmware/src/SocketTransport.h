@@ -0,0 +1,45 @@
+#ifndef SOCKET_TRANSPORT_H
+#define SOCKET_TRANSPORT_H
+
+#ifndef ARDUINO
+
+#include <string>
+#include "Transport.h"
+
+/**
+ * @class SocketTransport
+ * @brief Host transport over a Unix domain stream socket
+ *
+ * Listens on a socket path and serves one client at a time with the
+ * same line protocol as the serial transports, so the command core can
+ * be driven from a test client on Linux.
+ */
+class SocketTransport : public Transport {
+private:
+  std::string path;
+  int listenFd;
+  int clientFd;
+
+  void closeClient();
+
+public:
+  SocketTransport(const char* socketPath);
+  ~SocketTransport();
+
+  /**
+   * @brief Start listening (deviceName is only logged)
+   */
+  bool begin(const char* deviceName) override;
+  size_t read(uint8_t* buffer, size_t capacity) override;
+  void sendMessage(const char* message) override;
+  bool isConnected() const override { return clientFd >= 0; }
+
+  /**
+   * @brief Accept a pending client if none is connected
+   */
+  void poll(unsigned long timestamp) override;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+#include "SpatialPattern.h"
+#include <math.h>
+
+// Raised-cosine bump over the first half (wide) or quarter (narrow) of a cycle
+static uint8_t wideEnvelope[SPATIAL_ENVELOPE_SIZE];
+static uint8_t narrowEnvelope[SPATIAL_ENVELOPE_SIZE];
+static bool envelopesBuilt = false;
+
+static void buildEnvelope(uint8_t* table, int width) {
+  for (int i = 0; i < SPATIAL_ENVELOPE_SIZE; i++) {
+    if (i < width) {
+      table[i] = (uint8_t)lround(127.5 - 127.5 * cos(2.0 * M_PI * i / width));
+    } else {
+      table[i] = 0;
+    }
+  }
+}
+
+SpatialPatternEngine::SpatialPatternEngine(uint16_t* phases, uint8_t* weights, uint8_t* scaledWeights,
+                                           int tableSize)
+  : layout(nullptr), capacity(tableSize), motorCount(0), shape(SPATIAL_NONE), scaledDuty(-1)
+  , periodMs(1), envelope(wideEnvelope)
+  , phaseOffset(phases), weight(weights), scaledWeight(scaledWeights) {
+  if (!envelopesBuilt) {
+    buildEnvelope(wideEnvelope, SPATIAL_ENVELOPE_SIZE / 2);
+    buildEnvelope(narrowEnvelope, SPATIAL_ENVELOPE_SIZE / 4);
+    envelopesBuilt = true;
+  }
+  for (int i = 0; i < capacity; i++) {
+    phaseOffset[i] = 0;
+    weight[i] = 0;
+    scaledWeight[i] = 0;
+  }
+}
+
+void SpatialPatternEngine::setLayout(const int16_t (*positions)[2], int motors) {
+  layout = positions;
+  motorCount = motors < 0 ? 0 : (motors > capacity ? capacity : motors);
+  if (shape != SPATIAL_NONE) buildTables();
+}
+
+void SpatialPatternEngine::select(SpatialShape newShape) {
+  if (newShape == shape) return;
+  shape = newShape;
+  buildTables();
+}
+
+void SpatialPatternEngine::position(int motor, int32_t* x, int32_t* y) const {
+  if (layout) {
+    *x = layout[motor][0];
+    *y = layout[motor][1];
+  } else {
+    *x = (int32_t)motor * SPATIAL_DEFAULT_PITCH_MM;
+    *y = 0;
+  }
+}
+
+void SpatialPatternEngine::buildTables() {
+  scaledDuty = -1;
+  if (motorCount == 0 || shape == SPATIAL_NONE) return;
+
+  // Centre and extent of the layout
+  int32_t sumX = 0, sumY = 0, minX = INT32_MAX;
+  for (int i = 0; i < motorCount; i++) {
+    int32_t x, y;
+    position(i, &x, &y);
+    sumX += x;
+    sumY += y;
+    if (x < minX) minX = x;
+  }
+  double cx = (double)sumX / motorCount;
+  double cy = (double)sumY / motorCount;
+  double maxRadius = 1.0;
+  for (int i = 0; i < motorCount; i++) {
+    int32_t x, y;
+    position(i, &x, &y);
+    double r = hypot(x - cx, y - cy);
+    if (r > maxRadius) maxRadius = r;
+  }
+
+  switch (shape) {
+    case SPATIAL_SWEEP:
+      periodMs = SPATIAL_SWEEP_PERIOD_MS;
+      envelope = wideEnvelope;
+      break;
+    case SPATIAL_RIPPLE:
+      periodMs = SPATIAL_RIPPLE_PERIOD_MS;
+      envelope = wideEnvelope;
+      break;
+    default:
+      periodMs = SPATIAL_SPOT_PERIOD_MS;
+      envelope = narrowEnvelope;
+      break;
+  }
+
+  // Phases lag with distance (or angle) so the envelope travels outward
+  for (int i = 0; i < motorCount; i++) {
+    int32_t x, y;
+    position(i, &x, &y);
+    double r = hypot(x - cx, y - cy);
+    double cycles;
+
+    switch (shape) {
+      case SPATIAL_SWEEP:
+        cycles = (double)(x - minX) / SPATIAL_WAVELENGTH_MM;
+        weight[i] = 255;
+        break;
+      case SPATIAL_RIPPLE:
+        cycles = r / SPATIAL_WAVELENGTH_MM;
+        weight[i] = (uint8_t)lround(255.0 - 127.0 * r / maxRadius);   // Strongest at the centre
+        break;
+      default:
+        cycles = atan2(y - cy, x - cx) / (2.0 * M_PI);
+        weight[i] = (uint8_t)lround(128.0 + 127.0 * r / maxRadius);   // Strongest on the rim
+        break;
+    }
+
+    phaseOffset[i] = (uint16_t)(-lround(cycles * 65536.0));
+  }
+}
+
+void SpatialPatternEngine::render(int duty, unsigned long timestamp, uint8_t* frame) {
+  if (duty != scaledDuty) {
+    for (int i = 0; i < motorCount; i++) {
+      scaledWeight[i] = (uint8_t)(weight[i] * duty / 255);
+    }
+    scaledDuty = duty;
+  }
+
+  uint16_t cyclePhase = (uint16_t)(((uint32_t)(timestamp % periodMs) << 16) / periodMs);
+  for (int i = 0; i < motorCount; i++) {
+    uint16_t phase = cyclePhase + phaseOffset[i];
+    // +255 makes a full envelope reproduce the scaled weight exactly
+    frame[i] = (uint8_t)((envelope[phase >> 8] * scaledWeight[i] + 255) >> 8);
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef SPATIAL_PATTERN_H
+#define SPATIAL_PATTERN_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define SPATIAL_ENVELOPE_SIZE 256   // Envelope samples per cycle
+#define SPATIAL_DEFAULT_PITCH_MM 30 // Spacing of the fallback layout (motors on a line)
+
+// Shapes a spatial pattern can take; each is defined against motor positions
+enum SpatialShape {
+  SPATIAL_NONE = -1,
+  SPATIAL_SWEEP = 0,    // Band travelling along +x
+  SPATIAL_RIPPLE = 1,   // Rings expanding from the layout centre
+  SPATIAL_SPOT = 2      // Spot circling the layout centre
+};
+
+/**
+ * @class SpatialPatternEngine
+ * @brief Renders patterns defined over the motors' physical positions
+ *
+ * Every shape is a travelling envelope: motor i shows
+ *   duty_i(t) = envelope[(t_phase + phase_i) >> 8] * weight_i
+ * where phase_i (distance along the sweep, distance from the centre, or
+ * angle around it) and weight_i (spatial falloff, scaled by intensity)
+ * are worked out from the layout once, when the layout, shape or
+ * intensity changes. A frame is then one add, one table lookup and one
+ * multiply per motor, independent of the geometry.
+ *
+ * The per-motor tables live in FixedSpatialPatternEngine, sized for the
+ * controller that owns it.
+ */
+class SpatialPatternEngine {
+private:
+  const int16_t (*layout)[2];   // (x, y) in mm per motor; nullptr = on a line
+  int capacity;
+  int motorCount;
+  SpatialShape shape;
+  int scaledDuty;               // Duty the scaled weights were computed for (-1 = stale)
+  uint16_t periodMs;
+  const uint8_t* envelope;
+  uint16_t* phaseOffset;        // Fraction of a cycle (1/65536)
+  uint8_t* weight;              // Spatial falloff (255 = full)
+  uint8_t* scaledWeight;        // weight * duty / 255
+
+  /**
+   * @brief Recompute phase and weight tables for the current shape and layout
+   */
+  void buildTables();
+
+  /**
+   * @brief Position of a motor (falls back to a line along x)
+   */
+  void position(int motor, int32_t* x, int32_t* y) const;
+
+protected:
+  /**
+   * @param phases, weights, scaledWeights Tables of tableSize entries
+   */
+  SpatialPatternEngine(uint16_t* phases, uint8_t* weights, uint8_t* scaledWeights, int tableSize);
+
+public:
+  SpatialPatternEngine(const SpatialPatternEngine&) = delete;
+  SpatialPatternEngine& operator=(const SpatialPatternEngine&) = delete;
+
+  /**
+   * @brief Set the motors' physical positions
+   * @param positions (x, y) in mm per motor (must stay valid), or nullptr
+   *                  for motors spaced SPATIAL_DEFAULT_PITCH_MM apart on a line
+   * @param motors Number of motors (at most the table size)
+   */
+  void setLayout(const int16_t (*positions)[2], int motors);
+
+  /**
+   * @brief Switch shape; tables are rebuilt only if it changed
+   */
+  void select(SpatialShape newShape);
+
+  /**
+   * @brief Render one frame
+   * @param duty Peak duty cycle
+   * @param timestamp Current time in milliseconds
+   * @param frame Receives one duty per motor
+   */
+  void render(int duty, unsigned long timestamp, uint8_t* frame);
+
+  SpatialShape getShape() const { return shape; }
+  uint16_t getPhaseOffset(int motor) const { return phaseOffset[motor]; }
+  uint8_t getWeight(int motor) const { return weight[motor]; }
+};
+
+/**
+ * @class FixedSpatialPatternEngine
+ * @brief SpatialPatternEngine with tables for up to Capacity motors
+ * @tparam Capacity Largest motor count setLayout() accepts
+ */
+template <int Capacity>
+class FixedSpatialPatternEngine : public SpatialPatternEngine {
+  static_assert(Capacity > 0 && Capacity <= MOTOR_MAX_CHANNELS, "Motor count out of range");
+
+private:
+  uint16_t phaseTable[Capacity];
+  uint8_t weightTable[Capacity];
+  uint8_t scaledWeightTable[Capacity];
+
+public:
+  FixedSpatialPatternEngine()
+    : SpatialPatternEngine(phaseTable, weightTable, scaledWeightTable, Capacity) {}
+};
+
+#endif
@@ -0,0 +1,26 @@
+#if defined(ARDUINO) && defined(USE_SPP_TRANSPORT)
+
+#include "SppTransport.h"
+
+bool SppTransport::begin(const char* deviceName) {
+  return serialBT.begin(deviceName);
+}
+
+size_t SppTransport::read(uint8_t* buffer, size_t capacity) {
+  int available = serialBT.available();
+  if (available <= 0) return 0;
+  
+  size_t count = (size_t)available < capacity ? (size_t)available : capacity;
+  return serialBT.readBytes(buffer, count);
+}
+
+void SppTransport::sendMessage(const char* message) {
+  serialBT.write((const uint8_t*)message, strlen(message));
+  serialBT.write('\n');
+}
+
+bool SppTransport::isConnected() const {
+  return serialBT.hasClient();
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SPP_TRANSPORT_H
+#define SPP_TRANSPORT_H
+
+#if defined(ARDUINO) && defined(USE_SPP_TRANSPORT)
+
+#include <BluetoothSerial.h>
+#include "Transport.h"
+
+/**
+ * @class SppTransport
+ * @brief Classic Bluetooth serial (SPP) transport
+ *
+ * Higher sustained throughput than GATT notifications on phones that
+ * support SPP. Responses are newline-terminated lines. There is no
+ * separate bulk channel.
+ */
+class SppTransport : public Transport {
+private:
+  mutable BluetoothSerial serialBT;  // hasClient() is not const
+
+public:
+  bool begin(const char* deviceName) override;
+  size_t read(uint8_t* buffer, size_t capacity) override;
+  void sendMessage(const char* message) override;
+  bool isConnected() const override;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef ARDUINO
+
+#include "SyntheticAdcSource.h"
+
+SyntheticAdcSource::SyntheticAdcSource(uint32_t seed)
+  : pinMillivolts(0), noiseCounts(0), spikePercent(0), spikeCounts(0)
+  , rngState(seed ? seed : 1), pending(0) {}
+
+uint32_t SyntheticAdcSource::nextRandom() {
+  // xorshift32
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+void SyntheticAdcSource::setNoise(uint16_t noise, uint8_t spikeRate, uint16_t spikeSize) {
+  noiseCounts = noise;
+  spikePercent = spikeRate > 100 ? 100 : spikeRate;
+  spikeCounts = spikeSize;
+}
+
+size_t SyntheticAdcSource::read(uint16_t* samples, size_t maxSamples) {
+  size_t count = pending < maxSamples ? pending : maxSamples;
+  pending -= count;
+
+  int32_t ideal = (int32_t)(pinMillivolts * 4095 / SYNTHETIC_ADC_FULL_SCALE_MV);
+  for (size_t i = 0; i < count; i++) {
+    int32_t value = ideal;
+    if (noiseCounts > 0) {
+      int32_t sum = 0;
+      for (int k = 0; k < 4; k++) sum += (int32_t)(nextRandom() % (2 * noiseCounts + 1)) - noiseCounts;
+      value += sum / 4;
+    }
+    if (spikeCounts > 0 && nextRandom() % 100 < spikePercent) {
+      value += (int32_t)(nextRandom() % (2 * spikeCounts + 1)) - spikeCounts;
+    }
+    if (value < 0) value = 0;
+    if (value > 4095) value = 4095;
+    samples[i] = (uint16_t)value;
+  }
+  return count;
+}
+
+uint32_t SyntheticAdcSource::toMillivolts(uint32_t raw) const {
+  return raw * SYNTHETIC_ADC_FULL_SCALE_MV / 4095;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SYNTHETIC_ADC_SOURCE_H
+#define SYNTHETIC_ADC_SOURCE_H
+
+#ifndef ARDUINO
+
+#include "AdcSource.h"
+
+#define SYNTHETIC_ADC_FULL_SCALE_MV 3100   // Pin voltage that reads 4095 (11 dB attenuation)
+
+/**
+ * @class SyntheticAdcSource
+ * @brief Host stand-in for the battery ADC, with configurable noise
+ *
+ * capture() plays the role of the DMA filling its ring between two polls.
+ * Each conversion is the ideal count for the set pin voltage plus roughly
+ * Gaussian noise (sum of four uniform draws) and, at spikePercent, a large
+ * excursion like the ones motor switching couples into the sense line.
+ * The PRNG is seeded so runs are reproducible.
+ */
+class SyntheticAdcSource : public AdcSource {
+private:
+  uint32_t pinMillivolts;
+  uint16_t noiseCounts;
+  uint8_t spikePercent;
+  uint16_t spikeCounts;
+  uint32_t rngState;
+  size_t pending;
+
+  uint32_t nextRandom();
+
+public:
+  explicit SyntheticAdcSource(uint32_t seed);
+
+  /**
+   * @brief Voltage presented to the ADC pin from now on
+   */
+  void setPinMillivolts(uint32_t millivolts) { pinMillivolts = millivolts; }
+
+  /**
+   * @brief Noise model
+   * @param noise Peak of the Gaussian-like noise, in counts
+   * @param spikeRate Percentage of conversions hit by a spike (0-100)
+   * @param spikeSize Peak spike amplitude, in counts (either sign)
+   */
+  void setNoise(uint16_t noise, uint8_t spikeRate, uint16_t spikeSize);
+
+  /**
+   * @brief Make conversions available to the next read()
+   * @param count Number of conversions the DMA would have captured
+   */
+  void capture(size_t count) { pending += count; }
+
+  size_t read(uint16_t* samples, size_t maxSamples) override;
+  uint32_t toMillivolts(uint32_t raw) const override;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+#include "ThermalModel.h"
+
+ThermalModel::ThermalModel(int channelCount, int dutyLimit)
+  : channels(channelCount < 0 ? 0 : (channelCount > MOTOR_MAX_CHANNELS ? MOTOR_MAX_CHANNELS : channelCount))
+  , maxDuty(dutyLimit) {
+  for (int i = 0; i < MOTOR_MAX_CHANNELS; i++) level[i] = 0;
+}
+
+uint8_t ThermalModel::capFor(int channel) const {
+  int over = (int)(level[channel] >> 16) - THERMAL_LIMIT_DUTY;
+  if (over <= 0) return (uint8_t)maxDuty;
+  if (over >= THERMAL_LIMIT_BAND) return THERMAL_MIN_DUTY;
+  return (uint8_t)(maxDuty - (maxDuty - THERMAL_MIN_DUTY) * over / THERMAL_LIMIT_BAND);
+}
+
+int ThermalModel::limit(uint8_t* frame) {
+  int capped = 0;
+  for (int i = 0; i < channels; i++) {
+    if ((int)(level[i] >> 16) <= THERMAL_LIMIT_DUTY) continue;
+    uint8_t cap = capFor(i);
+    if (frame[i] > cap) {
+      frame[i] = cap;
+      capped++;
+    }
+  }
+  return capped;
+}
+
+void ThermalModel::update(const uint8_t* committed) {
+  for (int i = 0; i < channels; i++) {
+    int32_t error = (int32_t)((uint32_t)committed[i] << 16) - (int32_t)level[i];
+    level[i] += error >> THERMAL_TAU_SHIFT;
+  }
+}
+
+int ThermalModel::getLevel(int channel) const {
+  if (channel < 0 || channel >= channels) return 0;
+  return level[channel] >> 16;
+}
+
+int ThermalModel::getHottest() const {
+  int hottest = 0;
+  for (int i = 1; i < channels; i++) {
+    if (level[i] > level[hottest]) hottest = i;
+  }
+  return hottest;
+}
+
+int ThermalModel::getLimitedChannels() const {
+  int count = 0;
+  for (int i = 0; i < channels; i++) {
+    if ((int)(level[i] >> 16) > THERMAL_LIMIT_DUTY) count++;
+  }
+  return count;
+}
@@ -0,0 +1,74 @@
+#ifndef THERMAL_MODEL_H
+#define THERMAL_MODEL_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @class ThermalModel
+ * @brief Per-motor first-order heating model with duty derating
+ *
+ * Each channel keeps an exponential average of its committed duty,
+ *   level += (duty - level) / 2^THERMAL_TAU_SHIFT   (per engine tick)
+ * in 16.16 fixed point, which tracks winding temperature rise for a
+ * motor with a THERMAL_TAU_SHIFT-tick time constant. Once a channel's
+ * level passes THERMAL_LIMIT_DUTY its duty is capped, falling linearly to
+ * THERMAL_MIN_DUTY across THERMAL_LIMIT_BAND, so a motor that has run hot
+ * for minutes settles just above the limit while the others are untouched.
+ * Per tick this is one subtract, shift and add per channel.
+ */
+class ThermalModel {
+private:
+  uint32_t level[MOTOR_MAX_CHANNELS];   // Average duty, 16.16 fixed point
+  int channels;
+  int maxDuty;
+
+  /**
+   * @brief Duty cap for a channel at its current level
+   */
+  uint8_t capFor(int channel) const;
+
+public:
+  /**
+   * @param channelCount Number of motors
+   * @param dutyLimit Duty limit of one motor
+   */
+  ThermalModel(int channelCount, int dutyLimit);
+
+  /**
+   * @brief Cap the duty of channels that run hot
+   * @param frame Duty per motor, limited in place
+   * @return Number of channels that were capped
+   */
+  int limit(uint8_t* frame);
+
+  /**
+   * @brief Advance the model by one tick
+   * @param committed Duty per motor as committed to the hardware
+   */
+  void update(const uint8_t* committed);
+
+  /**
+   * @brief Modelled level of a channel, as the duty it has averaged
+   * @param channel Motor index
+   * @return Level (0-255)
+   */
+  int getLevel(int channel) const;
+
+  /**
+   * @brief Number of motors modelled
+   */
+  int getChannels() const { return channels; }
+
+  /**
+   * @brief Channel with the highest level
+   */
+  int getHottest() const;
+
+  /**
+   * @brief Channels currently above THERMAL_LIMIT_DUTY
+   */
+  int getLimitedChannels() const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "BulkTransfer.h"
+
+/**
+ * @class Transport
+ * @brief Byte-stream link between the app and the command core
+ *
+ * Commands arrive as a stream of bytes (split into lines by the shared
+ * CommandParser); responses go out as whole messages. Transports with a
+ * separate binary channel also carry bulk transfer frames.
+ */
+class Transport {
+public:
+  virtual ~Transport() {}
+
+  /**
+   * @brief Bring up the link
+   * @param deviceName Name to advertise
+   * @return true if initialization successful
+   */
+  virtual bool begin(const char* deviceName) = 0;
+
+  /**
+   * @brief Read received command bytes without blocking
+   * @param buffer Destination
+   * @param capacity Destination size
+   * @return Number of bytes copied (0 if none pending)
+   */
+  virtual size_t read(uint8_t* buffer, size_t capacity) = 0;
+
+  /**
+   * @brief Claim the arrival time of the next command line
+   *
+   * Transports that timestamp writes queue one entry per received
+   * newline; the core claims it as it reads that newline.
+   * @param receivedUs Receives the arrival time in microseconds
+   * @return false if the transport does not timestamp commands
+   */
+  virtual bool takeCommandTimestamp(uint32_t* receivedUs) { return false; }
+
+  /**
+   * @brief Send one response message (the transport adds any framing)
+   * @param message NUL-terminated message
+   */
+  virtual void sendMessage(const char* message) = 0;
+
+  virtual bool isConnected() const = 0;
+
+  /**
+   * @brief Periodic housekeeping (connection parameters, accepting clients)
+   * @param timestamp Current time in milliseconds
+   */
+  virtual void poll(unsigned long timestamp) {}
+
+  /**
+   * @brief Route frames from the bulk channel to a reassembler
+   * @param receiver Reassembler, or nullptr if bulk transfers are not handled
+   */
+  virtual void setBulkReceiver(BulkReassembler* receiver) {}
+
+  /**
+   * @brief Send one frame on the bulk channel
+   * @return false if the transport has no bulk channel or is disconnected
+   */
+  virtual bool sendBulk(const uint8_t* data, size_t length) { return false; }
+
+  /**
+   * @brief ATT MTU for bulk frames (0 if there is no bulk channel)
+   */
+  virtual uint16_t getMtu() const { return 0; }
+
+  /**
+   * @brief Append transport-specific diagnostics as key=value pairs
+   * @param out Destination (NUL-terminated on return)
+   * @param capacity Destination size
+   * @return Number of characters written
+   */
+  virtual size_t formatDiagnostics(char* out, size_t capacity) const {
+    if (capacity > 0) out[0] = '\0';
+    return 0;
+  }
+};
+
+#endif
@@ -0,0 +1,18 @@
+#include "WireI2cBus.h"
+
+#ifdef ARDUINO
+
+WireI2cBus::WireI2cBus(TwoWire* port)
+  : wire(port) {}
+
+bool WireI2cBus::begin(int sda, int scl, uint32_t clockHz) {
+  return wire->begin(sda, scl, clockHz);
+}
+
+bool WireI2cBus::write(uint8_t address, const uint8_t* data, size_t length) {
+  wire->beginTransmission(address);
+  wire->write(data, length);
+  return wire->endTransmission() == 0;
+}
+
+#endif
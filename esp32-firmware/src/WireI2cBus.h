@@ -0,0 +1,34 @@
+#ifndef WIRE_I2C_BUS_H
+#define WIRE_I2C_BUS_H
+
+#ifdef ARDUINO
+
+#include <Wire.h>
+#include "I2cBus.h"
+
+/**
+ * @class WireI2cBus
+ * @brief I2cBus on the ESP32 hardware I2C controller (Arduino Wire)
+ */
+class WireI2cBus : public I2cBus {
+private:
+  TwoWire* wire;
+
+public:
+  explicit WireI2cBus(TwoWire* port = &Wire);
+
+  /**
+   * @brief Start the controller
+   * @param sda SDA pin
+   * @param scl SCL pin
+   * @param clockHz SCL frequency
+   * @return true if initialization successful
+   */
+  bool begin(int sda, int scl, uint32_t clockHz);
+
+  bool write(uint8_t address, const uint8_t* data, size_t length) override;
+};
+
+#endif
+
+#endif
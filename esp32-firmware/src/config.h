@@ -1,6 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+
 // Device Settings
 #define DEVICE_NAME "SMART_MassageMask"
 #define SERIAL_BAUD_RATE 115200
@@ -8,23 +10,87 @@
 // BLE UUIDs (must match React Native app)
 #define SERVICE_UUID        "0000FFE0-0000-1000-8000-00805F9B34FB"
 #define CHARACTERISTIC_UUID "0000FFE1-0000-1000-8000-00805F9B34FB"
+#define BULK_CHARACTERISTIC_UUID "0000FFE2-0000-1000-8000-00805F9B34FB"  // Fragmented binary transfers
+#define BLE_DEFAULT_MTU 23           // ATT MTU before the central negotiates
+#define BLE_MAX_MTU 512              // Largest MTU the device offers
+#define BULK_SCRATCH_SIZE 4096       // RAM destination for BULK_TARGET_SCRATCH
+
+// BLE Connection Parameter Profiles (interval in 1.25ms units, timeout in 10ms units)
+#define CONN_LOW_LATENCY_MIN_INTERVAL 0x06   // 7.5ms - streaming / actively adjusting
+#define CONN_LOW_LATENCY_MAX_INTERVAL 0x0C   // 15ms
+#define CONN_LOW_LATENCY_SLAVE_LATENCY 0
+#define CONN_LOW_LATENCY_TIMEOUT 400         // 4s supervision timeout
+#define CONN_POWER_SAVE_MIN_INTERVAL 0x50    // 100ms - steady session
+#define CONN_POWER_SAVE_MAX_INTERVAL 0x78    // 150ms
+#define CONN_POWER_SAVE_SLAVE_LATENCY 4      // May skip up to 4 connection events
+#define CONN_POWER_SAVE_TIMEOUT 600          // 6s supervision timeout
+#define CONN_IDLE_TIMEOUT_MS 5000            // Drop to power-save after this long without traffic
 
 // Motor Configuration
 #define NUM_MOTORS 8
 const int MOTOR_PINS[NUM_MOTORS] = {18, 19, 21, 22, 23, 25, 26, 27};
+#define MOTOR_MAX_CHANNELS 256      // Frame capacity of a MotorController (larger sheet variants)
+
+// Motor positions on the mask in mm (x to the wearer's right, y up, origin
+// between the eyes). Spatial modes are defined against this table.
+const int16_t MOTOR_LAYOUT_MM[NUM_MOTORS][2] = {
+  {-105, 20}, {-75, 5}, {-45, -5}, {-15, -10}, {15, -10}, {45, -5}, {75, 5}, {105, 20}
+};
+
+// PCA9685 I2C PWM expanders (builds with USE_PCA9685_OUTPUT)
+#define PCA9685_BASE_ADDRESS 0x40
+#define PCA9685_PWM_FREQUENCY 1526  // Highest the PCA9685 prescaler allows
+#define I2C_SDA_PIN 32
+#define I2C_SCL_PIN 33
+#define I2C_CLOCK_HZ 1000000        // Fast-mode Plus
+
+// 74HC595 shift-register chain (builds with USE_SHIFT_REGISTER_OUTPUT)
+#define SHIFT_DATA_PIN 13           // SER (HSPI MOSI)
+#define SHIFT_CLOCK_PIN 14          // SRCLK (HSPI SCLK)
+#define SHIFT_LATCH_PIN 15          // RCLK (HSPI MISO, driven as data line 1)
+#define SHIFT_SPI_CLOCK_HZ 10000000 // 128 motors refresh at ~300 Hz
 
 // Battery Monitoring
 #define BATTERY_PIN 34              // ADC1_CH6 (GPIO34) for battery voltage
 #define BATTERY_VOLTAGE_DIVIDER 2.0 // Voltage divider ratio (R1=R2)
 #define BATTERY_MIN_VOLTAGE 3.0     // Minimum battery voltage (3.0V for LiFePO4/Li-ion)
 #define BATTERY_MAX_VOLTAGE 4.2     // Maximum battery voltage (4.2V for Li-ion, 3.65V for LiFePO4)
-#define ADC_RESOLUTION 4095.0       // 12-bit ADC resolution
 #define ADC_REFERENCE_VOLTAGE 3.3   // ESP32 ADC reference voltage
+#define BATTERY_CAPACITY_MAH 1000           // Rated cell capacity
+#define BATTERY_INTERNAL_RESISTANCE_MOHM 150 // Cell + wiring, for sag compensation
+#define BATTERY_IDLE_MA 60                  // ESP32 + BLE with the motors off
+#define BATTERY_FILTER_SAMPLES 16           // IIR length of the SoC filter (samples)
+#define BATTERY_SOC_HYSTERESIS 5            // % the estimate must rise before the reading does
+#define RUNTIME_WINDOW_TICKS 400            // Energy profile window, 20s at UPDATE_INTERVAL_MS
+#define BATTERY_ADC_CHANNEL 6               // ADC1 channel of BATTERY_PIN
+#define BATTERY_ADC_SAMPLE_HZ 20000         // Continuous-mode rate (lowest the ESP32 DMA supports)
+#define BATTERY_ADC_FRAME_BYTES 256         // DMA conversion frame (2 bytes per conversion)
+#define BATTERY_ADC_BUFFER_BYTES 4096       // DMA ring, > one tick of conversions
+#define BATTERY_ADC_READ_SAMPLES 128        // Conversions copied out per read
+#define BATTERY_ADC_OVERSAMPLE 64           // Conversions averaged per block
+#define BATTERY_ADC_MEDIAN_BLOCKS 9         // Latest block means the tick median is taken over
+#define BATTERY_ADC_DEFAULT_VREF_MV 1100    // Used when the eFuse holds no calibration
+
+// Power budget governor (see PowerGovernor.h)
+#define POWER_WINDOW_TICKS 20             // Sliding window, 1s at UPDATE_INTERVAL_MS
+#define POWER_BUDGET_PERCENT 75           // Window-average aggregate duty, % of all motors at MAX_DUTY_CYCLE
+#define POWER_TAPER_START_MV 3700         // Filtered battery voltage where the budget starts shrinking
+#define POWER_TAPER_END_MV 3300           // ...and where it bottoms out
+#define POWER_LOW_BATTERY_PERCENT 50      // Share of the budget left on a nearly empty battery
+#define POWER_BATTERY_SAMPLE_MS 1000      // Battery sampling interval for the governor
+
+// Per-motor thermal model (see ThermalModel.h)
+#define THERMAL_TAU_SHIFT 12              // Time constant 2^12 ticks (~3.4 min at UPDATE_INTERVAL_MS)
+#define THERMAL_LIMIT_DUTY 140            // Averaged duty above which a motor is derated
+#define THERMAL_LIMIT_BAND 16             // Averaged duty span over which the cap falls
+#define THERMAL_MIN_DUTY 64               // Cap at the top of the band
 
 // PWM Settings
 #define PWM_FREQUENCY 5000
 #define PWM_RESOLUTION 8
 #define MAX_DUTY_CYCLE 178  // 70% of 255 for safety
+#define PWM_STAGGER_PHASES 1  // Spread LEDC switch-on edges across the period (0 = all at once)
+#define MOTOR_CURRENT_MA 90   // Draw of one driven motor, for the supply current model
 
 // Timing Configuration
 #define UPDATE_INTERVAL_MS 50
@@ -40,13 +106,62 @@ const int MOTOR_PINS[NUM_MOTORS] = {18, 19, 21, 22, 23, 25, 26, 27};
 
 // Raindrops pattern timing
 #define RAINDROP_STEP_MS 150
-#define RAINDROP_TAP_MS 80
-#define RAINDROP_CHANCE_PERCENT 30  // 30% chance of a drop each step
+#define RAINDROP_CHANCE_PERCENT 30  // 30% chance per try of a drop each step
+#define RAINDROP_SPAWN_TRIES 2      // Up to 2 new drops per step
+#define RAINDROP_POOL_SIZE 6        // Concurrent drops; the oldest is recycled when full
+#define RAINDROP_ATTACK_MS 60
+#define RAINDROP_DECAY_MS 240
+#define RAINDROP_MIN_PEAK 160       // Drop strength varies from 160/255 to full
+
+// Spatial pattern timing (see SpatialPattern.h)
+#define SPATIAL_WAVELENGTH_MM 120   // Distance between successive sweep bands / ripple rings
+#define SPATIAL_SWEEP_PERIOD_MS 1200
+#define SPATIAL_RIPPLE_PERIOD_MS 1000
+#define SPATIAL_SPOT_PERIOD_MS 1600 // One revolution
 
 // Command Protocol
 #define CMD_MODE 'M'
 #define CMD_TIMER 'T'
 #define CMD_STATUS 'S'
+#define CMD_DIAGNOSTICS 'D'
+#define CMD_BENCHMARK 'B'
+#define CMD_OTA 'U'
+#define CMD_LATENCY 'L'
+#define CMD_THERMAL 'H'
+#define CMD_TRACE 'R'
+#define CMD_PRESET_RECALL 'P'
+#define CMD_PRESET_STORE 'W'
+#define CMD_BATCH 'X'
+#define CMD_BATCH_INTENSITY 'I'     // Intensity-only operation inside a batch
+#define BATCH_SEPARATOR ';'
+#define BATCH_MAX_OPERATIONS 8
+#define BATCH_MAX_TIMER_S 86400     // Longest timer a batch accepts (24 h)
+
+// OTA Update
+#define OTA_REBOOT_DELAY_MS 500     // Let the completion notify go out before restarting
+
+// Session checkpoint in NVS (resume after brownout or reset)
+#define CHECKPOINT_NAMESPACE "session"
+#define CHECKPOINT_KEY "checkpoint"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_MIN_INTERVAL_MS 5000 // At most one write per interval while the session changes
+#define CHECKPOINT_TIMER_STEP_S 30      // Timer progress that is worth a write
+
+// Session presets in NVS
+#define PRESET_NAMESPACE "presets"
+#define PRESET_SLOTS 8
+#define PRESET_VERSION 1
+
+// Start-up
+#define BOOT_BT_TASK_STACK 8192         // Bluetooth stack bring-up task
+#define BOOT_BT_TASK_CORE 0             // Protocol core; loop() runs on core 1
+
+// BLE Connection Profiles
+enum ConnectionProfile {
+  CONN_PROFILE_NONE = 0,
+  CONN_PROFILE_LOW_LATENCY = 1,
+  CONN_PROFILE_POWER_SAVE = 2
+};
 
 // Operating Modes
 enum MassageMode {
@@ -55,7 +170,10 @@ enum MassageMode {
   MODE_WAVE = 2,
   MODE_CONSTANT = 3,
   MODE_HEARTBEAT = 4,
-  MODE_RAINDROPS = 5
+  MODE_RAINDROPS = 5,
+  MODE_SWEEP = 6,
+  MODE_RIPPLE = 7,
+  MODE_SPOT = 8
 };
 
 #endif
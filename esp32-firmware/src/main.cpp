@@ -2,100 +2,275 @@
 #include "MotorController.h"
 #include "SessionManager.h"
 #include "BluetoothHandler.h"
-#include <BLEDevice.h>
-#include <BLEServer.h>
+#include "EspFlashBackend.h"
+#include "OtaUpdater.h"
+#include "LatencyTracker.h"
+#include "PwmTraceRecorder.h"
+#include "PowerGovernor.h"
+#include "ThermalModel.h"
+#include "BatteryEstimator.h"
+#include "BatteryMonitor.h"
+#include "EspAdcSource.h"
+#include "RuntimePredictor.h"
+#include "EspNvsStore.h"
+#include "SessionCheckpoint.h"
+#include "PresetStore.h"
+#include "BootProfiler.h"
 
-// Forward declaration
-void updateMotorPattern(unsigned long timestamp);
+#ifdef USE_PCA9685_OUTPUT
+#include "WireI2cBus.h"
+#include "Pca9685Output.h"
+#elif defined(USE_SHIFT_REGISTER_OUTPUT)
+#include "ShiftRegisterOutput.h"
+#endif
 
-// BLE Server Callbacks
-class MyServerCallbacks: public BLEServerCallbacks {
-  private:
-    BluetoothHandler* handler;
-  public:
-    MyServerCallbacks(BluetoothHandler* h) : handler(h) {}
-    
-    void onConnect(BLEServer* pServer) {
-      handler->setConnected(true);
-      Serial.println("BLE Client connected");
-    };
-
-    void onDisconnect(BLEServer* pServer) {
-      handler->setConnected(false);
-      Serial.println("BLE Client disconnected");
-      // Restart advertising
-      BLEDevice::startAdvertising();
-      Serial.println("Advertising restarted");
-    }
-};
+#ifdef USE_SPP_TRANSPORT
+#include "SppTransport.h"
+#else
+#include "BleTransport.h"
+#endif
 
-// BLE Characteristic Callbacks
-class MyCallbacks: public BLECharacteristicCallbacks {
-  void onWrite(BLECharacteristic *pCharacteristic) {
-    // Commands are processed in handleCommands()
-  }
-};
+// Forward declarations
+void updateMotorPattern(unsigned long timestamp);
+void sampleBattery();
+void bluetoothInitTask(void* parameter);
+void reportBoot();
 
 // Global instances
 MotorController motorController(MOTOR_PINS, NUM_MOTORS, MAX_DUTY_CYCLE);
+#ifdef USE_PCA9685_OUTPUT
+WireI2cBus i2cBus;
+Pca9685Output pwmOutput(&i2cBus, PCA9685_BASE_ADDRESS, PCA9685_PWM_FREQUENCY);
+#elif defined(USE_SHIFT_REGISTER_OUTPUT)
+ShiftRegisterOutput pwmOutput(SHIFT_DATA_PIN, SHIFT_CLOCK_PIN, SHIFT_LATCH_PIN, SHIFT_SPI_CLOCK_HZ);
+#endif
 SessionManager sessionManager;
-BluetoothHandler bluetoothHandler(&sessionManager);
-MyServerCallbacks serverCallbacks(&bluetoothHandler);
+#ifdef USE_SPP_TRANSPORT
+SppTransport transport;
+#else
+BleTransport transport;
+#endif
+BluetoothHandler bluetoothHandler(&transport, &sessionManager);
+
+// Preallocated destination for scratch bulk transfers
+uint8_t bulkScratch[BULK_SCRATCH_SIZE];
+BufferSink bulkScratchSink(bulkScratch, sizeof(bulkScratch));
+
+// Firmware updates streamed over the bulk characteristic
+EspFlashBackend otaFlash;
+OtaUpdater otaUpdater(&otaFlash);
+
+// Time from a command reaching the transport to the motors reflecting it
+LatencyTracker latencyTracker;
+
+// Recent committed duty frames, downloadable with the R command
+PwmTraceRecorder pwmTrace(NUM_MOTORS);
+
+// Aggregate motor load limit, tightened as the battery runs down
+PowerGovernor powerGovernor(NUM_MOTORS, MAX_DUTY_CYCLE, POWER_BUDGET_PERCENT);
+
+// Per-motor heating, derates motors kept on for minutes
+ThermalModel thermalModel(NUM_MOTORS, MAX_DUTY_CYCLE);
+
+// Calibrated DMA conversions of the battery divider, filtered per tick
+EspAdcSource batteryAdc((adc1_channel_t)BATTERY_ADC_CHANNEL);
+BatteryMonitor batteryMonitor(&batteryAdc, BATTERY_VOLTAGE_DIVIDER);
+
+// State of charge corrected for the sag the motors cause
+BatteryEstimator batteryEstimator;
+
+// Average draw of the running pattern, for the runtime in the status response
+RuntimePredictor runtimePredictor;
+
+// Last session in NVS, resumed after a brownout or reset
+EspNvsStore sessionStore(CHECKPOINT_NAMESPACE);
+SessionCheckpoint sessionCheckpoint(&sessionStore);
+
+// Saved configurations for the P/W commands, cached in RAM at boot
+EspNvsStore presetNvs(PRESET_NAMESPACE);
+PresetStore presetStore(&presetNvs);
+
+// Start-up phase timestamps, reported once Bluetooth is up
+BootProfiler bootProfiler;
+volatile bool bluetoothReady = false;   // Set by bluetoothInitTask
+volatile bool bluetoothFailed = false;
+bool bootReported = false;
 
 unsigned long lastUpdateTime = 0;
+unsigned long lastBatterySampleTime = 0;
 
 void setup() {
   // Initialize serial for debugging
   Serial.begin(SERIAL_BAUD_RATE);
-  Serial.println("Smart Massage Mask - Initializing...");
+  bootProfiler.mark("serial", micros());
   
-  // Initialize motor controller
+  // Motors and the resumed session come first; logging waits until they run
+#ifdef USE_PCA9685_OUTPUT
+  i2cBus.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_CLOCK_HZ);
+  motorController.setOutput(&pwmOutput);
+#elif defined(USE_SHIFT_REGISTER_OUTPUT)
+  motorController.setOutput(&pwmOutput);
+#endif
   if (!motorController.begin()) {
     Serial.println("ERROR: Motor initialization failed!");
     while (1) delay(1000);  // Halt on critical error
   }
-  Serial.println("Motors initialized");
+  motorController.setTraceRecorder(&pwmTrace);
+  motorController.setLayout(MOTOR_LAYOUT_MM);
+  motorController.setGovernor(&powerGovernor);
+  motorController.setThermalModel(&thermalModel);
+  bootProfiler.mark("motors", micros());
+  
+  // Resume the checkpointed session
+  SessionSnapshot snapshot;
+  bool nvsAvailable = sessionStore.begin();
+  bool resumed = nvsAvailable && sessionCheckpoint.restore(&snapshot) && snapshot.mode != MODE_OFF;
+  if (resumed) {
+    sessionManager.restoreSnapshot(snapshot);
+  }
+  bootProfiler.mark("restore", micros());
+  
+  // First frame now rather than after Bluetooth is up
+  unsigned long now = millis();
+  updateMotorPattern(now);
+  motorController.commitFrame();
+  lastUpdateTime = now;
+  bootProfiler.markFirstOutput(micros());
+  
+  // Presets are cached before any command can recall one
+  int presetsLoaded = presetNvs.begin() ? presetStore.load() : 0;
+  bootProfiler.mark("presets", micros());
+  
+  // Bluetooth comes up on the other core while the loop drives the motors
+  bluetoothHandler.registerBulkSink(BULK_TARGET_SCRATCH, &bulkScratchSink);
+  bluetoothHandler.setOtaUpdater(&otaUpdater);
+  bluetoothHandler.setLatencyTracker(&latencyTracker);
+  bluetoothHandler.setTraceRecorder(&pwmTrace);
+  bluetoothHandler.setPowerGovernor(&powerGovernor);
+  bluetoothHandler.setThermalModel(&thermalModel);
+  bluetoothHandler.setBootProfiler(&bootProfiler);
+  bluetoothHandler.setPresetStore(&presetStore);
+  xTaskCreatePinnedToCore(bluetoothInitTask, "bt_init", BOOT_BT_TASK_STACK, nullptr, 1, nullptr,
+                          BOOT_BT_TASK_CORE);
+  bootProfiler.mark("bt_task", micros());
   
   // Initialize battery monitoring pin
   pinMode(BATTERY_PIN, INPUT);
+  sessionManager.setBatteryEstimator(&batteryEstimator);
+  sessionManager.setRuntimePredictor(&runtimePredictor);
   analogReadResolution(12);  // Set ADC to 12-bit resolution
   analogSetAttenuation(ADC_11db);  // 0-3.6V range (for voltage divider)
-  Serial.println("Battery monitoring initialized");
-  // Seed random for raindrops pattern
-  randomSeed(analogRead(BATTERY_PIN) ^ millis());
+  // Seed random for raindrops pattern (before continuous mode takes over ADC1)
+  motorController.seedRandom(((uint32_t)analogRead(BATTERY_PIN) << 16) ^ micros());
+  bool adcRunning = batteryAdc.begin();
+  bootProfiler.mark("adc", micros());
   
-  // Initialize Bluetooth
-  if (!bluetoothHandler.begin(DEVICE_NAME)) {
-    Serial.println("ERROR: Bluetooth initialization failed!");
-    while (1) delay(1000);  // Halt on critical error
+  Serial.println("Smart Massage Mask - Initializing...");
+  Serial.println("Motors initialized");
+  if (!nvsAvailable) {
+    Serial.println("WARNING: NVS unavailable, session will not be checkpointed");
+  } else if (resumed) {
+    Serial.printf("Resumed session: mode %u, intensity %u, %lus left (reset reason %d)\n",
+                  snapshot.mode, snapshot.intensity, (unsigned long)snapshot.remainingSeconds,
+                  (int)esp_reset_reason());
+  }
+  Serial.printf("Presets loaded: %d of %d slots\n", presetsLoaded, PRESET_SLOTS);
+  if (adcRunning) {
+    Serial.print("Battery monitoring initialized, ADC calibration: ");
+    Serial.println(batteryAdc.getCalibrationName());
+  } else {
+    Serial.println("WARNING: ADC continuous mode unavailable, using one-shot reads");
   }
-  
-  // Set BLE callbacks
-  BLEServer* pServer = bluetoothHandler.getServer();
-  pServer->setCallbacks(&serverCallbacks);
-  
-  Serial.println("BLE initialized: " + String(DEVICE_NAME));
-  Serial.println("Service UUID: " + String(SERVICE_UUID));
-  Serial.println("Waiting for client connection...");
-  
   Serial.println("System ready");
 }
 
+/**
+ * @brief Bring up the Bluetooth stack off the motor core (FreeRTOS task)
+ */
+void bluetoothInitTask(void* parameter) {
+  if (bluetoothHandler.begin(DEVICE_NAME)) {
+    bootProfiler.markAdvertising(micros());
+    bluetoothReady = true;
+  } else {
+    bluetoothFailed = true;
+  }
+  vTaskDelete(NULL);
+}
+
 void loop() {
-  // Handle incoming Bluetooth commands
-  bluetoothHandler.handleCommands();
+  if (bluetoothReady) {
+    // Handle incoming Bluetooth commands (also adapts BLE connection parameters)
+    bluetoothHandler.handleCommands();
+    if (!bootReported) {
+      bootReported = true;
+      reportBoot();
+    }
+  } else if (bluetoothFailed && !bootReported) {
+    bootReported = true;
+    Serial.println("ERROR: Bluetooth initialization failed!");
+    reportBoot();
+  }
   
   // Check if timer has expired
   if (sessionManager.checkTimer()) {
-    bluetoothHandler.notifyTimerComplete();
+    if (bluetoothReady) {
+      bluetoothHandler.notifyTimerComplete();
+    }
     Serial.println("Session timer expired");
   }
   
+  // Boot into a verified OTA image
+  if (otaUpdater.isRebootPending()) {
+    motorController.stopAll();
+    motorController.commitFrame();
+    bluetoothHandler.notifyOtaComplete();
+    delay(OTA_REBOOT_DELAY_MS);
+    ESP.restart();
+  }
+  
   // Update motor patterns at defined interval
   unsigned long currentTime = millis();
+  
+  // One filtered reading per interval, with the load it was measured under.
+  // Until the first one lands (for the first status request) retry every
+  // tick, when the monitor has had a chance to collect new conversions
+  unsigned long batteryInterval = batteryEstimator.getPercent() < 0 ? UPDATE_INTERVAL_MS : POWER_BATTERY_SAMPLE_MS;
+  if (currentTime - lastBatterySampleTime >= batteryInterval) {
+    lastBatterySampleTime = currentTime;
+    sampleBattery();
+  }
+  
   if (currentTime - lastUpdateTime >= UPDATE_INTERVAL_MS) {
     lastUpdateTime = currentTime;
+    
+    // Conversions captured while the previous frame was on the motors
+    if (batteryAdc.isRunning()) {
+      batteryMonitor.poll(BatteryEstimator::loadForDutySum(motorController.getCommittedDutySum()));
+    }
+    
+    // Apply the latest mode/intensity request once per tick
+    bool updateApplied = sessionManager.commitPendingUpdate();
+    
     updateMotorPattern(currentTime);
+    uint32_t committedAt = motorController.commitFrame();
+    
+    // A new mode or intensity starts a new energy profile
+    if (updateApplied) {
+      runtimePredictor.reset();
+    }
+    runtimePredictor.record(motorController.getCommittedDutySum());
+    
+    // Measure before acknowledging; the ack itself must not count as latency
+    CommandTrace trace;
+    if (sessionManager.takeAppliedTrace(&trace)) {
+      latencyTracker.record(trace, committedAt);
+    }
+    if (updateApplied && bluetoothReady) {
+      bluetoothHandler.sendModeAck();
+    }
+    
+    // Batched and rate-limited; usually a no-op
+    sessionCheckpoint.update(sessionManager.getSnapshot(), currentTime);
   }
 }
 
@@ -104,40 +279,42 @@ void loop() {
  * @param timestamp Current time in milliseconds
  */
 void updateMotorPattern(unsigned long timestamp) {
-  MassageMode mode = sessionManager.getMode();
-  int intensity = sessionManager.getIntensity();
-  
-  switch (mode) {
-    case MODE_OFF:
-      motorController.stopAll();
-      break;
-      
-    case MODE_PULSE:
-      motorController.applyPulse(intensity, timestamp);
-      break;
-      
-    case MODE_WAVE:
-      motorController.applyWave(intensity, timestamp);
-      break;
-      
-    case MODE_CONSTANT:
-      motorController.applyConstant(intensity);
-      break;
-
-    case MODE_HEARTBEAT:
-      Serial.println("Applying HEARTBEAT pattern");
-      motorController.applyHeartbeat(intensity, timestamp);
-      break;
-
-    case MODE_RAINDROPS:
-      Serial.println("Applying RAINDROPS pattern");
-      motorController.applyRaindrops(intensity, timestamp);
-      break;
-
-    default:
-      Serial.print("WARN: Unknown mode: ");
-      Serial.println((int)mode);
-      motorController.stopAll();
-      break;
+  motorController.applyMode(sessionManager.getMode(), sessionManager.getIntensity(), timestamp);
+}
+
+/**
+ * @brief Feed the battery estimator and power governor one reading
+ */
+void sampleBattery() {
+  uint32_t batteryMv;
+  uint32_t loadMa;
+  if (batteryAdc.isRunning()) {
+    if (!batteryMonitor.takeSample(&batteryMv, &loadMa)) return;
+  } else {
+    batteryMv = analogReadMilliVolts(BATTERY_PIN) * BATTERY_VOLTAGE_DIVIDER;
+    loadMa = BatteryEstimator::loadForDutySum(motorController.getCommittedDutySum());
   }
-}
\ No newline at end of file
+  batteryEstimator.update(batteryMv, loadMa);
+  // Compensated voltage, so the governor doesn't throttle on the sag it could cause itself
+  powerGovernor.updateBattery(batteryEstimator.getOpenCircuitMillivolts());
+}
+
+/**
+ * @brief Log the start-up phases and the two boot milestones
+ */
+void reportBoot() {
+  char line[RESPONSE_MAX_LENGTH];
+  bootProfiler.format(line, sizeof(line));
+  Serial.print("Boot timeline (us): ");
+  Serial.println(line);
+  Serial.printf("First motor output after %lu us, advertising after %lu us\n",
+                (unsigned long)bootProfiler.getFirstOutputUs(),
+                (unsigned long)bootProfiler.getAdvertisingUs());
+#ifdef USE_SPP_TRANSPORT
+  Serial.println("Bluetooth SPP initialized: " + String(DEVICE_NAME));
+#else
+  Serial.println("BLE initialized: " + String(DEVICE_NAME));
+  Serial.println("Service UUID: " + String(SERVICE_UUID));
+#endif
+  Serial.println("Waiting for client connection...");
+}
@@ -0,0 +1,65 @@
+/**
+ * Runs the B command's benchmark suites on the host and prints their
+ * results, the same output the device writes to Serial.
+ *
+ *   bench_host [suite...]
+ *
+ * With no arguments every suite but 3 runs (the pattern regression is
+ * test_pattern_regression). Timings are host timings; bytes, transactions,
+ * current-model and bitstream results are the same as on the device.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Benchmarks.h"
+#include "PatternRegression.h"
+
+static bool runSuite(long suite) {
+  switch (suite) {
+    case BENCH_SUITE_BULK:
+      runBulkLoopbackBenchmark();
+      return true;
+
+    case BENCH_SUITE_PARSER:
+      runCommandParserBenchmark();
+      return true;
+
+    case BENCH_SUITE_PATTERNS:
+      return runPatternRegression();
+
+    case BENCH_SUITE_KERNELS:
+      runPatternKernelBenchmark();
+      return true;
+
+    case BENCH_SUITE_PCA9685:
+      runPca9685Benchmark();
+      return true;
+
+    case BENCH_SUITE_SHIFT_REGISTER:
+      runShiftRegisterBenchmark();
+      return true;
+
+    case BENCH_SUITE_PWM_PHASE:
+      runPwmPhaseBenchmark();
+      return true;
+
+    default:
+      fprintf(stderr, "unknown suite %ld\n", suite);
+      return false;
+  }
+}
+
+int main(int argc, char** argv) {
+  static const long defaultSuites[] = {
+    BENCH_SUITE_BULK, BENCH_SUITE_PARSER, BENCH_SUITE_KERNELS,
+    BENCH_SUITE_PCA9685, BENCH_SUITE_SHIFT_REGISTER, BENCH_SUITE_PWM_PHASE
+  };
+
+  bool ok = true;
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) ok = runSuite(atol(argv[i])) && ok;
+  } else {
+    for (long suite : defaultSuites) ok = runSuite(suite) && ok;
+  }
+  return ok ? 0 : 1;
+}
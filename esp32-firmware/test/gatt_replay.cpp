@@ -0,0 +1,270 @@
+/**
+ * Replays an app command trace through BluetoothHandler over the loopback
+ * GATT link and reports latency and throughput.
+ *
+ *   gatt_replay <trace> [interval_ms] [packets_per_event] [loss_percent]
+ *
+ * The device side (transport, command core, session, motors, presets) runs
+ * on its own thread with the engine tick of main.cpp. The client writes
+ * each trace line after its recorded delay and pairs every notification
+ * with the write it answers. Mode, preset recall and batch writes are
+ * applied at a tick, and each kind is acknowledged once for its latest
+ * write, so an ack retires every older one of them as coalesced. A mode
+ * ack reports the merged state, so a mode write that a batch or preset
+ * overrode in the same tick is matched to the oldest pending mode write.
+ * Everything else is answered in order.
+ *
+ * Exits nonzero if a write goes unanswered or is answered with an error.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BatteryEstimator.h"
+#include "BluetoothHandler.h"
+#include "LoopbackGattClient.h"
+#include "LoopbackGattTransport.h"
+#include "MotorController.h"
+#include "PresetStore.h"
+#include "SimulatedNvsStore.h"
+
+#define REPLAY_SOCKET_PATH "/tmp/smart_mask_replay.sock"
+#define REPLAY_MTU 512
+#define REPLAY_DRAIN_MS 2000   // Wait for late replies after the last write
+#define REPLAY_DEVICE_IDLE_US 200
+#define REPLAY_BATTERY_MV 3900   // Resting cell voltage the status replies report
+
+typedef std::chrono::steady_clock Clock;
+
+struct TraceLine {
+  unsigned long delayMs;
+  std::string command;
+};
+
+// A write still waiting for its reply
+struct PendingWrite {
+  std::string command;
+  std::string reply;   // Start of the ack a tick command expects
+  Clock::time_point sent;
+};
+
+static std::atomic<bool> deviceRunning(true);
+
+static bool loadTrace(const char* path, std::vector<TraceLine>* lines) {
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+
+  char text[256];
+  while (fgets(text, sizeof(text), file)) {
+    char* end;
+    unsigned long delayMs = strtoul(text, &end, 10);
+    if (text[0] == '#' || end == text) continue;
+    while (*end == ' ') end++;
+    std::string command(end);
+    while (!command.empty() && (command.back() == '\n' || command.back() == '\r')) command.pop_back();
+    if (!command.empty()) lines->push_back({delayMs, command});
+  }
+  fclose(file);
+  return true;
+}
+
+// Same tick as main.cpp's loop(), minus battery and power bookkeeping
+static void runDevice(BluetoothHandler* handler, SessionManager* session, MotorController* motors,
+                      LatencyTracker* tracker) {
+  unsigned long lastUpdate = millis();
+  while (deviceRunning) {
+    handler->handleCommands();
+    if (session->checkTimer()) handler->notifyTimerComplete();
+
+    unsigned long now = millis();
+    if (now - lastUpdate >= UPDATE_INTERVAL_MS) {
+      lastUpdate = now;
+      bool applied = session->commitPendingUpdate();
+      motors->applyMode(session->getMode(), session->getIntensity(), now);
+      uint32_t committedAt = motors->commitFrame();
+
+      CommandTrace trace;
+      if (session->takeAppliedTrace(&trace)) tracker->record(trace, committedAt);
+      if (applied) handler->sendModeAck();
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(REPLAY_DEVICE_IDLE_US));
+  }
+}
+
+static bool isTickCommand(char kind) {
+  return kind == CMD_MODE || kind == CMD_PRESET_RECALL || kind == CMD_BATCH;
+}
+
+static std::string expectedAck(const std::string& command) {
+  if (command[0] == CMD_BATCH) return "OK: Batch=";
+  if (command[0] == CMD_PRESET_RECALL) return "OK: Preset=";
+  char ack[48];
+  snprintf(ack, sizeof(ack), "OK: Mode=%d Intensity=%d", command[1] - '0', atoi(command.c_str() + 2));
+  return ack;
+}
+
+static uint32_t percentile(std::vector<uint32_t> values, int percent) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  return values[(values.size() - 1) * percent / 100];
+}
+
+static void printLatency(const char* name, const std::vector<uint32_t>& values) {
+  printf("  %-22s n=%zu p50=%lu p90=%lu max=%lu us\n", name, values.size(),
+         (unsigned long)percentile(values, 50), (unsigned long)percentile(values, 90),
+         (unsigned long)percentile(values, 100));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace> [interval_ms] [packets_per_event] [loss_percent]\n", argv[0]);
+    return 2;
+  }
+  std::vector<TraceLine> trace;
+  if (!loadTrace(argv[1], &trace) || trace.empty()) {
+    fprintf(stderr, "cannot read trace %s\n", argv[1]);
+    return 2;
+  }
+
+  GattLinkConfig link;
+  link.intervalMs = argc > 2 ? (uint16_t)atoi(argv[2]) : 15;
+  link.packetsPerEvent = argc > 3 ? (uint8_t)atoi(argv[3]) : 4;
+  link.lossPercent = argc > 4 ? (uint8_t)atoi(argv[4]) : 0;
+  link.seed = 1;
+
+  // Device
+  Serial.setQuiet(true);
+  LoopbackGattTransport transport(REPLAY_SOCKET_PATH, link);
+  SessionManager session;
+  MotorController motors(MOTOR_PINS, NUM_MOTORS, MAX_DUTY_CYCLE);
+  SimulatedNvsStore nvs;
+  PresetStore presets(&nvs);
+  LatencyTracker tracker;
+  BatteryEstimator battery;
+  BluetoothHandler handler(&transport, &session);
+  battery.update(REPLAY_BATTERY_MV, BATTERY_IDLE_MA);
+  session.setBatteryEstimator(&battery);
+  motors.begin();
+  motors.setLayout(MOTOR_LAYOUT_MM);
+  presets.load();
+  handler.setPresetStore(&presets);
+  handler.setLatencyTracker(&tracker);
+  if (!handler.begin(DEVICE_NAME)) {
+    fprintf(stderr, "cannot listen on %s\n", REPLAY_SOCKET_PATH);
+    return 2;
+  }
+  std::thread device(runDevice, &handler, &session, &motors, &tracker);
+
+  // Client
+  LoopbackGattClient client;
+  bool connected = client.connect(REPLAY_SOCKET_PATH) && client.exchangeMtu(REPLAY_MTU, 1000) > 0;
+
+  std::vector<PendingWrite> tickWrites, orderedWrites;
+  std::vector<uint32_t> tickLatency, replyLatency;
+  unsigned long coalesced = 0, errors = 0, unmatched = 0, bytesWritten = 0, bytesNotified = 0;
+  std::string latencyReport;
+
+  auto collect = [&](int timeoutMs) {
+    uint8_t handle;
+    char text[GATT_LOOPBACK_MAX_MTU + 1];
+    int length = client.waitForNotify(&handle, (uint8_t*)text, sizeof(text) - 1, timeoutMs);
+    if (length < 0) return false;
+    Clock::time_point now = Clock::now();
+    bytesNotified += length;
+    if (handle != GATT_HANDLE_COMMAND) return true;
+    text[length] = '\0';
+    if (strcmp(text, "TIMER_COMPLETE") == 0) return true;
+
+    if (strncmp(text, "ERROR", 5) == 0) {
+      errors++;
+      printf("  %s\n", text);
+    }
+    if (strncmp(text, "L:", 2) == 0) latencyReport = text;
+
+    // The newest matching tick write was applied; older ones were superseded
+    size_t match = tickWrites.size();
+    for (size_t i = tickWrites.size(); i-- > 0;) {
+      if (strncmp(text, tickWrites[i].reply.c_str(), tickWrites[i].reply.size()) == 0) {
+        match = i;
+        break;
+      }
+    }
+    if (match == tickWrites.size() && strncmp(text, "OK: Mode=", 9) == 0) {
+      for (size_t i = 0; i < tickWrites.size() && match == tickWrites.size(); i++) {
+        if (tickWrites[i].command[0] == CMD_MODE) match = i;
+      }
+    }
+    if (match < tickWrites.size()) {
+      tickLatency.push_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          now - tickWrites[match].sent).count());
+      coalesced += match;
+      tickWrites.erase(tickWrites.begin(), tickWrites.begin() + match + 1);
+      return true;
+    }
+    if (!orderedWrites.empty()) {
+      replyLatency.push_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          now - orderedWrites.front().sent).count());
+      orderedWrites.erase(orderedWrites.begin());
+    } else {
+      unmatched++;
+      printf("  unexpected reply: %s\n", text);
+    }
+    return true;
+  };
+
+  Clock::time_point start = Clock::now();
+  Clock::time_point nextWrite = start;
+  for (const TraceLine& line : trace) {
+    if (!connected) break;
+    nextWrite += std::chrono::milliseconds(line.delayMs);
+    for (;;) {
+      long remaining = (long)std::chrono::duration_cast<std::chrono::milliseconds>(nextWrite - Clock::now()).count();
+      if (remaining <= 0) break;
+      collect((int)remaining);
+    }
+
+    std::string written = line.command + "\n";
+    PendingWrite pending = {line.command, "", Clock::now()};
+    if (!client.writeCommand(written.c_str())) {
+      connected = false;
+      break;
+    }
+    bytesWritten += written.size();
+    if (isTickCommand(line.command[0])) {
+      pending.reply = expectedAck(line.command);
+      tickWrites.push_back(pending);
+    } else {
+      orderedWrites.push_back(pending);
+    }
+  }
+  Clock::time_point lastWrite = Clock::now();
+  while ((!tickWrites.empty() || !orderedWrites.empty()) && collect(REPLAY_DRAIN_MS)) {}
+
+  double seconds = std::chrono::duration<double>(lastWrite - start).count();
+  deviceRunning = false;
+  device.join();
+
+  char diagnostics[RESPONSE_MAX_LENGTH];
+  transport.formatDiagnostics(diagnostics, sizeof(diagnostics));
+  unsigned long unanswered = tickWrites.size() + orderedWrites.size();
+
+  printf("Replayed %zu writes in %.2f s over a %u ms / %u-packet link, %u%% loss\n", trace.size(), seconds,
+         (unsigned)link.intervalMs, (unsigned)link.packetsPerEvent, (unsigned)link.lossPercent);
+  printf("  throughput: %.1f commands/s, %.0f B/s written, %.0f B/s notified\n",
+         trace.size() / seconds, bytesWritten / seconds, bytesNotified / seconds);
+  printLatency("write -> tick ack", tickLatency);
+  printLatency("write -> reply", replyLatency);
+  printf("  coalesced=%lu unanswered=%lu errors=%lu unexpected=%lu\n", coalesced, unanswered, errors, unmatched);
+  printf("  device %s\n", latencyReport.empty() ? "L: (no report)" : latencyReport.c_str());
+  printf("  link %s\n", diagnostics);
+
+  bool pass = connected && unanswered == 0 && errors == 0 && unmatched == 0 && !tickLatency.empty();
+  printf("%s\n", pass ? "PASS" : "FAIL");
+  return pass ? 0 : 1;
+}
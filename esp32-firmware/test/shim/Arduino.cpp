@@ -0,0 +1,105 @@
+#include "Arduino.h"
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+#include "driver/ledc.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// Clocks count from the steady_clock epoch, like the host transports' timestamps
+
+static uint32_t analogMillivolts = 0;
+
+void String::trim() {
+  size_t first = text.find_first_not_of(" \t\r\n");
+  size_t last = text.find_last_not_of(" \t\r\n");
+  text = first == std::string::npos ? "" : text.substr(first, last - first + 1);
+}
+
+size_t HardwareSerial::print(const char* text) {
+  return printf("%s", text);
+}
+
+size_t HardwareSerial::print(int value) {
+  return printf("%d", value);
+}
+
+size_t HardwareSerial::print(unsigned long value) {
+  return printf("%lu", value);
+}
+
+size_t HardwareSerial::print(double value, int digits) {
+  return printf("%.*f", digits, value);
+}
+
+size_t HardwareSerial::println(const char* text) {
+  return printf("%s\n", text);
+}
+
+size_t HardwareSerial::println(int value) {
+  return printf("%d\n", value);
+}
+
+size_t HardwareSerial::println(unsigned long value) {
+  return printf("%lu\n", value);
+}
+
+size_t HardwareSerial::println(double value, int digits) {
+  return printf("%.*f\n", digits, value);
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+  if (quiet) return 0;
+  va_list args;
+  va_start(args, format);
+  int written = vprintf(format, args);
+  va_end(args);
+  return written < 0 ? 0 : (size_t)written;
+}
+
+uint32_t EspClass::getCycleCount() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long millis() {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long micros() {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+uint32_t analogReadMilliVolts(uint8_t) {
+  return analogMillivolts;
+}
+
+void hostSetAnalogMilliVolts(uint32_t millivolts) {
+  analogMillivolts = millivolts;
+}
+
+double ledcSetup(uint8_t, double frequency, uint8_t) { return frequency; }
+void ledcAttachPin(uint8_t, uint8_t) {}
+void ledcWrite(uint8_t, uint32_t) {}
+
+esp_err_t ledc_set_duty_with_hpoint(ledc_mode_t, ledc_channel_t, uint32_t, uint32_t) { return ESP_OK; }
+esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t) { return ESP_OK; }
+esp_err_t ledc_bind_channel_timer(ledc_mode_t, ledc_channel_t, ledc_timer_t) { return ESP_OK; }
@@ -0,0 +1,122 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * Minimal Arduino core for building the firmware's portable code on the
+ * host. Only what src/ uses outside its #ifdef ARDUINO blocks is here:
+ * Serial goes to stdout, the clock is the host's steady clock and every
+ * peripheral call is a no-op. ESP.getCycleCount() counts nanoseconds, so
+ * benchmark "cycles" read as ns on the host.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define LOW 0x0
+#define HIGH 0x1
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class String {
+private:
+  std::string text;
+
+public:
+  String(const char* value = "") : text(value ? value : "") {}
+  String(const std::string& value) : text(value) {}
+  explicit String(int value) : text(std::to_string(value)) {}
+  explicit String(unsigned long value) : text(std::to_string(value)) {}
+
+  unsigned length() const { return text.size(); }
+  char charAt(unsigned index) const { return index < text.size() ? text[index] : 0; }
+  char operator[](unsigned index) const { return charAt(index); }
+  String substring(unsigned from) const { return from < text.size() ? text.substr(from) : ""; }
+  String substring(unsigned from, unsigned to) const {
+    return from < to && from < text.size() ? text.substr(from, to - from) : "";
+  }
+  long toInt() const { return atol(text.c_str()); }
+  int indexOf(char c, unsigned from = 0) const {
+    size_t found = text.find(c, from);
+    return found == std::string::npos ? -1 : (int)found;
+  }
+  void trim();
+  const char* c_str() const { return text.c_str(); }
+  String& operator+=(const String& other) { text += other.text; return *this; }
+  String& operator+=(const char* other) { text += other; return *this; }
+  String& operator+=(char other) { text += other; return *this; }
+  bool operator==(const char* other) const { return text == other; }
+  friend String operator+(const String& a, const String& b) { return a.text + b.text; }
+  friend String operator+(const char* a, const String& b) { return a + b.text; }
+  friend String operator+(const String& a, const char* b) { return a.text + b; }
+};
+
+class HardwareSerial {
+private:
+  bool quiet;
+
+public:
+  HardwareSerial() : quiet(false) {}
+
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+  int available() { return 0; }
+  int read() { return -1; }
+
+  /**
+   * @brief Drop everything printed from now on (for tests with chatty code paths)
+   */
+  void setQuiet(bool enabled) { quiet = enabled; }
+
+  size_t print(const char* text);
+  size_t print(const String& text) { return print(text.c_str()); }
+  size_t print(int value);
+  size_t print(unsigned long value);
+  size_t print(double value, int digits = 2);
+  size_t println() { return print("\n"); }
+  size_t println(const char* text);
+  size_t println(const String& text) { return println(text.c_str()); }
+  size_t println(int value);
+  size_t println(unsigned long value);
+  size_t println(double value, int digits = 2);
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getFreeHeap() { return 0; }
+  void restart() {}
+};
+
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint32_t analogReadMilliVolts(uint8_t pin);
+double ledcSetup(uint8_t channel, double frequency, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+/**
+ * @brief Voltage the host "reads" on every analog pin (default 0)
+ */
+void hostSetAnalogMilliVolts(uint32_t millivolts);
+
+#endif
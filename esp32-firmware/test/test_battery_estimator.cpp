@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include "BatteryEstimator.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// A sample under load reads like the same cell at rest
+static void testIrDrop() {
+  uint32_t loadMa = 1000;
+  uint32_t sagMv = loadMa * BATTERY_INTERNAL_RESISTANCE_MOHM / 1000;
+
+  BatteryEstimator loaded;
+  loaded.update(3850 - sagMv, loadMa);
+  BatteryEstimator resting;
+  resting.update(3850, 0);
+  check(loaded.getOpenCircuitMillivolts() == 3850, "sag added back to the terminal voltage");
+  check(loaded.getPercent() == resting.getPercent() && resting.getPercent() == 50, "loaded and resting agree");
+
+  // Uncorrected, the loaded reading would be well below
+  check(BatteryEstimator::socForVoltage(3850 - sagMv) < 20, "sag alone looks far emptier");
+
+  // Motor current follows the committed duty
+  check(BatteryEstimator::loadForDutySum(0) == BATTERY_IDLE_MA, "idle current with the motors off");
+  check(BatteryEstimator::loadForDutySum(8 * 255) == 8 * MOTOR_CURRENT_MA + BATTERY_IDLE_MA,
+        "every motor at full duty");
+}
+
+// Both steep ends and the flat middle of the discharge curve
+static void testCurve() {
+  check(BatteryEstimator::socForVoltage(2500) == 0, "below empty is 0");
+  check(BatteryEstimator::socForVoltage(3000) == 0, "empty point");
+  check(BatteryEstimator::socForVoltage(3225) == 2, "halfway up the low end");
+  check(BatteryEstimator::socForVoltage(3450) == 5, "knee of the low end");
+  check(BatteryEstimator::socForVoltage(3800) == 35, "flat middle interpolated");
+  check(BatteryEstimator::socForVoltage(3850) == 50, "curve point in the middle");
+  check(BatteryEstimator::socForVoltage(4155) == 95, "halfway up the top end");
+  check(BatteryEstimator::socForVoltage(4200) == 100, "full point");
+  check(BatteryEstimator::socForVoltage(4350) == 100, "above full is 100");
+
+  // 10 mV moves the flat middle much further than the steep low end
+  int middle = BatteryEstimator::socForVoltage(3810) - BatteryEstimator::socForVoltage(3800);
+  int low = BatteryEstimator::socForVoltage(3210) - BatteryEstimator::socForVoltage(3200);
+  check(middle > low, "middle steeper in % per mV than the low end");
+
+  bool monotonic = true;
+  for (uint32_t mv = 2900; mv < 4300; mv++) {
+    if (BatteryEstimator::socForVoltage(mv + 1) < BatteryEstimator::socForVoltage(mv)) monotonic = false;
+  }
+  check(monotonic, "curve never falls as the voltage rises");
+}
+
+// The reading follows a falling estimate and rises only in steps of the hysteresis
+static void testHysteresis() {
+  BatteryEstimator estimator;
+  estimator.update(3850, 0);
+  int last = estimator.getPercent();
+
+  bool followsDown = true;
+  bool risesInSteps = true;
+  bool rose = false;
+  // Charger connected: the cell climbs slowly; then unplugged and discharging
+  for (int step = 0; step < 400; step++) {
+    uint32_t mv = step < 200 ? 3850 + step / 2 : 3950 - (step - 200);
+    estimator.update(mv, 0);
+    int percent = estimator.getPercent();
+    int estimate = BatteryEstimator::socForVoltage(estimator.getOpenCircuitMillivolts());
+    if (percent > last) {
+      rose = true;
+      if (percent - last < BATTERY_SOC_HYSTERESIS) risesInSteps = false;
+    }
+    if (estimate < last && percent != estimate) followsDown = false;
+    last = percent;
+  }
+  check(rose, "reading rises while charging");
+  check(risesInSteps, "never rises by less than BATTERY_SOC_HYSTERESIS");
+  check(followsDown, "follows a falling estimate at once");
+
+  // Pattern changes wobble the estimate by a few % without moving the reading up
+  BatteryEstimator steady;
+  steady.update(3850, 0);
+  for (int step = 0; step < 100; step++) steady.update(step % 2 ? 3865 : 3850, 0);
+  check(steady.getPercent() == 50, "small rises do not move the reading");
+}
+
+// Runtime needs a first sample and a load
+static void testPrediction() {
+  BatteryEstimator estimator;
+  check(estimator.getPercent() == -1, "no percent before the first sample");
+  check(estimator.predictMinutes(500) == -1, "no prediction before the first sample");
+  check(estimator.getRuntimeMinutes() == -1, "no runtime before the first sample");
+
+  estimator.update(3850 - 500 * BATTERY_INTERNAL_RESISTANCE_MOHM / 1000, 500);
+  check(estimator.predictMinutes(0) == -1, "no prediction without a load");
+  check(estimator.predictMinutes(500) == 50 * BATTERY_CAPACITY_MAH * 60 / 100 / 500, "half a cell at 500 mA");
+  check(estimator.getRuntimeMinutes() == estimator.predictMinutes(500), "runtime at the sampled load");
+}
+
+int main() {
+  testIrDrop();
+  testCurve();
+  testHysteresis();
+  testPrediction();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
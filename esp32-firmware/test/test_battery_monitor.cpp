@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "BatteryMonitor.h"
+#include "SyntheticAdcSource.h"
+
+#define TEST_TICK_SAMPLES (BATTERY_ADC_SAMPLE_HZ * UPDATE_INTERVAL_MS / 1000)
+#define TEST_REST_MV 3900          // Battery at rest
+#define TEST_LOADED_MV 3600        // Same battery sagging under the motors
+#define TEST_LOAD_MA 600
+#define TEST_NOISE_COUNTS 24
+#define TEST_TOLERANCE_MV 12       // ~8 counts at the pin after the divider
+
+static int failures = 0;
+
+static void check(bool condition, const char* what, int value) {
+  printf("  %-44s %5d %s\n", what, value, condition ? "ok" : "FAIL");
+  if (!condition) failures++;
+}
+
+static bool near(int millivolts, int expected) {
+  return abs(millivolts - expected) <= TEST_TOLERANCE_MV;
+}
+
+/**
+ * @brief SyntheticAdcSource with a burst: a stretch of conversions inside
+ *        the next tick is shifted, like a motor switching on mid-frame
+ */
+class BurstAdcSource : public SyntheticAdcSource {
+private:
+  size_t position;
+  size_t burstStart;
+  size_t burstLength;
+  int32_t burstCounts;
+
+public:
+  explicit BurstAdcSource(uint32_t seed)
+    : SyntheticAdcSource(seed), position(0), burstStart(0), burstLength(0), burstCounts(0) {}
+
+  void setBurst(size_t start, size_t length, int32_t counts) {
+    position = 0;
+    burstStart = start;
+    burstLength = length;
+    burstCounts = counts;
+  }
+
+  size_t read(uint16_t* samples, size_t maxSamples) override {
+    size_t count = SyntheticAdcSource::read(samples, maxSamples);
+    for (size_t i = 0; i < count; i++, position++) {
+      if (position < burstStart || position >= burstStart + burstLength) continue;
+      int32_t value = samples[i] + burstCounts;
+      samples[i] = (uint16_t)(value < 0 ? 0 : (value > 4095 ? 4095 : value));
+    }
+    return count;
+  }
+};
+
+static int runTick(BurstAdcSource* adc, BatteryMonitor* monitor, uint32_t batteryMv, uint32_t loadMa) {
+  adc->setPinMillivolts((uint32_t)(batteryMv / BATTERY_VOLTAGE_DIVIDER));
+  adc->capture(TEST_TICK_SAMPLES);
+  return monitor->poll(loadMa);
+}
+
+// Single-conversion spikes are removed by the median of three
+static void testSpikes() {
+  printf("spikes\n");
+  BurstAdcSource adc(11);
+  BatteryMonitor monitor(&adc, BATTERY_VOLTAGE_DIVIDER);
+
+  adc.setNoise(TEST_NOISE_COUNTS, 0, 0);
+  int clean = runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  check(near(clean, TEST_REST_MV), "clean tick", clean);
+
+  adc.setNoise(TEST_NOISE_COUNTS, 5, 1500);
+  int spiky = runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  check(near(spiky, clean), "5% spikes of up to 1500 counts", spiky);
+
+  adc.setNoise(TEST_NOISE_COUNTS, 20, 1500);
+  int dense = runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  check(abs(dense - clean) <= 3 * TEST_TOLERANCE_MV, "20% spikes stay within three tolerances", dense);
+
+  adc.setNoise(0, 0, 0);
+  adc.setBurst(0, 0, 0);
+  adc.capture(BATTERY_ADC_OVERSAMPLE - 1);
+  check(monitor.poll(BATTERY_IDLE_MA) == -1, "less than one block gives no reading", -1);
+}
+
+// A burst that outlasts the median of three only corrupts a few blocks,
+// which the median of the block means drops
+static void testBurst() {
+  printf("burst\n");
+  BurstAdcSource adc(23);
+  BatteryMonitor monitor(&adc, BATTERY_VOLTAGE_DIVIDER);
+  adc.setNoise(TEST_NOISE_COUNTS, 0, 0);
+
+  int clean = runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  // Within the last BATTERY_ADC_MEDIAN_BLOCKS blocks of the tick, spanning three of them
+  size_t start = TEST_TICK_SAMPLES - 4 * BATTERY_ADC_OVERSAMPLE - 20;
+  adc.setBurst(start, 2 * BATTERY_ADC_OVERSAMPLE, -900);
+  int burst = runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  check(near(burst, clean), "2-block burst of -900 counts", burst);
+
+  adc.setBurst(start, 4 * BATTERY_ADC_OVERSAMPLE, -900);
+  int wide = runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  check(near(wide, clean), "4-block burst of -900 counts", wide);
+}
+
+// Rest ticks win over loaded ones; a pattern that never rests falls back
+// to the mean of every tick and the load it ran under
+static void testLoadSteps() {
+  printf("load steps\n");
+  BurstAdcSource adc(37);
+  BatteryMonitor monitor(&adc, BATTERY_VOLTAGE_DIVIDER);
+  adc.setNoise(TEST_NOISE_COUNTS, 2, 800);
+  uint32_t terminalMv, loadMa;
+
+  // Pulsing pattern: one rest tick in four
+  for (int tick = 0; tick < 20; tick++) {
+    bool rest = tick % 4 == 0;
+    runTick(&adc, &monitor, rest ? TEST_REST_MV : TEST_LOADED_MV, rest ? BATTERY_IDLE_MA : TEST_LOAD_MA);
+  }
+  check(monitor.takeSample(&terminalMv, &loadMa), "pulsing interval has a reading", 1);
+  check(near((int)terminalMv, TEST_REST_MV), "pulsing interval reads rest voltage", (int)terminalMv);
+  check(loadMa == BATTERY_IDLE_MA, "pulsing interval reports idle load", (int)loadMa);
+
+  // Constant pattern: never rests
+  for (int tick = 0; tick < 20; tick++) runTick(&adc, &monitor, TEST_LOADED_MV, TEST_LOAD_MA);
+  check(monitor.takeSample(&terminalMv, &loadMa), "loaded interval has a reading", 1);
+  check(near((int)terminalMv, TEST_LOADED_MV), "loaded interval reads sagged voltage", (int)terminalMv);
+  check(loadMa == TEST_LOAD_MA, "loaded interval reports its load", (int)loadMa);
+
+  // Step from rest to load mid-interval: the tick before the step still counts as rest
+  runTick(&adc, &monitor, TEST_REST_MV, BATTERY_IDLE_MA);
+  for (int tick = 0; tick < 10; tick++) runTick(&adc, &monitor, TEST_LOADED_MV, TEST_LOAD_MA);
+  monitor.takeSample(&terminalMv, &loadMa);
+  check(near((int)terminalMv, TEST_REST_MV), "step interval reads its rest tick", (int)terminalMv);
+
+  check(!monitor.takeSample(&terminalMv, &loadMa), "empty interval has no reading", 0);
+}
+
+int main() {
+  testSpikes();
+  testBurst();
+  testLoadSteps();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
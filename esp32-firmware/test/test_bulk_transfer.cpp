@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "BulkTransfer.h"
+
+#define TEST_MTU 247
+#define TEST_PAYLOAD_SIZE (40 * 1024)
+#define TEST_FRAMES_PER_POLL 4
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Paced sender and a receiver whose ACKs arrive some polls late
+ */
+struct Link {
+  BulkSegmenter sender;
+  BulkReassembler senderSide;     // Routes ACKs to the sender, as on the device
+  BulkReassembler receiver;
+  std::vector<uint8_t> destination;
+  BufferSink sink;
+  std::deque<std::pair<int, std::vector<uint8_t>>> acks;
+  int ackDelayPolls;
+  int64_t dropOffset;             // DATA frame to lose once, -1 = none
+  uint32_t maxInFlight;
+  unsigned long stalledPolls;
+  unsigned long resentFrames;
+
+  Link()
+    : destination(TEST_PAYLOAD_SIZE), sink(destination.data(), destination.size())
+    , ackDelayPolls(40), dropOffset(-1), maxInFlight(0), stalledPolls(0), resentFrames(0) {
+    senderSide.setSender(&sender);
+    receiver.registerSink(BULK_TARGET_SCRATCH, &sink);
+  }
+
+  // Frame offsets are read back from the frames themselves
+  static uint32_t offsetOf(const uint8_t* frame) {
+    return frame[2] | (frame[3] << 8) | (frame[4] << 16) | ((uint32_t)frame[5] << 24);
+  }
+
+  // Runs until the sender saw END acknowledged or gave up
+  bool transfer(const std::vector<uint8_t>& payload, int maxPolls) {
+    sender.start(1, BULK_TARGET_SCRATCH, payload.data(), (uint32_t)payload.size(), TEST_MTU);
+    uint8_t frame[TEST_MTU];
+    uint32_t highestSent = 0;
+    uint32_t acked = 0;
+
+    for (int poll = 0; poll < maxPolls; poll++) {
+      while (!acks.empty() && acks.front().first <= poll) {
+        uint8_t reply[BULK_ACK_SIZE];
+        const std::vector<uint8_t>& ack = acks.front().second;
+        check(senderSide.handleFrame(ack.data(), ack.size(), reply) == 0, "ACK not answered");
+        if (ack[2] == BULK_OK) acked = offsetOf(ack.data() + 1);
+        acks.pop_front();
+      }
+      if (sender.isAcknowledged() || sender.getFailure() != BULK_OK) break;
+
+      int sent = 0;
+      for (; sent < TEST_FRAMES_PER_POLL; sent++) {
+        size_t length = sender.nextPacedFrame(frame);
+        if (length == 0) break;
+
+        if (frame[0] == BULK_FRAME_DATA) {
+          uint32_t end = offsetOf(frame) + (uint32_t)(length - BULK_DATA_HEADER_SIZE);
+          if (offsetOf(frame) < highestSent) resentFrames++;
+          if (end > highestSent) highestSent = end;
+          if (highestSent - acked > maxInFlight) maxInFlight = highestSent - acked;
+          if ((int64_t)offsetOf(frame) == dropOffset) {
+            dropOffset = -1;
+            continue;   // Lost on the air
+          }
+        }
+        uint8_t reply[BULK_ACK_SIZE];
+        size_t replyLength = receiver.handleFrame(frame, length, reply);
+        if (replyLength > 0) acks.push_back({poll + ackDelayPolls, std::vector<uint8_t>(reply, reply + replyLength)});
+      }
+      if (sent == 0 && !sender.isDone()) stalledPolls++;
+    }
+    return sender.isAcknowledged();
+  }
+};
+
+static std::vector<uint8_t> makePayload() {
+  std::vector<uint8_t> payload(TEST_PAYLOAD_SIZE);
+  for (size_t i = 0; i < payload.size(); i++) payload[i] = (uint8_t)(i * 31 + 7);
+  return payload;
+}
+
+// Never more than BULK_TX_WINDOW unacknowledged, and the window is used
+static void testPacing() {
+  Link link;
+  std::vector<uint8_t> payload = makePayload();
+  check(link.transfer(payload, 10000), "paced transfer completes");
+  check(link.sink.isValid() && link.destination == payload, "paced payload intact");
+  check(link.maxInFlight <= BULK_TX_WINDOW, "in-flight bytes stay inside the window");
+  check(link.maxInFlight > BULK_ACK_WINDOW, "sender runs ahead of the ACK interval");
+  check(link.stalledPolls > 0, "sender waits for late ACKs");
+}
+
+// A lost fragment is reported with BULK_ERR_OFFSET; the sender rewinds to it
+static void testRewind() {
+  Link link;
+  std::vector<uint8_t> payload = makePayload();
+  link.dropOffset = 20 * bulkPayloadForMtu(TEST_MTU);
+  check(link.transfer(payload, 10000), "transfer with a lost fragment completes");
+  check(link.resentFrames > 0, "lost fragment resent");
+  check(link.sink.isValid() && link.destination == payload, "payload intact after the rewind");
+}
+
+// A fatal status stops the sender instead of retrying
+static void testFailure() {
+  Link link;
+  std::vector<uint8_t> payload(TEST_PAYLOAD_SIZE + 1);
+  check(!link.transfer(payload, 10000), "oversized transfer not acknowledged");
+  check(link.sender.getFailure() == BULK_ERR_TOO_LARGE, "receiver's error reported");
+}
+
+/**
+ * @brief Destination that refuses to commit
+ */
+class UncommittableSink : public BufferSink {
+public:
+  UncommittableSink(uint8_t* buf, size_t cap) : BufferSink(buf, cap) {}
+  bool commit() override { return false; }
+};
+
+// Only END's ack covers the last byte, so a window that ends exactly on
+// it cannot pass for completion when the commit then fails
+static void testFinalWindow() {
+  Link link;
+  UncommittableSink sink(link.destination.data(), link.destination.size());
+  link.receiver.registerSink(BULK_TARGET_SCRATCH, &sink);
+  // Windows end after every ceil(BULK_ACK_WINDOW / fragment) fragments
+  size_t fragment = bulkPayloadForMtu(TEST_MTU);
+  std::vector<uint8_t> payload(2 * ((BULK_ACK_WINDOW + fragment - 1) / fragment) * fragment);
+  check(!link.transfer(payload, 10000), "failed commit not acknowledged");
+  check(link.sender.getFailure() == BULK_ERR_WRITE, "commit failure reported");
+}
+
+int main() {
+  testPacing();
+  testRewind();
+  testFailure();
+  testFinalWindow();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
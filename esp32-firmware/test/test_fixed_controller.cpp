@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+#include "MotorController.h"
+#include "FixedMotorController.h"
+
+#define TEST_TICKS 2000          // 100 s at UPDATE_INTERVAL_MS: long enough to heat and throttle
+#define TEST_BUDGET_PERCENT 40
+
+// Output backend that keeps the last frame it was handed
+class CapturingOutput : public PwmOutput {
+public:
+  uint8_t frame[NUM_MOTORS];
+  int commits = 0;
+
+  bool begin(int channels) override {
+    memset(frame, 0, sizeof(frame));
+    return channels == NUM_MOTORS;
+  }
+
+  bool commit(const uint8_t* next, const uint8_t* previous, int channels) override {
+    memcpy(frame, next, channels);
+    commits++;
+    return true;
+  }
+};
+
+// Both controllers drive the full pipeline (backend, governor, thermal model)
+// through the same session; every committed frame must match
+int main() {
+  int failures = 0;
+  const MassageMode modes[] = {MODE_CONSTANT, MODE_RAINDROPS, MODE_SPOT};
+
+  for (MassageMode mode : modes) {
+    CapturingOutput runtimeOutput, fixedOutput;
+    PowerGovernor runtimeGovernor(NUM_MOTORS, MAX_DUTY_CYCLE, TEST_BUDGET_PERCENT);
+    PowerGovernor fixedGovernor(NUM_MOTORS, MAX_DUTY_CYCLE, TEST_BUDGET_PERCENT);
+    ThermalModel runtimeThermal(NUM_MOTORS, MAX_DUTY_CYCLE);
+    ThermalModel fixedThermal(NUM_MOTORS, MAX_DUTY_CYCLE);
+
+    MotorController runtime(MOTOR_PINS, NUM_MOTORS, MAX_DUTY_CYCLE);
+    FixedMotorController<NUM_MOTORS, MAX_DUTY_CYCLE> fixed(MOTOR_PINS);
+    runtime.setOutput(&runtimeOutput);
+    fixed.setOutput(&fixedOutput);
+    runtime.setGovernor(&runtimeGovernor);
+    fixed.setGovernor(&fixedGovernor);
+    runtime.setThermalModel(&runtimeThermal);
+    fixed.setThermalModel(&fixedThermal);
+    runtime.setLayout(MOTOR_LAYOUT_MM);
+    fixed.setLayout(MOTOR_LAYOUT_MM);
+    if (!runtime.begin() || !fixed.begin()) {
+      printf("FAIL: begin\n");
+      return 1;
+    }
+
+    int mismatches = 0;
+    bool limited = false;
+    for (int tick = 0; tick < TEST_TICKS; tick++) {
+      unsigned long timestamp = (unsigned long)tick * UPDATE_INTERVAL_MS;
+      runtime.applyMode(mode, 100, timestamp);
+      fixed.applyMode(mode, 100, timestamp);
+      runtime.commitFrame();
+      fixed.commitFrame();
+
+      if (memcmp(runtimeOutput.frame, fixedOutput.frame, NUM_MOTORS) != 0 ||
+          runtime.getCommittedDutySum() != fixed.getCommittedDutySum()) {
+        mismatches++;
+      }
+      // Full constant drive is over budget, so the limits must have cut in
+      if (fixedOutput.frame[0] < MAX_DUTY_CYCLE) limited = true;
+    }
+
+    bool pass = mismatches == 0 && fixedOutput.commits == TEST_TICKS && (mode != MODE_CONSTANT || limited);
+    printf("mode %d: %d mismatched commits, %s\n", (int)mode, mismatches, pass ? "PASS" : "FAIL");
+    if (!pass) failures++;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "BluetoothHandler.h"
+#include "LatencyTracker.h"
+#include "SessionManager.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Transport fed from a string; keeps every message sent back
+ */
+class ScriptedTransport : public Transport {
+private:
+  std::string input;
+  size_t position;
+
+public:
+  std::vector<std::string> sent;
+
+  ScriptedTransport() : position(0) {}
+
+  void feed(const char* commands) { input += commands; }
+
+  bool begin(const char* deviceName) override { return true; }
+
+  size_t read(uint8_t* buffer, size_t capacity) override {
+    size_t count = input.size() - position < capacity ? input.size() - position : capacity;
+    memcpy(buffer, input.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  void sendMessage(const char* message) override { sent.push_back(message); }
+  bool isConnected() const override { return true; }
+};
+
+// Upper bound of the bucket holding value, seen through p50 of {value, larger}
+static uint32_t boundOf(uint32_t value) {
+  LatencyHistogram histogram;
+  histogram.record(value);
+  histogram.record(0xFFFFFFFF);
+  return histogram.percentile(50);
+}
+
+// Values below 16 are exact; above, buckets are 1/8 of their power of two wide
+static void testBucketEdges() {
+  for (uint32_t value = 0; value < 16; value++) {
+    check(boundOf(value) == value, "small values kept exactly");
+  }
+  check(boundOf(16) == 17 && boundOf(17) == 17, "16 and 17 share a bucket");
+  check(boundOf(18) == 19, "18 starts the next bucket");
+  check(boundOf(1024) == 1151 && boundOf(1151) == 1151, "bucket at 1024 is 128 wide");
+  check(boundOf(1152) == 1279, "1152 starts the next bucket");
+
+  bool withinError = true;
+  for (uint32_t value = 16; value < (1UL << (LATENCY_MAX_MSB + 1)); value += value / 7 + 1) {
+    uint32_t bound = boundOf(value);
+    if (bound < value || bound - value > value / LATENCY_SUB_BUCKETS) withinError = false;
+  }
+  check(withinError, "bucket bound within 12.5% of the value");
+
+  // Anything past the range lands in the top bucket
+  check(boundOf(1UL << (LATENCY_MAX_MSB + 1)) == (1UL << (LATENCY_MAX_MSB + 1)) - 1, "overflow in the top bucket");
+}
+
+// Percentiles are clamped to the largest value seen
+static void testPercentiles() {
+  LatencyHistogram histogram;
+  check(histogram.percentile(50) == 0 && histogram.getCount() == 0, "empty histogram reports 0");
+
+  for (uint32_t value = 1; value <= 1000; value++) histogram.record(value);
+  check(histogram.getCount() == 1000 && histogram.getMax() == 1000, "count and max");
+  check(histogram.percentile(50) >= 500 && histogram.percentile(50) <= 500 + 500 / 8, "p50 of 1..1000");
+  check(histogram.percentile(90) >= 900 && histogram.percentile(90) <= 1000, "p90 of 1..1000");
+  check(histogram.percentile(99) >= 990 && histogram.percentile(99) <= 1000, "p99 clamped to max");
+  check(histogram.percentile(100) == 1000, "p100 is the max");
+  check(histogram.percentile(0) == 1, "p0 is the first bucket");
+
+  histogram.reset();
+  check(histogram.getCount() == 0 && histogram.getMax() == 0 && histogram.percentile(99) == 0, "reset empties");
+}
+
+// Known journeys give exact stage means, also across a micros() wrap
+static void testStages() {
+  LatencyTracker tracker;
+  CommandTrace first = {1000, 1200, 11200};
+  tracker.record(first, 11600);
+  CommandTrace wrapped = {0xFFFFFF00u, 0x00000000u, 0x00002000u};
+  tracker.record(wrapped, 0x00002100u);
+
+  char text[128];
+  tracker.format(text, sizeof(text));
+  check(strcmp(text, "n=2,p50=9215,p90=10600,p99=10600,max=10600,queue=228,tick_wait=9096,actuation=328") == 0,
+        "formatted stages");
+
+  char small[16];
+  size_t written = tracker.format(small, sizeof(small));
+  check(written == sizeof(small) - 1 && strlen(small) == written, "format truncates to capacity");
+}
+
+// L reports the tracker and L0 clears it
+static void testCommands() {
+  SessionManager session;
+  ScriptedTransport link;
+  BluetoothHandler handler(&link, &session);
+  handler.begin("test");
+
+  link.feed("L\n");
+  handler.handleCommands();
+  check(link.sent.size() == 1 && link.sent[0] == "ERROR: Latency tracking not available", "L without a tracker");
+
+  LatencyTracker tracker;
+  handler.setLatencyTracker(&tracker);
+  CommandTrace trace = {0, 100, 900};
+  tracker.record(trace, 1000);
+
+  link.sent.clear();
+  link.feed("L\nL0\nL\n");
+  handler.handleCommands();
+  check(link.sent.size() == 3, "three latency replies");
+  check(link.sent.size() > 0 && link.sent[0].compare(0, 14, "L:n=1,p50=1000") == 0, "L reports the sample");
+  check(link.sent.size() > 1 && link.sent[1] == "OK: Latency reset", "L0 acknowledged");
+  check(link.sent.size() > 2 &&
+          link.sent[2] == "L:n=0,p50=0,p90=0,p99=0,max=0,queue=0,tick_wait=0,actuation=0",
+        "L after L0 is empty");
+  check(tracker.getHistogram().getCount() == 0, "tracker cleared");
+}
+
+int main() {
+  testBucketEdges();
+  testPercentiles();
+  testStages();
+  testCommands();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "BulkTransfer.h"
+#include "FileFlashBackend.h"
+#include "OtaUpdater.h"
+
+#define TEST_IMAGE_PATH "test_ota_image.bin"
+#define TEST_BOOT_PATH "test_ota_boot.txt"
+#define TEST_SLOT_SIZE (1024 * 1024)
+#define TEST_MTU 512
+#define TEST_SLOW_ERASE_US 2000   // Slow enough that the sender overruns the queue
+
+static int failures = 0;
+
+static void check(bool condition, const char* what, size_t size, size_t chunk) {
+  if (!condition) {
+    printf("FAIL: %s (%zu bytes, %zu-byte chunks)\n", what, size, chunk);
+    failures++;
+  }
+}
+
+// Flash whose erase takes as long as a real one relative to the sender
+class SlowFlashBackend : public FileFlashBackend {
+public:
+  SlowFlashBackend() : FileFlashBackend(TEST_IMAGE_PATH, TEST_BOOT_PATH, TEST_SLOT_SIZE) {}
+
+  bool eraseSector(uint32_t offset) override {
+    std::this_thread::sleep_for(std::chrono::microseconds(TEST_SLOW_ERASE_US));
+    return FileFlashBackend::eraseSector(offset);
+  }
+};
+
+static std::vector<uint8_t> makeImage(size_t size) {
+  std::vector<uint8_t> image(size);
+  uint32_t state = (uint32_t)size * 2654435761u + 1;
+  for (size_t i = 0; i < size; i++) {
+    state = state * 1664525u + 1013904223u;
+    image[i] = (uint8_t)(state >> 24);
+  }
+  return image;
+}
+
+static void digestOf(const std::vector<uint8_t>& image, uint8_t* digest) {
+  Sha256 hash;
+  hash.reset();
+  hash.update(image.data(), image.size());
+  hash.finish(digest);
+}
+
+// The image, then erased flash to the end of its last sector
+static bool flashMatches(const std::vector<uint8_t>& image) {
+  size_t sectors = (image.size() + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
+  std::vector<uint8_t> written(sectors * FLASH_SECTOR_SIZE + 1);
+  FILE* file = fopen(TEST_IMAGE_PATH, "rb");
+  if (!file) return false;
+  size_t length = fread(written.data(), 1, written.size(), file);
+  fclose(file);
+
+  if (length != sectors * FLASH_SECTOR_SIZE || memcmp(written.data(), image.data(), image.size()) != 0) {
+    return false;
+  }
+  for (size_t i = image.size(); i < length; i++) {
+    if (written[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+static bool bootSelected() {
+  FILE* file = fopen(TEST_BOOT_PATH, "r");
+  if (!file) return false;
+  fclose(file);
+  return true;
+}
+
+// Writes the image straight into the sink, waiting whenever it is full
+static bool streamImage(OtaUpdater* ota, const std::vector<uint8_t>& image, size_t chunk) {
+  if (!ota->open((uint32_t)image.size())) return false;
+  for (size_t offset = 0; offset < image.size(); offset += chunk) {
+    size_t length = image.size() - offset < chunk ? image.size() - offset : chunk;
+    while (!ota->canAccept(length)) std::this_thread::yield();
+    if (!ota->write((uint32_t)offset, image.data() + offset, length)) return false;
+  }
+  while (!ota->isDrained()) std::this_thread::yield();
+  return ota->commit();
+}
+
+static void testImage(size_t size, size_t chunk) {
+  FileFlashBackend flash(TEST_IMAGE_PATH, TEST_BOOT_PATH, TEST_SLOT_SIZE);
+  OtaUpdater ota(&flash);
+  std::vector<uint8_t> image = makeImage(size);
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  digestOf(image, digest);
+  remove(TEST_BOOT_PATH);
+
+  ota.setExpectedHash(digest);
+  check(streamImage(&ota, image, chunk), "commit", size, chunk);
+  check(ota.getState() == OTA_COMPLETE && ota.isRebootPending(), "state complete", size, chunk);
+  check(flashMatches(image), "flash contents", size, chunk);
+  check(bootSelected(), "boot slot switched", size, chunk);
+}
+
+static void testBadHash(size_t size, size_t chunk) {
+  FileFlashBackend flash(TEST_IMAGE_PATH, TEST_BOOT_PATH, TEST_SLOT_SIZE);
+  OtaUpdater ota(&flash);
+  std::vector<uint8_t> image = makeImage(size);
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  digestOf(image, digest);
+  digest[SHA256_DIGEST_SIZE - 1] ^= 1;
+  remove(TEST_BOOT_PATH);
+
+  ota.setExpectedHash(digest);
+  check(!streamImage(&ota, image, chunk), "bad hash rejected", size, chunk);
+  check(ota.getState() == OTA_FAILED && !ota.isRebootPending(), "state failed", size, chunk);
+  check(!bootSelected(), "boot slot untouched", size, chunk);
+
+  // Unarmed: the next transfer is refused outright
+  check(!ota.open((uint32_t)size), "open without hash refused", size, chunk);
+}
+
+// Full bulk path with a sender that never waits: refused fragments come
+// back as BULK_ERR_OFFSET and are resent, and END is repeated until the
+// last sector is on flash
+static void testBackpressure(size_t size) {
+  SlowFlashBackend flash;
+  OtaUpdater ota(&flash);
+  BulkReassembler receiver;
+  BulkSegmenter sender;
+  std::vector<uint8_t> image = makeImage(size);
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  digestOf(image, digest);
+  remove(TEST_BOOT_PATH);
+
+  ota.setExpectedHash(digest);
+  receiver.registerSink(BULK_TARGET_OTA, &ota);
+  sender.start(1, BULK_TARGET_OTA, image.data(), (uint32_t)size, TEST_MTU);
+
+  uint8_t frame[TEST_MTU];
+  uint8_t reply[BULK_ACK_SIZE];
+  bool done = false, failed = false;
+  unsigned long resends = 0;
+  while (!done && !failed) {
+    size_t length = sender.nextFrame(frame);
+    if (length == 0) break;   // END went unanswered
+    if (receiver.handleFrame(frame, length, reply) == 0) continue;
+
+    uint32_t acked = reply[3] | (reply[4] << 8) | (reply[5] << 16) | ((uint32_t)reply[6] << 24);
+    if (reply[2] == BULK_ERR_OFFSET) {
+      sender.rewind(acked);
+      resends++;
+      std::this_thread::yield();
+    } else if (reply[2] != BULK_OK) {
+      failed = true;
+    } else if (frame[0] == BULK_FRAME_END) {
+      done = true;
+    }
+  }
+
+  check(done && !failed, "bulk transfer completes", size, TEST_MTU);
+  check(ota.getRefusedWrites() > 0 && resends > 0, "slow flash pushes back", size, TEST_MTU);
+  check(ota.getState() == OTA_COMPLETE, "state complete", size, TEST_MTU);
+  check(flashMatches(image), "flash contents", size, TEST_MTU);
+  check(bootSelected(), "boot slot switched", size, TEST_MTU);
+}
+
+int main() {
+  const size_t sizes[] = {1, 243, 4095, 4096, 4097, 8192, 12289, 65536, 100 * 1024};
+  const size_t chunks[] = {244, 509, 4096};
+
+  for (size_t chunk : chunks) {
+    for (size_t size : sizes) testImage(size, chunk);
+    testBadHash(100 * 1024, chunk);
+  }
+  testBackpressure(100 * 1024);
+
+  remove(TEST_IMAGE_PATH);
+  remove(TEST_BOOT_PATH);
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
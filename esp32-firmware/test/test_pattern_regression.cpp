@@ -0,0 +1,138 @@
+/**
+ * Checks every pattern regression case frame by frame against the
+ * checked-in goldens, on both controllers, then runs the B3 digests.
+ *
+ *   test_pattern_regression <goldens>            compare
+ *   test_pattern_regression --update <goldens>   rewrite after an intended change
+ *
+ * Goldens file: "case <mode> <intensity>" and then one line per tick with
+ * the NUM_MOTORS duties in hex.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "BulkTransfer.h"
+#include "PatternRegression.h"
+
+static const char* goldensHeader =
+  "# Per-tick duty frames of the pattern regression cases (PatternRegression.cpp),\n"
+  "# rendered with PATTERN_REGRESSION_SEED on MOTOR_LAYOUT_MM. Only regenerate\n"
+  "# together with an intended change to a pattern:\n"
+  "#   build/test_pattern_regression --update esp32-firmware/test/goldens/pattern_frames.txt\n";
+
+static bool writeGoldens(const char* path) {
+  FILE* file = fopen(path, "w");
+  if (!file) return false;
+  fputs(goldensHeader, file);
+
+  size_t count;
+  const PatternGolden* goldens = getPatternGoldens(&count);
+  std::vector<uint8_t> frames(PATTERN_REGRESSION_TICKS * NUM_MOTORS);
+  for (size_t c = 0; c < count; c++) {
+    renderPatternFrames(goldens[c].mode, goldens[c].intensity, PATTERN_REGRESSION_SEED, PATTERN_REGRESSION_TICKS,
+                        false, frames.data());
+    fprintf(file, "case %d %d\n", (int)goldens[c].mode, goldens[c].intensity);
+    for (int tick = 0; tick < PATTERN_REGRESSION_TICKS; tick++) {
+      for (int i = 0; i < NUM_MOTORS; i++) fprintf(file, "%02x", frames[tick * NUM_MOTORS + i]);
+      fputc('\n', file);
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+// Frames of one case from the goldens file, in file order
+static bool readCase(FILE* file, int* mode, int* intensity, std::vector<uint8_t>* frames) {
+  char line[128];
+  while (fgets(line, sizeof(line), file)) {
+    if (line[0] == '#') continue;
+    if (sscanf(line, "case %d %d", mode, intensity) != 2) return false;
+
+    frames->assign(PATTERN_REGRESSION_TICKS * NUM_MOTORS, 0);
+    for (int tick = 0; tick < PATTERN_REGRESSION_TICKS; tick++) {
+      if (!fgets(line, sizeof(line), file)) return false;
+      for (int i = 0; i < NUM_MOTORS; i++) {
+        unsigned duty;
+        if (sscanf(line + 2 * i, "%2x", &duty) != 1) return false;
+        (*frames)[tick * NUM_MOTORS + i] = (uint8_t)duty;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Prints the first duty that differs from the golden frames
+static bool compareFrames(const char* renderer, const PatternGolden& golden, const std::vector<uint8_t>& expected,
+                          const std::vector<uint8_t>& actual) {
+  for (int tick = 0; tick < PATTERN_REGRESSION_TICKS; tick++) {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      int index = tick * NUM_MOTORS + i;
+      if (expected[index] != actual[index]) {
+        printf("FAIL: mode %d intensity %d (%s): tick %d motor %d expected %d, got %d\n", (int)golden.mode,
+               golden.intensity, renderer, tick, i, expected[index], actual[index]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static int checkGoldens(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    printf("FAIL: cannot read %s\n", path);
+    return 1;
+  }
+
+  int failures = 0;
+  size_t count;
+  const PatternGolden* goldens = getPatternGoldens(&count);
+  std::vector<uint8_t> expected, actual(PATTERN_REGRESSION_TICKS * NUM_MOTORS);
+  for (size_t c = 0; c < count; c++) {
+    const PatternGolden& golden = goldens[c];
+    int mode, intensity;
+    if (!readCase(file, &mode, &intensity, &expected) || mode != (int)golden.mode ||
+        intensity != golden.intensity) {
+      printf("FAIL: %s does not hold case %zu (mode %d intensity %d)\n", path, c, (int)golden.mode,
+             golden.intensity);
+      fclose(file);
+      return failures + 1;
+    }
+
+    // The frames and the digest table must describe the same render
+    if (bulkCrc32(0, expected.data(), expected.size()) != golden.digest) {
+      printf("FAIL: mode %d intensity %d: golden frames do not match the golden digest\n", mode, intensity);
+      failures++;
+    }
+
+    renderPatternFrames(golden.mode, golden.intensity, PATTERN_REGRESSION_SEED, PATTERN_REGRESSION_TICKS, false,
+                        actual.data());
+    if (!compareFrames("runtime", golden, expected, actual)) failures++;
+    renderPatternFrames(golden.mode, golden.intensity, PATTERN_REGRESSION_SEED, PATTERN_REGRESSION_TICKS, true,
+                        actual.data());
+    if (!compareFrames("fixed", golden, expected, actual)) failures++;
+  }
+  fclose(file);
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  if (argc == 3 && strcmp(argv[1], "--update") == 0) {
+    if (!writeGoldens(argv[2])) {
+      fprintf(stderr, "cannot write %s\n", argv[2]);
+      return 1;
+    }
+    return 0;
+  }
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s [--update] <goldens>\n", argv[0]);
+    return 1;
+  }
+
+  int failures = checkGoldens(argv[1]);
+  bool digests = runPatternRegression();
+  printf("%s\n", failures == 0 && digests ? "PASS" : "FAIL");
+  return failures == 0 && digests ? 0 : 1;
+}
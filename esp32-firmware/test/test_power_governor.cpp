@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <string.h>
+#include "PowerGovernor.h"
+
+#define TEST_CHANNELS 8
+#define TEST_FRAME_SUM (TEST_CHANNELS * MAX_DUTY_CYCLE)
+#define TEST_TICK_BUDGET (TEST_FRAME_SUM * POWER_BUDGET_PERCENT / 100)
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+static int frameSum(const uint8_t* frame) {
+  int sum = 0;
+  for (int i = 0; i < TEST_CHANNELS; i++) sum += frame[i];
+  return sum;
+}
+
+// Sustained full duty bursts, then settles at the budget
+static void testSlidingWindow() {
+  PowerGovernor governor(TEST_CHANNELS, MAX_DUTY_CYCLE, POWER_BUDGET_PERCENT);
+  check(governor.getBudgetPercent() == POWER_BUDGET_PERCENT, "full budget on a fresh governor");
+
+  int sums[10 * POWER_WINDOW_TICKS];
+  int unscaled = 0;
+  for (int tick = 0; tick < 10 * POWER_WINDOW_TICKS; tick++) {
+    uint8_t frame[TEST_CHANNELS];
+    memset(frame, MAX_DUTY_CYCLE, sizeof(frame));
+    if (governor.apply(frame, TEST_CHANNELS) == POWER_SCALE_ONE) unscaled++;
+    sums[tick] = frameSum(frame);
+  }
+  // The empty window takes full frames until it holds a window's budget
+  check(unscaled == TEST_TICK_BUDGET * POWER_WINDOW_TICKS / TEST_FRAME_SUM, "burst until the window is spent");
+
+  // While the burst is in the window a frame gets only one tick's budget;
+  // once it has left, every window stays inside the budget
+  bool withinTick = true;
+  for (int tick = unscaled; tick < unscaled + POWER_WINDOW_TICKS - 1; tick++) {
+    if (sums[tick] > TEST_TICK_BUDGET) withinTick = false;
+  }
+  check(withinTick, "frames after the burst held to the tick budget");
+  bool withinBudget = true;
+  for (int start = unscaled; start + POWER_WINDOW_TICKS <= 10 * POWER_WINDOW_TICKS; start++) {
+    int windowSum = 0;
+    for (int tick = start; tick < start + POWER_WINDOW_TICKS; tick++) windowSum += sums[tick];
+    if (windowSum > TEST_TICK_BUDGET * POWER_WINDOW_TICKS) withinBudget = false;
+  }
+  check(withinBudget, "windows after the burst stay inside the budget");
+
+  int settled = 0;
+  for (int tick = 9 * POWER_WINDOW_TICKS; tick < 10 * POWER_WINDOW_TICKS; tick++) settled += sums[tick];
+  settled /= POWER_WINDOW_TICKS;
+  check(settled >= TEST_TICK_BUDGET - TEST_CHANNELS && settled <= TEST_TICK_BUDGET, "settles at the budget");
+  check(governor.getScalePercent() >= POWER_BUDGET_PERCENT - 2 && governor.getScalePercent() <= POWER_BUDGET_PERCENT,
+        "scale reported near the budget");
+  check(governor.getLimitedFrames() == (unsigned long)(10 * POWER_WINDOW_TICKS - unscaled), "limited frames counted");
+}
+
+// A spent window still lets a frame use one tick's budget, scaled evenly
+static void testBurstAllowance() {
+  PowerGovernor governor(TEST_CHANNELS, MAX_DUTY_CYCLE, POWER_BUDGET_PERCENT);
+  for (int tick = 0; tick < 3 * POWER_WINDOW_TICKS; tick++) {
+    uint8_t frame[TEST_CHANNELS];
+    memset(frame, MAX_DUTY_CYCLE, sizeof(frame));
+    governor.apply(frame, TEST_CHANNELS);
+  }
+
+  // Up to one tick's budget passes untouched
+  uint8_t fits[TEST_CHANNELS];
+  memset(fits, TEST_TICK_BUDGET / TEST_CHANNELS, sizeof(fits));
+  check(governor.apply(fits, TEST_CHANNELS) == POWER_SCALE_ONE, "one tick's budget passes a spent window");
+  check(fits[0] == TEST_TICK_BUDGET / TEST_CHANNELS, "frame within the tick budget unchanged");
+
+  // Above it, every channel is scaled by the same factor
+  uint8_t shaped[TEST_CHANNELS] = {MAX_DUTY_CYCLE, MAX_DUTY_CYCLE, MAX_DUTY_CYCLE, MAX_DUTY_CYCLE,
+                                   MAX_DUTY_CYCLE, MAX_DUTY_CYCLE, 100, 40};
+  uint16_t scale = governor.apply(shaped, TEST_CHANNELS);
+  check(scale < POWER_SCALE_ONE, "over-budget frame scaled");
+  check(frameSum(shaped) <= TEST_TICK_BUDGET && frameSum(shaped) > TEST_TICK_BUDGET - TEST_CHANNELS,
+        "scaled frame uses the tick budget");
+  check(shaped[6] == (100 * scale) >> 8 && shaped[7] == (40 * scale) >> 8, "pattern shape kept");
+
+  // A bursty pattern averaging under the budget is never touched
+  governor.reset();
+  unsigned long limitedBefore = governor.getLimitedFrames();
+  for (int tick = 0; tick < 10 * POWER_WINDOW_TICKS; tick++) {
+    uint8_t frame[TEST_CHANNELS];
+    memset(frame, tick % 8 < 2 ? MAX_DUTY_CYCLE : 0, sizeof(frame));
+    governor.apply(frame, TEST_CHANNELS);
+  }
+  check(governor.getLimitedFrames() == limitedBefore, "pulse runs untouched");
+}
+
+// The budget shrinks linearly from POWER_TAPER_START_MV to POWER_TAPER_END_MV
+static void testTaper() {
+  int lastPercent = POWER_BUDGET_PERCENT + 1;
+  bool falling = true;
+  for (int millivolts = 4200; millivolts >= 3000; millivolts -= 25) {
+    PowerGovernor governor(TEST_CHANNELS, MAX_DUTY_CYCLE, POWER_BUDGET_PERCENT);
+    governor.updateBattery(millivolts);
+    int percent = governor.getBudgetPercent();
+    if (percent > lastPercent) falling = false;
+    lastPercent = percent;
+
+    int share = 100;
+    if (millivolts <= POWER_TAPER_END_MV) {
+      share = POWER_LOW_BATTERY_PERCENT;
+    } else if (millivolts < POWER_TAPER_START_MV) {
+      share = POWER_LOW_BATTERY_PERCENT + (100 - POWER_LOW_BATTERY_PERCENT) * (millivolts - POWER_TAPER_END_MV) /
+                                            (POWER_TAPER_START_MV - POWER_TAPER_END_MV);
+    }
+    int expected = POWER_BUDGET_PERCENT * share / 100;
+    if (percent < expected - 1 || percent > expected) {
+      printf("FAIL: %d mV: budget %d%%, expected %d%%\n", millivolts, percent, expected);
+      failures++;
+    }
+  }
+  check(falling, "budget never grows as the battery falls");
+  check(lastPercent == POWER_BUDGET_PERCENT * POWER_LOW_BATTERY_PERCENT / 100 ||
+          lastPercent == POWER_BUDGET_PERCENT * POWER_LOW_BATTERY_PERCENT / 100 - 1,
+        "budget bottoms out at POWER_LOW_BATTERY_PERCENT");
+
+  // Samples after the first are filtered by 1/8
+  PowerGovernor governor(TEST_CHANNELS, MAX_DUTY_CYCLE, POWER_BUDGET_PERCENT);
+  governor.updateBattery(POWER_TAPER_START_MV);
+  governor.updateBattery(POWER_TAPER_END_MV);
+  check(governor.getFilteredMillivolts() == POWER_TAPER_START_MV - (POWER_TAPER_START_MV - POWER_TAPER_END_MV) / 8,
+        "one low sample moves the filter by 1/8");
+
+  // A frame on a low battery is held to the smaller budget
+  governor.updateBattery(POWER_TAPER_END_MV - 500);
+  for (int i = 0; i < 64; i++) governor.updateBattery(POWER_TAPER_END_MV - 500);
+  for (int tick = 0; tick < 3 * POWER_WINDOW_TICKS; tick++) {
+    uint8_t frame[TEST_CHANNELS];
+    memset(frame, MAX_DUTY_CYCLE, sizeof(frame));
+    governor.apply(frame, TEST_CHANNELS);
+    if (tick == 3 * POWER_WINDOW_TICKS - 1) {
+      check(frameSum(frame) <= TEST_TICK_BUDGET * POWER_LOW_BATTERY_PERCENT / 100, "low battery frame held down");
+    }
+  }
+}
+
+int main() {
+  testSlidingWindow();
+  testBurstAllowance();
+  testTaper();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "BluetoothHandler.h"
+#include "PresetStore.h"
+#include "SessionManager.h"
+#include "SimulatedNvsStore.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Transport fed from a string; keeps every message sent back
+ */
+class ScriptedTransport : public Transport {
+private:
+  std::string input;
+  size_t position;
+
+public:
+  std::vector<std::string> sent;
+
+  ScriptedTransport() : position(0) {}
+
+  void feed(const char* commands) { input += commands; }
+
+  bool begin(const char* deviceName) override { return true; }
+
+  size_t read(uint8_t* buffer, size_t capacity) override {
+    size_t count = input.size() - position < capacity ? input.size() - position : capacity;
+    memcpy(buffer, input.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  void sendMessage(const char* message) override { sent.push_back(message); }
+  bool isConnected() const override { return true; }
+};
+
+static bool startsWith(const std::string& message, const char* prefix) {
+  return message.compare(0, strlen(prefix), prefix) == 0;
+}
+
+static bool samePreset(const SessionPreset& a, const SessionPreset& b) {
+  return a.mode == b.mode && a.intensity == b.intensity && a.timerSeconds == b.timerSeconds;
+}
+
+// What save() writes survives a reboot
+static void testRoundTrip() {
+  SimulatedNvsStore nvs;
+  SessionPreset wave = {MODE_WAVE, 70, 900};
+  SessionPreset spot = {MODE_SPOT, 100, 0};
+  {
+    PresetStore presets(&nvs);
+    check(presets.load() == 0, "fresh NVS holds no presets");
+    check(presets.save(0, wave) && presets.save(PRESET_SLOTS - 1, spot), "presets saved");
+  }
+
+  nvs.powerCycle();
+  PresetStore presets(&nvs);
+  check(presets.load() == 2, "both presets loaded after a reboot");
+  SessionPreset loaded;
+  check(presets.get(0, &loaded) && samePreset(loaded, wave), "first slot round-trips");
+  check(presets.get(PRESET_SLOTS - 1, &loaded) && samePreset(loaded, spot), "last slot round-trips");
+  check(!presets.get(1, &loaded), "untouched slot stays empty");
+}
+
+// Storing what a slot already holds spares the flash
+static void testIdenticalNotRewritten() {
+  SimulatedNvsStore nvs;
+  PresetStore presets(&nvs);
+  SessionPreset preset = {MODE_PULSE, 40, 600};
+  check(presets.save(2, preset), "first save");
+  unsigned long writes = nvs.getWriteCount();
+  check(writes == 1, "one entry written");
+
+  check(presets.save(2, preset), "identical save reported as stored");
+  check(nvs.getWriteCount() == writes, "identical preset not rewritten");
+
+  // Also after a reboot, from the loaded cache
+  PresetStore rebooted(&nvs);
+  rebooted.load();
+  check(rebooted.save(2, preset) && nvs.getWriteCount() == writes, "identical preset not rewritten after load");
+
+  preset.timerSeconds = 1200;
+  check(rebooted.save(2, preset) && nvs.getWriteCount() == writes + 1, "changed preset written");
+}
+
+// Slots outside 0..PRESET_SLOTS-1 are refused without touching NVS
+static void testOutOfRange() {
+  SimulatedNvsStore nvs;
+  PresetStore presets(&nvs);
+  SessionPreset preset = {MODE_WAVE, 50, 0};
+  check(!presets.save(-1, preset) && !presets.save(PRESET_SLOTS, preset), "save out of range refused");
+  check(nvs.getWriteCount() == 0, "nothing written for a bad slot");
+  SessionPreset loaded;
+  check(!presets.get(-1, &loaded) && !presets.get(PRESET_SLOTS, &loaded), "get out of range refused");
+
+  SessionManager session;
+  ScriptedTransport link;
+  BluetoothHandler handler(&link, &session);
+  handler.begin("test");
+  handler.setPresetStore(&presets);
+  char commands[32];
+  snprintf(commands, sizeof(commands), "P%d\nW%d\nP1\n", PRESET_SLOTS, PRESET_SLOTS);
+  link.feed(commands);
+  handler.handleCommands();
+  check(link.sent.size() == 3, "three preset replies");
+  check(link.sent.size() > 1 && link.sent[0] == "ERROR: Invalid preset slot" &&
+          link.sent[1] == "ERROR: Invalid preset slot",
+        "P and W refuse a slot past the end");
+  check(link.sent.size() > 2 && link.sent[2] == "ERROR: Preset slot empty", "empty slot reported");
+}
+
+// An entry from another layout version is ignored, not misread
+static void testVersionMismatch() {
+  SimulatedNvsStore nvs;
+  SessionPreset preset = {MODE_WAVE, 70, 900};
+  {
+    PresetStore presets(&nvs);
+    presets.save(3, preset);
+    presets.save(4, preset);
+  }
+
+  // Same bytes as PresetStore.cpp's PresetRecord, with a newer version
+  struct {
+    uint8_t version;
+    uint8_t mode;
+    uint8_t intensity;
+    uint8_t reserved;
+    uint32_t timerSeconds;
+  } record = {PRESET_VERSION + 1, MODE_PULSE, 30, 0, 60};
+  check(nvs.write("preset3", &record, sizeof(record)), "foreign entry written");
+
+  PresetStore presets(&nvs);
+  check(presets.load() == 1, "only the current version loaded");
+  SessionPreset loaded;
+  check(!presets.get(3, &loaded), "mismatched version ignored");
+  check(presets.get(4, &loaded) && samePreset(loaded, preset), "neighbouring slot intact");
+
+  // Saving over it writes the current layout again
+  check(presets.save(3, preset) && presets.get(3, &loaded) && samePreset(loaded, preset), "slot reusable");
+}
+
+// W stores the session; P recalls mode, intensity and timer in one tick with one ack
+static void testRecall() {
+  SimulatedNvsStore nvs;
+  PresetStore presets(&nvs);
+  SessionManager session;
+  ScriptedTransport link;
+  BluetoothHandler handler(&link, &session);
+  handler.begin("test");
+  handler.setPresetStore(&presets);
+
+  link.feed("M460\nT1500\n");
+  handler.handleCommands();
+  if (session.commitPendingUpdate()) handler.sendModeAck();
+  link.feed("W5\nM000\n");
+  handler.handleCommands();
+  if (session.commitPendingUpdate()) handler.sendModeAck();
+  check(nvs.getWriteCount() == 1, "W wrote one entry");
+  check(session.getMode() == 0, "session stopped before the recall");
+
+  link.sent.clear();
+  unsigned long writes = nvs.getWriteCount();
+  link.feed("P5\n");
+  handler.handleCommands();
+  check(link.sent.empty(), "recall waits for the engine tick");
+  check(session.commitPendingUpdate(), "recall applied at the tick");
+  handler.sendModeAck();
+
+  check(link.sent.size() == 1, "one ack for the recall");
+  check(link.sent.size() > 0 && startsWith(link.sent[0], "OK: Preset=5 Mode=4 Intensity=60 Timer="),
+        "ack reports the recalled preset");
+  check(session.getMode() == 4 && session.getIntensity() == 60 && session.getTimerDuration() == 1500,
+        "mode, intensity and timer applied together");
+  check(nvs.getWriteCount() == writes, "recall never writes flash");
+  check(!session.commitPendingUpdate(), "nothing left for the next tick");
+}
+
+int main() {
+  testRoundTrip();
+  testIdenticalNotRewritten();
+  testOutOfRange();
+  testVersionMismatch();
+  testRecall();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "BluetoothHandler.h"
+#include "PwmTraceRecorder.h"
+#include "SessionManager.h"
+
+#define TEST_TICK_MS 20
+#define TEST_MTU 185
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief One committed frame, as recorded or as decoded
+ */
+struct Commit {
+  uint32_t timestampMs;
+  bool timed;             // Decoded from a record of its own (not a held run)
+  std::vector<uint8_t> duty;
+};
+
+/**
+ * @brief Recorder plus the frames it was fed
+ */
+struct Trace {
+  PwmTraceRecorder recorder;
+  int channels;
+  uint32_t nowMs;
+  std::vector<Commit> commits;
+
+  explicit Trace(int channelCount) : recorder(channelCount), channels(channelCount), nowMs(0) {}
+
+  void commit(const uint8_t* duty) {
+    nowMs += TEST_TICK_MS;
+    recorder.record(nowMs, duty);
+    commits.push_back(Commit{nowMs, true, std::vector<uint8_t>(duty, duty + channels)});
+  }
+};
+
+// Every commit the image holds, oldest first; held runs expand to copies
+// of the frame before them. A run in front of the first record belongs to
+// a recycled block and is skipped.
+static std::vector<Commit> decode(const uint8_t* image, size_t size, int* keyframes, uint8_t* lastType) {
+  std::vector<Commit> decoded;
+  PwmTraceReader reader(image, size);
+  PwmTraceFrame frame;
+  *keyframes = 0;
+  while (reader.next(&frame)) {
+    std::vector<uint8_t> duty(frame.duty, frame.duty + frame.channels);
+    if (!decoded.empty()) {
+      for (uint32_t i = 0; i < frame.heldCommits; i++) {
+        decoded.push_back(Commit{0, false, decoded.back().duty});
+      }
+    }
+    if (frame.type != PWM_TRACE_RECORD_HOLD) decoded.push_back(Commit{frame.timestampMs, true, duty});
+    if (frame.type == PWM_TRACE_RECORD_KEY) (*keyframes)++;
+    *lastType = frame.type;
+  }
+  check(reader.isValid(), "image decodes to the end");
+  return decoded;
+}
+
+// The decoded commits must be the newest ones recorded, with exact duties
+// and, for commits with a record of their own, exact timestamps
+static bool matchesTail(const std::vector<Commit>& decoded, const std::vector<Commit>& recorded, bool timestamps) {
+  if (decoded.empty() || decoded.size() > recorded.size()) return false;
+  size_t skip = recorded.size() - decoded.size();
+  for (size_t i = 0; i < decoded.size(); i++) {
+    const Commit& expected = recorded[skip + i];
+    if (decoded[i].duty != expected.duty) {
+      printf("  commit %zu: duty differs\n", skip + i);
+      return false;
+    }
+    if (timestamps && decoded[i].timed && decoded[i].timestampMs != expected.timestampMs) {
+      printf("  commit %zu: %u ms, expected %u ms\n", skip + i, decoded[i].timestampMs, expected.timestampMs);
+      return false;
+    }
+  }
+  return true;
+}
+
+// A few channels move each tick, the rest hold
+static void waveFrame(int step, int channels, uint8_t* duty) {
+  for (int c = 0; c < channels; c++) {
+    int phase = (step * 5 + c * 40) % 200;
+    duty[c] = (uint8_t)((phase < 100 ? phase : 200 - phase) / 10 * 25);
+  }
+}
+
+// Changed-channel records across many blocks, then past the end of the ring
+static void testDeltaAndBlocks() {
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS];
+  int keyframes;
+  uint8_t lastType;
+
+  Trace trace(8);
+  for (int step = 0; step < 600; step++) {
+    waveFrame(step, 8, duty);
+    trace.commit(duty);
+  }
+  std::vector<Commit> decoded = decode(trace.recorder.data(), trace.recorder.size(), &keyframes, &lastType);
+  check(trace.recorder.getBlocksRecycled() == 0, "600 wave steps fit the ring");
+  check(keyframes > 1, "600 wave steps span several blocks");
+  check(decoded.size() == trace.commits.size(), "every wave commit decoded");
+  check(matchesTail(decoded, trace.commits, true), "wave commits decode exactly");
+
+  for (int step = 600; step < 6000; step++) {
+    waveFrame(step, 8, duty);
+    trace.commit(duty);
+  }
+  decoded = decode(trace.recorder.data(), trace.recorder.size(), &keyframes, &lastType);
+  check(trace.recorder.getBlocksRecycled() > 0, "6000 wave steps recycle blocks");
+  check(keyframes == PWM_TRACE_BLOCKS, "full ring holds a keyframe per block");
+  check(matchesTail(decoded, trace.commits, true), "newest wave commits decode exactly after wrap");
+}
+
+// Runs of identical commits, including ones that need the varint escape
+static void testHeldRuns() {
+  const int runs[] = {1, 2, 62, 63, 64, 127, 128, 300, 20000};
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS] = {0};
+  int keyframes;
+  uint8_t lastType;
+
+  Trace trace(8);
+  trace.commit(duty);
+  for (int run : runs) {
+    duty[run % 8] += 17;
+    for (int i = 0; i < run; i++) trace.commit(duty);
+  }
+  trace.recorder.flush(trace.nowMs + TEST_TICK_MS);
+
+  std::vector<Commit> decoded = decode(trace.recorder.data(), trace.recorder.size(), &keyframes, &lastType);
+  check(lastType == PWM_TRACE_RECORD_HOLD, "flush writes the trailing run");
+  check(decoded.size() == trace.commits.size(), "every held commit decoded");
+  check(matchesTail(decoded, trace.commits, true), "held runs decode exactly");
+}
+
+// Paused commits are not recorded; the trace resumes from the next one
+static void testPause() {
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS];
+  int keyframes;
+  uint8_t lastType;
+
+  Trace trace(8);
+  for (int step = 0; step < 40; step++) {
+    waveFrame(step, 8, duty);
+    trace.commit(duty);
+  }
+  std::vector<Commit> recorded = trace.commits;
+
+  trace.recorder.setPaused(true);
+  for (int step = 40; step < 80; step++) {
+    waveFrame(step, 8, duty);
+    trace.commit(duty);
+  }
+  trace.recorder.setPaused(false);
+  check(trace.recorder.getFramesRecorded() == 40, "paused commits not counted");
+
+  for (int step = 80; step < 120; step++) {
+    waveFrame(step, 8, duty);
+    trace.commit(duty);
+    recorded.push_back(trace.commits.back());
+  }
+  for (int i = 0; i < 5; i++) {
+    trace.commit(duty);
+    recorded.push_back(trace.commits.back());
+  }
+  trace.recorder.flush(trace.nowMs);
+
+  std::vector<Commit> decoded = decode(trace.recorder.data(), trace.recorder.size(), &keyframes, &lastType);
+  check(decoded.size() == recorded.size(), "only unpaused commits decoded");
+  check(matchesTail(decoded, recorded, true), "commits around a pause decode exactly");
+}
+
+// A flush with no room left in the block moves the held run into a new
+// keyframe; that keyframe is the last held commit, not an extra one
+static void testFlushAtBlockEnd() {
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS];
+  int keyframeFlushes = 0;
+
+  // 64 channels: keyframe 69 bytes, a change of k channels 10 + k bytes.
+  // Sweeping the third record's size walks the block's fill level across
+  // the point where the HOLD record no longer fits.
+  for (int changed = 1; changed <= 64; changed++) {
+    Trace trace(64);
+    memset(duty, 0, sizeof(duty));
+    trace.commit(duty);
+    for (int c = 0; c < 64; c++) duty[c] = 1;
+    trace.commit(duty);
+    for (int c = 0; c < 64; c++) duty[c] = 2;
+    trace.commit(duty);
+    for (int c = 0; c < changed; c++) duty[c] = 3;
+    trace.commit(duty);
+    for (int i = 0; i < 4; i++) trace.commit(duty);
+    trace.recorder.flush(trace.nowMs);
+
+    int keyframes;
+    uint8_t lastType;
+    std::vector<Commit> decoded = decode(trace.recorder.data(), trace.recorder.size(), &keyframes, &lastType);
+    if (lastType == PWM_TRACE_RECORD_KEY) keyframeFlushes++;
+    if (decoded.size() != trace.commits.size() || !matchesTail(decoded, trace.commits, false)) {
+      printf("  %d channels in the last change\n", changed);
+      check(false, "flush near the end of a block decodes exactly");
+    }
+  }
+  check(keyframeFlushes > 0, "sweep reaches a flush into a new block");
+}
+
+/**
+ * @brief Link to an app that downloads bulk transfers
+ *
+ * Frames from the device go to an app-side BulkReassembler; its ACKs
+ * come back to the device a few polls later, as over the air.
+ */
+class DownloadTransport : public Transport {
+private:
+  std::string input;
+  size_t position;
+  BulkReassembler* device;
+  std::deque<std::pair<int, std::vector<uint8_t>>> acks;   // Poll due, frame
+  int polls;
+
+public:
+  BulkReassembler app;
+  std::vector<std::string> sent;
+  int ackDelayPolls;
+  int64_t dropOffset;     // DATA frame to lose once, -1 = none
+  bool sendFails;
+  unsigned long dataFrames;
+  unsigned long resentFrames;
+  uint32_t highestSent;
+
+  DownloadTransport()
+    : position(0), device(nullptr), polls(0), ackDelayPolls(3), dropOffset(-1)
+    , sendFails(false), dataFrames(0), resentFrames(0), highestSent(0) {}
+
+  void feed(const char* commands) { input += commands; }
+
+  bool begin(const char* deviceName) override { return true; }
+
+  size_t read(uint8_t* buffer, size_t capacity) override {
+    size_t count = input.size() - position < capacity ? input.size() - position : capacity;
+    memcpy(buffer, input.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  void sendMessage(const char* message) override { sent.push_back(message); }
+  bool isConnected() const override { return true; }
+  void setBulkReceiver(BulkReassembler* receiver) override { device = receiver; }
+  uint16_t getMtu() const override { return TEST_MTU; }
+
+  void poll(unsigned long timestamp) override {
+    polls++;
+    while (!acks.empty() && acks.front().first <= polls) {
+      uint8_t reply[BULK_ACK_SIZE];
+      check(device->handleFrame(acks.front().second.data(), acks.front().second.size(), reply) == 0,
+            "ACK frames are not answered");
+      acks.pop_front();
+    }
+  }
+
+  bool sendBulk(const uint8_t* data, size_t length) override {
+    if (sendFails) return false;
+    if (data[0] == BULK_FRAME_DATA) {
+      uint32_t offset = data[2] | (data[3] << 8) | (data[4] << 16) | ((uint32_t)data[5] << 24);
+      dataFrames++;
+      if (offset < highestSent) resentFrames++;
+      if (offset + length - BULK_DATA_HEADER_SIZE > highestSent) highestSent = offset + length - BULK_DATA_HEADER_SIZE;
+      if ((int64_t)offset == dropOffset) {
+        dropOffset = -1;
+        return true;  // Lost on the air
+      }
+    }
+
+    uint8_t reply[BULK_ACK_SIZE];
+    size_t replyLength = app.handleFrame(data, length, reply);
+    if (replyLength > 0) acks.push_back({polls + ackDelayPolls, std::vector<uint8_t>(reply, reply + replyLength)});
+    return true;
+  }
+};
+
+/**
+ * @brief Command core with a recorded trace, as in main.cpp
+ */
+struct Device {
+  SessionManager session;
+  DownloadTransport link;
+  BluetoothHandler handler;
+  Trace trace;
+  uint8_t downloaded[PWM_TRACE_IMAGE_SIZE];
+  BufferSink sink;
+
+  Device() : handler(&link, &session), trace(8), sink(downloaded, sizeof(downloaded)) {
+    handler.setTraceRecorder(&trace.recorder);
+    handler.begin("test");
+    link.app.registerSink(BULK_TARGET_TRACE, &sink);
+
+    uint8_t duty[PWM_TRACE_MAX_CHANNELS];
+    for (int step = 0; step < 1500; step++) {
+      waveFrame(step, 8, duty);
+      trace.commit(duty);
+    }
+  }
+
+  // Command, then engine ticks until the app holds the image
+  bool download(const char* command, int maxPolls) {
+    link.feed(command);
+    for (int i = 0; i < maxPolls && !sink.isValid(); i++) handler.handleCommands();
+    // Let the END ack reach the device
+    for (int i = 0; i < link.ackDelayPolls + 1; i++) handler.handleCommands();
+    return sink.isValid();
+  }
+
+  std::string lastResponse() { return link.sent.empty() ? "" : link.sent.back(); }
+};
+
+// The downloaded image decodes to the commits, paced against the app's ACKs
+static void testDownload() {
+  Device device;
+  check(device.download("R\n", 2000), "trace downloads");
+  check(device.link.sent.size() > 0 && device.link.sent[0] == "OK: Trace 8200 bytes", "R reports the image size");
+  check(memcmp(device.downloaded, device.trace.recorder.data(), PWM_TRACE_IMAGE_SIZE) == 0, "image arrives intact");
+  check(device.link.resentFrames == 0, "nothing resent on a clean link");
+
+  int keyframes;
+  uint8_t lastType;
+  std::vector<Commit> decoded = decode(device.downloaded, sizeof(device.downloaded), &keyframes, &lastType);
+  check(matchesTail(decoded, device.trace.commits, true), "downloaded trace decodes exactly");
+
+  // Recording resumed once END was acknowledged
+  unsigned long frames = device.trace.recorder.getFramesRecorded();
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS] = {0};
+  device.trace.commit(duty);
+  check(device.trace.recorder.getFramesRecorded() == frames + 1, "recording resumes after the download");
+
+  device.link.feed("R0\n");
+  device.handler.handleCommands();
+  check(device.lastResponse() == "OK: Trace cleared", "R0 accepted after the download");
+}
+
+// A lost DATA frame is answered with BULK_ERR_OFFSET and resent from there
+static void testLostFrame() {
+  Device device;
+  device.link.dropOffset = 10 * bulkPayloadForMtu(TEST_MTU);
+  check(device.download("R\n", 2000), "trace downloads over a lossy link");
+  check(device.link.resentFrames > 0, "lost frame resent");
+  check(memcmp(device.downloaded, device.trace.recorder.data(), PWM_TRACE_IMAGE_SIZE) == 0,
+        "image intact after the resend");
+}
+
+// R0 is refused mid-transfer; a failed send ends the transfer
+static void testBusyAndSendFailure() {
+  Device device;
+  device.link.feed("R\n");
+  device.handler.handleCommands();
+  device.link.feed("R0\n");
+  device.handler.handleCommands();
+  check(device.lastResponse() == "ERROR: Transfer in progress", "R0 refused during a download");
+
+  device.link.sendFails = true;
+  device.handler.handleCommands();
+  device.link.sendFails = false;
+
+  unsigned long frames = device.trace.recorder.getFramesRecorded();
+  uint8_t duty[PWM_TRACE_MAX_CHANNELS] = {0};
+  device.trace.commit(duty);
+  check(device.trace.recorder.getFramesRecorded() == frames + 1, "recording resumes after a failed send");
+
+  device.link.feed("R0\n");
+  device.handler.handleCommands();
+  check(device.lastResponse() == "OK: Trace cleared", "R0 accepted after a failed send");
+}
+
+int main() {
+  testDeltaAndBlocks();
+  testHeldRuns();
+  testPause();
+  testFlushAtBlockEnd();
+  testDownload();
+  testLostFrame();
+  testBusyAndSendFailure();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include "BatteryEstimator.h"
+#include "RuntimePredictor.h"
+#include "SessionManager.h"
+
+#define TEST_FULL_SUM (8 * 255)
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// Before the window is full, the mean is over the frames recorded so far
+static void testPartialFill() {
+  RuntimePredictor predictor;
+  check(predictor.getMeanMilliamps() == BATTERY_IDLE_MA, "empty window draws the idle current");
+
+  predictor.record(TEST_FULL_SUM);
+  check(predictor.getMeanMilliamps() == BatteryEstimator::loadForDutySum(TEST_FULL_SUM), "one frame is the mean");
+
+  predictor.record(0);
+  check(predictor.getMeanMilliamps() == BatteryEstimator::loadForDutySum(TEST_FULL_SUM / 2),
+        "two frames averaged, not diluted by the empty slots");
+}
+
+// Once full, each frame replaces the oldest; a pattern's draw is exact over whole windows
+static void testWrapAround() {
+  RuntimePredictor predictor;
+  for (int tick = 0; tick < RUNTIME_WINDOW_TICKS; tick++) predictor.record(TEST_FULL_SUM);
+  check(predictor.getMeanMilliamps() == BatteryEstimator::loadForDutySum(TEST_FULL_SUM), "full window at full duty");
+
+  // Half a window of rest pushes out the oldest half
+  for (int tick = 0; tick < RUNTIME_WINDOW_TICKS / 2; tick++) predictor.record(0);
+  check(predictor.getMeanMilliamps() == BatteryEstimator::loadForDutySum(TEST_FULL_SUM / 2), "oldest frames dropped");
+
+  // Many times around the ring, the running total still matches the window
+  bool exact = true;
+  for (int tick = 0; tick < 7 * RUNTIME_WINDOW_TICKS + 13; tick++) {
+    predictor.record(tick % 4 == 0 ? TEST_FULL_SUM : 0);
+    if (tick >= RUNTIME_WINDOW_TICKS && predictor.getMeanMilliamps() !=
+                                          BatteryEstimator::loadForDutySum(TEST_FULL_SUM / 4)) {
+      exact = false;
+    }
+  }
+  check(exact, "pulse draw exact after the ring wrapped");
+
+  // Oversized frames saturate instead of wrapping the 16-bit slot
+  RuntimePredictor large;
+  large.record(0x12345);
+  check(large.getMeanMilliamps() == BatteryEstimator::loadForDutySum(0xFFFF), "frame sum saturated");
+}
+
+// A mode change restarts the profile, as the engine tick in main.cpp does
+static void testResetOnModeChange() {
+  SessionManager session;
+  BatteryEstimator battery;
+  RuntimePredictor predictor;
+  session.setBatteryEstimator(&battery);
+  session.setRuntimePredictor(&predictor);
+  check(session.getRuntimeMinutes() == -1, "no runtime before the battery is sampled");
+
+  battery.update(3850, 0);
+  for (int tick = 0; tick < RUNTIME_WINDOW_TICKS; tick++) predictor.record(TEST_FULL_SUM);
+  int constantMinutes = session.getRuntimeMinutes();
+  check(constantMinutes == battery.predictMinutes(BatteryEstimator::loadForDutySum(TEST_FULL_SUM)),
+        "runtime at the running pattern's draw");
+
+  CommandTrace trace = {0, 0, 0};
+  session.requestUpdate(MODE_PULSE, 20, trace);
+  for (int tick = 0; tick < 3; tick++) {
+    if (session.commitPendingUpdate()) predictor.reset();
+    predictor.record(TEST_FULL_SUM / 8);
+  }
+  check(predictor.getMeanMilliamps() == BatteryEstimator::loadForDutySum(TEST_FULL_SUM / 8),
+        "new pattern judged on its own frames");
+  check(session.getRuntimeMinutes() > constantMinutes, "lighter pattern lasts longer at once");
+}
+
+int main() {
+  testPartialFill();
+  testWrapAround();
+  testResetOnModeChange();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include "SessionCheckpoint.h"
+#include "SimulatedNvsStore.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+static bool sameSession(const SessionSnapshot& a, const SessionSnapshot& b) {
+  return a.mode == b.mode && a.intensity == b.intensity &&
+         a.playlistPosition == b.playlistPosition && a.remainingSeconds == b.remainingSeconds;
+}
+
+// What a fresh boot on the same flash would resume
+static bool restoreAfterReset(SimulatedNvsStore* nvs, SessionSnapshot* snapshot) {
+  SessionCheckpoint checkpoint(nvs);
+  return checkpoint.restore(snapshot);
+}
+
+// Power drops during a later write: the boot after resumes the last
+// snapshot that landed, not the one being written
+static void testLostWrite() {
+  SimulatedNvsStore nvs;
+  SessionCheckpoint checkpoint(&nvs);
+  SessionSnapshot first = {MODE_WAVE, 50, 2, 600};
+  SessionSnapshot second = {MODE_WAVE, 70, 3, 600};
+  SessionSnapshot restored;
+
+  check(!restoreAfterReset(&nvs, &restored), "empty store restores nothing");
+  check(checkpoint.update(first, 0), "first snapshot written");
+
+  nvs.setPowerLossAfter(0);
+  check(!checkpoint.update(second, CHECKPOINT_MIN_INTERVAL_MS), "write during power loss reported");
+  check(checkpoint.getFailedWrites() == 1, "lost write counted");
+
+  nvs.powerCycle();
+  check(restoreAfterReset(&nvs, &restored), "restore after power loss");
+  check(sameSession(restored, first), "restore returns last committed snapshot");
+}
+
+// Changes inside the interval are held back, and the latest is written once it ends
+static void testThrottling() {
+  SimulatedNvsStore nvs;
+  SessionCheckpoint checkpoint(&nvs);
+  SessionSnapshot snapshot = {MODE_PULSE, 10, 0, 0};
+  SessionSnapshot restored;
+
+  check(checkpoint.update(snapshot, 1000), "first change written at once");
+  for (int step = 1; step <= 40; step++) {
+    snapshot.intensity = (uint8_t)(10 + step * 2);
+    checkpoint.update(snapshot, 1000 + step * 100);
+  }
+  check(nvs.getWriteCount() == 1, "slider drag inside the interval not written");
+
+  check(!checkpoint.update(snapshot, 1000 + CHECKPOINT_MIN_INTERVAL_MS - 1), "held until the interval ends");
+  check(checkpoint.update(snapshot, 1000 + CHECKPOINT_MIN_INTERVAL_MS), "written when the interval ends");
+  check(!checkpoint.update(snapshot, 1000 + 3 * CHECKPOINT_MIN_INTERVAL_MS), "unchanged session not rewritten");
+  check(nvs.getWriteCount() == 2, "two writes for the drag");
+  check(restoreAfterReset(&nvs, &restored) && sameSession(restored, snapshot), "latest drag position stored");
+}
+
+// Stopping bypasses the interval so an ended session is never resumed
+static void testStopImmediate() {
+  SimulatedNvsStore nvs;
+  SessionCheckpoint checkpoint(&nvs);
+  SessionSnapshot running = {MODE_RAINDROPS, 80, 1, 900};
+  SessionSnapshot stopped = {MODE_OFF, 80, 1, 0};
+  SessionSnapshot restored;
+
+  check(checkpoint.update(running, 0), "session start written");
+  check(checkpoint.update(stopped, 100), "stop written inside the interval");
+  check(restoreAfterReset(&nvs, &restored) && restored.mode == MODE_OFF, "restore after stop is off");
+
+  // Changes while off are still throttled
+  stopped.intensity = 20;
+  check(!checkpoint.update(stopped, 200), "change while off throttled");
+}
+
+// A running timer only counts as a change once it has moved a full step
+static void testTimerStep() {
+  SimulatedNvsStore nvs;
+  SessionCheckpoint checkpoint(&nvs);
+  SessionSnapshot snapshot = {MODE_CONSTANT, 60, 0, 600};
+  SessionSnapshot restored;
+  unsigned long now = 0;
+
+  check(checkpoint.update(snapshot, now), "timer start written");
+
+  // Past the interval, so only differs() decides
+  now += CHECKPOINT_MIN_INTERVAL_MS;
+  snapshot.remainingSeconds = 600 - (CHECKPOINT_TIMER_STEP_S - 1);
+  check(!checkpoint.update(snapshot, now), "less than a step of countdown not written");
+
+  snapshot.remainingSeconds = 600 - CHECKPOINT_TIMER_STEP_S;
+  check(checkpoint.update(snapshot, now), "a full step of countdown written");
+
+  // Extending the timer is written even by less than a step
+  now += CHECKPOINT_MIN_INTERVAL_MS;
+  snapshot.remainingSeconds += 1;
+  check(checkpoint.update(snapshot, now), "timer extension written");
+
+  // Stopping the timer while the session keeps running
+  now += CHECKPOINT_MIN_INTERVAL_MS;
+  snapshot.remainingSeconds = 0;
+  check(checkpoint.update(snapshot, now), "timer stop written");
+  check(restoreAfterReset(&nvs, &restored) && sameSession(restored, snapshot), "restore after timer stop");
+
+  // Starting it again, with any value
+  now += CHECKPOINT_MIN_INTERVAL_MS;
+  snapshot.remainingSeconds = 1;
+  check(checkpoint.update(snapshot, now), "timer start from none written");
+
+  // A restored session never comes back with less time than it had
+  check(restoreAfterReset(&nvs, &restored) && restored.remainingSeconds >= snapshot.remainingSeconds,
+        "restored timer not short");
+}
+
+int main() {
+  testLostWrite();
+  testThrottling();
+  testStopImmediate();
+  testTimerStep();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "BluetoothHandler.h"
+#include "PresetStore.h"
+#include "SessionManager.h"
+#include "SimulatedNvsStore.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Transport fed from a string; keeps every message sent back
+ */
+class ScriptedTransport : public Transport {
+private:
+  std::string input;
+  size_t position;
+
+public:
+  std::vector<std::string> sent;
+
+  ScriptedTransport() : position(0) {}
+
+  void feed(const char* commands) { input += commands; }
+
+  bool begin(const char* deviceName) override { return true; }
+
+  size_t read(uint8_t* buffer, size_t capacity) override {
+    size_t count = input.size() - position < capacity ? input.size() - position : capacity;
+    memcpy(buffer, input.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  void sendMessage(const char* message) override { sent.push_back(message); }
+  bool isConnected() const override { return true; }
+};
+
+static bool startsWith(const std::string& message, const char* prefix) {
+  return message.compare(0, strlen(prefix), prefix) == 0;
+}
+
+/**
+ * @brief Commands arriving within one engine tick
+ */
+struct Tick {
+  SimulatedNvsStore nvs;
+  PresetStore presets;
+  SessionManager session;
+  ScriptedTransport link;
+  BluetoothHandler handler;
+
+  Tick() : presets(&nvs), handler(&link, &session) {
+    handler.begin("test");
+    handler.setPresetStore(&presets);
+  }
+
+  // Everything received so far, then what the engine tick of main.cpp sends
+  void run(const char* commands) {
+    link.feed(commands);
+    handler.handleCommands();
+    if (session.commitPendingUpdate()) handler.sendModeAck();
+  }
+};
+
+// A batch overtaken by an M keeps its timer and is still acknowledged
+static void testBatchThenMode() {
+  Tick tick;
+  tick.run("XM31;I40;T1800\nM550\n");
+
+  check(tick.link.sent.size() == 2, "batch then M: two acks");
+  check(tick.link.sent.size() > 0 && startsWith(tick.link.sent[0], "OK: Batch=3 Mode=5 Intensity=50 Timer="),
+        "batch ack first, reporting the merged state");
+  check(tick.link.sent.size() > 1 && tick.link.sent[1] == "OK: Mode=5 Intensity=50", "M ack last");
+  check(tick.session.getTimerDuration() == 1800, "batch timer applied");
+  check(tick.session.getCoalescedUpdates() == 1, "one update coalesced");
+}
+
+// Same for a preset recall overtaken by an M
+static void testPresetThenMode() {
+  Tick tick;
+  SessionPreset preset = {MODE_WAVE, 70, 900};
+  tick.presets.save(2, preset);
+  tick.run("P2\nM120\n");
+
+  check(tick.link.sent.size() == 2, "preset then M: two acks");
+  check(tick.link.sent.size() > 0 && startsWith(tick.link.sent[0], "OK: Preset=2 Mode=1 Intensity=20 Timer="),
+        "preset ack first");
+  check(tick.link.sent.size() > 1 && tick.link.sent[1] == "OK: Mode=1 Intensity=20", "M ack last");
+  check(tick.session.getTimerDuration() == 900, "preset timer applied");
+}
+
+// Acks come out in the order of each kind's latest request
+static void testModeThenBatch() {
+  Tick tick;
+  tick.run("M210\nXI60\n");
+
+  check(tick.link.sent.size() == 2, "M then batch: two acks");
+  check(tick.link.sent.size() > 0 && tick.link.sent[0] == "OK: Mode=2 Intensity=60", "M ack first");
+  check(tick.link.sent.size() > 1 && startsWith(tick.link.sent[1], "OK: Batch=1 Mode=2 Intensity=60"),
+        "batch ack last");
+}
+
+// A slider drag still answers once per tick
+static void testModeThenMode() {
+  Tick tick;
+  tick.run("M310\nM320\nM330\n");
+
+  check(tick.link.sent.size() == 1, "three Ms: one ack");
+  check(tick.link.sent.size() > 0 && tick.link.sent[0] == "OK: Mode=3 Intensity=30", "latest M acknowledged");
+
+  // The next tick starts from nothing owed
+  tick.link.sent.clear();
+  tick.run("XT60\n");
+  check(tick.link.sent.size() == 1 && startsWith(tick.link.sent[0], "OK: Batch=1 Mode=3 Intensity=30 Timer="),
+        "next tick acknowledges only its batch");
+  check(tick.session.getTimerDuration() == 60, "batch timer applied");
+}
+
+int main() {
+  testBatchThenMode();
+  testPresetThenMode();
+  testModeThenBatch();
+  testModeThenMode();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
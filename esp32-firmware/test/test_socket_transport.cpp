@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "BluetoothHandler.h"
+#include "SessionManager.h"
+#include "SocketTransport.h"
+
+#define TEST_MAX_POLLS 200
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief BluetoothHandler served over SocketTransport, as on a Linux host
+ */
+struct Server {
+  std::string path;
+  SocketTransport link;
+  SessionManager session;
+  BluetoothHandler handler;
+
+  Server(const std::string& socketPath) : path(socketPath), link(socketPath.c_str()), handler(&link, &session) {}
+
+  // One pass of main.cpp's loop: commands, then the engine tick's acks
+  void tick() {
+    handler.handleCommands();
+    if (session.commitPendingUpdate()) handler.sendModeAck();
+  }
+};
+
+static int connectClient(const std::string& path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void sendText(int fd, const char* text) {
+  check(send(fd, text, strlen(text), MSG_NOSIGNAL) == (ssize_t)strlen(text), "client write");
+}
+
+// Ticks the server until the client has a whole line, which is returned without '\n'
+static std::string readLine(Server& server, int fd, std::string& pending) {
+  for (int poll = 0; poll < TEST_MAX_POLLS; poll++) {
+    size_t end = pending.find('\n');
+    if (end != std::string::npos) {
+      std::string line = pending.substr(0, end);
+      pending.erase(0, end + 1);
+      return line;
+    }
+    server.tick();
+    char buffer[256];
+    ssize_t n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (n > 0) pending.append(buffer, n);
+    else usleep(1000);
+  }
+  return "";
+}
+
+static bool startsWith(const std::string& line, const char* prefix) {
+  return line.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Commands split across writes and several in one write, answered in order
+static void testCommands(Server& server) {
+  check(!server.link.isConnected(), "no client before connect");
+  int fd = connectClient(server.path);
+  check(fd >= 0, "client connects");
+  if (fd < 0) return;
+
+  std::string pending;
+  sendText(fd, "S");
+  server.tick();
+  check(server.link.isConnected(), "client accepted on poll");
+  sendText(fd, "\n");
+  std::string line = readLine(server, fd, pending);
+  check(startsWith(line, "S:0,"), "status after a split line");
+
+  sendText(fd, "M340\n");
+  check(readLine(server, fd, pending) == "OK: Mode=3 Intensity=40", "mode ack on the tick");
+  sendText(fd, "T120\nS\n");
+  check(readLine(server, fd, pending) == "OK: Timer set for 120 seconds", "timer ack");
+  check(startsWith(readLine(server, fd, pending), "S:3,40,"), "status in order after the timer");
+
+  sendText(fd, "Q\n");
+  check(readLine(server, fd, pending) == "ERROR: Unknown command", "unknown command reported");
+  close(fd);
+}
+
+// A closed client is dropped and the next one is served
+static void testReconnect(Server& server) {
+  for (int poll = 0; poll < TEST_MAX_POLLS && server.link.isConnected(); poll++) server.tick();
+  check(!server.link.isConnected(), "closed client dropped");
+
+  int fd = connectClient(server.path);
+  check(fd >= 0, "second client connects");
+  if (fd < 0) return;
+
+  std::string pending;
+  sendText(fd, "S\n");
+  check(startsWith(readLine(server, fd, pending), "S:3,40,"), "second client served");
+  close(fd);
+}
+
+int main() {
+  char directory[] = "/tmp/socket_transport_XXXXXX";
+  if (!mkdtemp(directory)) {
+    printf("FAIL: cannot create a socket directory\n");
+    return 1;
+  }
+
+  {
+    Server server(std::string(directory) + "/mask.sock");
+    check(server.handler.begin("test"), "listening");
+    testCommands(server);
+    testReconnect(server);
+  }
+  rmdir(directory);
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
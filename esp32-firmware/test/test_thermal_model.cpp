@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "BluetoothHandler.h"
+#include "SessionManager.h"
+#include "ThermalModel.h"
+
+#define TEST_CHANNELS 8
+#define TEST_HOT_CHANNEL 3
+#define TEST_TAU_TICKS (1 << THERMAL_TAU_SHIFT)
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Transport fed from a string; keeps every message sent back
+ */
+class ScriptedTransport : public Transport {
+private:
+  std::string input;
+  size_t position;
+
+public:
+  std::vector<std::string> sent;
+
+  ScriptedTransport() : position(0) {}
+
+  void feed(const char* commands) { input += commands; }
+
+  bool begin(const char* deviceName) override { return true; }
+
+  size_t read(uint8_t* buffer, size_t capacity) override {
+    size_t count = input.size() - position < capacity ? input.size() - position : capacity;
+    memcpy(buffer, input.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  void sendMessage(const char* message) override { sent.push_back(message); }
+  bool isConnected() const override { return true; }
+};
+
+// Runs one channel at a duty for some ticks, the others idle
+static void drive(ThermalModel& model, int channel, uint8_t duty, int ticks) {
+  uint8_t committed[TEST_CHANNELS] = {0};
+  committed[channel] = duty;
+  for (int tick = 0; tick < ticks; tick++) model.update(committed);
+}
+
+// One time constant reaches 1 - 1/e of a step and decays to 1/e of it
+static void testRiseAndDecay() {
+  ThermalModel model(TEST_CHANNELS, MAX_DUTY_CYCLE);
+  drive(model, TEST_HOT_CHANNEL, 255, TEST_TAU_TICKS);
+  int risen = model.getLevel(TEST_HOT_CHANNEL);
+  check(risen >= 159 && risen <= 162, "one time constant at 255 reaches ~161");
+  check(model.getLevel(0) == 0, "idle channel stays cold");
+  check(model.getHottest() == TEST_HOT_CHANNEL, "hottest channel found");
+
+  drive(model, TEST_HOT_CHANNEL, 255, 8 * TEST_TAU_TICKS);
+  check(model.getLevel(TEST_HOT_CHANNEL) >= 253, "settles at the duty");
+
+  int settled = model.getLevel(TEST_HOT_CHANNEL);
+  drive(model, TEST_HOT_CHANNEL, 0, TEST_TAU_TICKS);
+  int decayed = model.getLevel(TEST_HOT_CHANNEL);
+  check(decayed >= settled * 36 / 100 && decayed <= settled * 38 / 100 + 1, "one time constant idle decays to ~37%");
+
+  drive(model, TEST_HOT_CHANNEL, 0, 20 * TEST_TAU_TICKS);
+  check(model.getLevel(TEST_HOT_CHANNEL) <= 1, "cools down again");
+  check(model.getLevel(-1) == 0 && model.getLevel(TEST_CHANNELS) == 0, "out-of-range channels read 0");
+}
+
+// Expected cap at a level, from the band described in ThermalModel.h
+static int expectedCap(int level) {
+  int over = level - THERMAL_LIMIT_DUTY;
+  if (over <= 0) return MAX_DUTY_CYCLE;
+  if (over >= THERMAL_LIMIT_BAND) return THERMAL_MIN_DUTY;
+  return MAX_DUTY_CYCLE - (MAX_DUTY_CYCLE - THERMAL_MIN_DUTY) * over / THERMAL_LIMIT_BAND;
+}
+
+// The cap falls from maxDuty to THERMAL_MIN_DUTY across the band, on the hot channel only
+static void testCapAcrossBand() {
+  ThermalModel model(TEST_CHANNELS, MAX_DUTY_CYCLE);
+  bool matches = true;
+  bool falling = true;
+  bool othersUntouched = true;
+  bool limitedCounted = true;
+  int lastCap = MAX_DUTY_CYCLE;
+  int seenLevels = 0;
+  int lastLevel = -1;
+
+  // A step to 255 sweeps the level through the band
+  for (int tick = 0; tick < 8 * TEST_TAU_TICKS && model.getLevel(TEST_HOT_CHANNEL) < 200; tick++) {
+    int level = model.getLevel(TEST_HOT_CHANNEL);
+    uint8_t frame[TEST_CHANNELS];
+    memset(frame, MAX_DUTY_CYCLE, sizeof(frame));
+    int capped = model.limit(frame);
+
+    if (frame[TEST_HOT_CHANNEL] != expectedCap(level)) matches = false;
+    if (frame[TEST_HOT_CHANNEL] > lastCap) falling = false;
+    lastCap = frame[TEST_HOT_CHANNEL];
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+      if (i != TEST_HOT_CHANNEL && frame[i] != MAX_DUTY_CYCLE) othersUntouched = false;
+    }
+    if (capped != (level > THERMAL_LIMIT_DUTY ? 1 : 0)) limitedCounted = false;
+    if (model.getLimitedChannels() != (level > THERMAL_LIMIT_DUTY ? 1 : 0)) limitedCounted = false;
+    if (level != lastLevel && level > THERMAL_LIMIT_DUTY && level <= THERMAL_LIMIT_DUTY + THERMAL_LIMIT_BAND) {
+      seenLevels++;
+    }
+    lastLevel = level;
+
+    uint8_t committed[TEST_CHANNELS] = {0};
+    committed[TEST_HOT_CHANNEL] = 255;
+    model.update(committed);
+  }
+
+  check(seenLevels == THERMAL_LIMIT_BAND, "every level of the band visited");
+  check(matches, "cap follows the band");
+  check(falling, "cap never rises while heating");
+  check(lastCap == THERMAL_MIN_DUTY, "cap bottoms out at THERMAL_MIN_DUTY");
+  check(othersUntouched, "cold channels keep their duty");
+  check(limitedCounted, "only the hot channel counted as limited");
+
+  // A duty below the cap passes untouched
+  uint8_t low[TEST_CHANNELS] = {0};
+  low[TEST_HOT_CHANNEL] = THERMAL_MIN_DUTY - 1;
+  check(model.limit(low) == 0 && low[TEST_HOT_CHANNEL] == THERMAL_MIN_DUTY - 1, "duty under the cap unchanged");
+}
+
+// H reports every channel's level, paged by first channel when they do not fit
+static void testReport() {
+  SessionManager session;
+  ScriptedTransport link;
+  BluetoothHandler handler(&link, &session);
+  handler.begin("test");
+
+  link.feed("H\n");
+  handler.handleCommands();
+  check(link.sent.size() == 1 && link.sent[0] == "ERROR: Thermal model not available", "H without a model");
+
+  ThermalModel model(TEST_CHANNELS, MAX_DUTY_CYCLE);
+  handler.setThermalModel(&model);
+  drive(model, TEST_HOT_CHANNEL, 255, 8 * TEST_TAU_TICKS);
+  char expected[64];
+  snprintf(expected, sizeof(expected), "H:first=0,channels=8,levels=0 0 0 %d 0 0 0 0",
+           model.getLevel(TEST_HOT_CHANNEL));
+
+  link.sent.clear();
+  link.feed("H\nH3\nH8\nHx\n");
+  handler.handleCommands();
+  check(link.sent.size() == 4, "four thermal replies");
+  check(link.sent.size() > 0 && link.sent[0] == expected, "every channel's level");
+  check(link.sent.size() > 1 && link.sent[1].compare(0, 30, "H:first=3,channels=8,levels=25") == 0,
+        "report from a later channel");
+  check(link.sent.size() > 2 && link.sent[2] == "ERROR: Invalid thermal channel", "channel past the end refused");
+  check(link.sent.size() > 3 && link.sent[3] == "ERROR: Invalid thermal command format", "bad format refused");
+
+  // A sheet with more motors than fit in one reply is read in pages
+  ThermalModel sheet(MOTOR_MAX_CHANNELS, MAX_DUTY_CYCLE);
+  uint8_t committed[MOTOR_MAX_CHANNELS];
+  for (int i = 0; i < MOTOR_MAX_CHANNELS; i++) committed[i] = (uint8_t)i;
+  for (int tick = 0; tick < 12 * TEST_TAU_TICKS; tick++) sheet.update(committed);
+  handler.setThermalModel(&sheet);
+
+  std::vector<int> levels;
+  int pages = 0;
+  while ((int)levels.size() < MOTOR_MAX_CHANNELS && pages < MOTOR_MAX_CHANNELS) {
+    char command[16];
+    snprintf(command, sizeof(command), "H%d\n", (int)levels.size());
+    link.sent.clear();
+    link.feed(command);
+    handler.handleCommands();
+    pages++;
+    if (link.sent.size() != 1) break;
+
+    const std::string& reply = link.sent[0];
+    check(reply.size() < RESPONSE_MAX_LENGTH, "page fits a response");
+    size_t start = reply.find("levels=");
+    if (start == std::string::npos) break;
+    const char* cursor = reply.c_str() + start + 7;
+    while (*cursor) {
+      char* end;
+      levels.push_back((int)strtol(cursor, &end, 10));
+      cursor = end;
+    }
+  }
+  check(pages > 1, "sheet needs several pages");
+  bool allLevels = (int)levels.size() == MOTOR_MAX_CHANNELS;
+  for (int i = 0; allLevels && i < MOTOR_MAX_CHANNELS; i++) {
+    if (levels[i] != sheet.getLevel(i)) allLevels = false;
+  }
+  check(allLevels, "pages hold every channel's level once, in order");
+}
+
+int main() {
+  testRiseAndDecay();
+  testCapAcrossBand();
+  testReport();
+
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -272,7 +272,7 @@ class BluetoothService {
 
   /**
    * @brief Parse status response from ESP32
-   * @param data Status string (CSV: "S:0,0,0,87" or key=value: "STATUS: M=0 I=0 T=0 B=0")
+   * @param data Status string (CSV: "S:0,0,0,87,120" or key=value: "STATUS: M=0 I=0 T=0 B=0")
    * @returns Parsed status object
    */
   private parseStatus(data: string): {
@@ -280,6 +280,7 @@ class BluetoothService {
     intensity: number;
     timeLeft: number;
     battery: number;
+    runtimeMinutes: number;
   } {
     console.log('Parsing status:', data);
     const status = {
@@ -287,9 +288,10 @@ class BluetoothService {
       intensity: 0,
       timeLeft: 0,
       battery: 0,
+      runtimeMinutes: -1,
     };
 
-    // CSV format: "S:0,0,0,87"
+    // CSV format: "S:mode,intensity,timeLeft,battery[,runtimeMinutes]"
     if (data.startsWith('S:')) {
       const values = data.substring(2).split(',');
       if (values.length >= 4) {
@@ -298,6 +300,10 @@ class BluetoothService {
         status.timeLeft = parseInt(values[2]) || 0;
         status.battery = parseInt(values[3]) || 0;
       }
+      if (values.length >= 5) {
+        status.runtimeMinutes = parseInt(values[4]);
+        if (isNaN(status.runtimeMinutes)) status.runtimeMinutes = -1;
+      }
     } else {
       // Key=value format
       const parts = data.split(' ');
@@ -396,6 +402,39 @@ class BluetoothService {
     setTimeout(() => this.requestStatus().catch(console.error), 100);
   }
 
+  /**
+   * @brief Start a session: mode, intensity and timer applied together
+   *
+   * One batch write instead of M then T, so the motors never run without
+   * the timer and the device acknowledges once.
+   * @param mode Mode number
+   * @param intensity Intensity percentage (0-100)
+   * @param durationSeconds Timer duration in seconds (0 = no timer)
+   */
+  async startSession(mode: number, intensity: number, durationSeconds: number): Promise<void> {
+    await this.sendCommand(`XM${mode}${intensity};T${durationSeconds}`);
+    // Request status immediately to update UI
+    setTimeout(() => this.requestStatus().catch(console.error), 100);
+  }
+
+  /**
+   * @brief Save the current mode, intensity and timer in a preset slot
+   * @param slot Slot number (0-7)
+   */
+  async storePreset(slot: number): Promise<void> {
+    await this.sendCommand(`W${slot}`);
+  }
+
+  /**
+   * @brief Start a saved configuration (mode, intensity and timer in one tick)
+   * @param slot Slot number (0-7)
+   */
+  async recallPreset(slot: number): Promise<void> {
+    await this.sendCommand(`P${slot}`);
+    // Request status immediately to update UI
+    setTimeout(() => this.requestStatus().catch(console.error), 100);
+  }
+
   /**
    * @brief Request status from ESP32
    */